@@ -0,0 +1,119 @@
+/* Micro-benchmark of the channel composition kernels.
+ *
+ * Compares the nested-vector i-j-k product that composeChannels used before,
+ * the blocked double kernel and the long double reference kernel for the
+ * channel sizes used in refinement mode and for cascades of post-processing
+ * channels R1 R2 ... Rk.
+ *
+ * Usage: bench-compose [repetitions]
+ */
+
+#include "../compose.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+typedef vector<vector<long double>> NestedMatrix;
+
+// Random channel (each row is a probability distribution) in row-major order
+static void randomChannel(vector<double> &M, int rows, int cols){
+    M.assign((long)rows*cols, 0);
+    for(int i = 0; i < rows; i++){
+        double sum = 0;
+        for(int j = 0; j < cols; j++){
+            M[(long)i*cols+j] = rand() % 100;
+            sum += M[(long)i*cols+j];
+        }
+        for(int j = 0; j < cols; j++)
+            M[(long)i*cols+j] = sum > 0 ? M[(long)i*cols+j]/sum : (j == 0);
+    }
+}
+
+// The product composeChannels used before the kernels, kept as baseline
+static void composeNested(NestedMatrix &C, NestedMatrix &R, NestedMatrix &CR){
+    int n = C.size(), m = R.size(), p = R[0].size();
+    CR = NestedMatrix(n, vector<long double>(p, 0));
+    for(int i = 0; i < n; i++)
+        for(int j = 0; j < p; j++)
+            for(int k = 0; k < m; k++)
+                CR[i][j] += C[i][k] * R[k][j];
+}
+
+static double nowNs(){
+    return (double) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* Compose a n x m channel with a chain of 'depth' channels of size m x m.
+   Prints the time per composition of each implementation and the largest
+   difference between the double kernel and the reference. */
+static void run(int n, int m, int depth, int reps){
+    vector<double> C;
+    vector<vector<double>> chain(depth);
+    randomChannel(C, n, m);
+    for(int d = 0; d < depth; d++)
+        randomChannel(chain[d], m, m);
+
+    // Nested vectors
+    NestedMatrix nC(n, vector<long double>(m)), nOut;
+    vector<NestedMatrix> nChain(depth, NestedMatrix(m, vector<long double>(m)));
+    for(int i = 0; i < n; i++) for(int j = 0; j < m; j++) nC[i][j] = C[(long)i*m+j];
+    for(int d = 0; d < depth; d++) for(int i = 0; i < m; i++) for(int j = 0; j < m; j++) nChain[d][i][j] = chain[d][(long)i*m+j];
+
+    double t0 = nowNs();
+    for(int r = 0; r < reps; r++){
+        NestedMatrix cur = nC;
+        for(int d = 0; d < depth; d++){
+            composeNested(cur, nChain[d], nOut);
+            cur.swap(nOut);
+        }
+    }
+    double tNested = (nowNs() - t0) / ((double)reps*depth);
+
+    // Blocked double kernel
+    vector<double> cur(C), out((long)n*m);
+    t0 = nowNs();
+    for(int r = 0; r < reps; r++){
+        cur = C;
+        for(int d = 0; d < depth; d++){
+            composeKernel(cur.data(), chain[d].data(), out.data(), n, m, m);
+            cur.swap(out);
+        }
+    }
+    double tKernel = (nowNs() - t0) / ((double)reps*depth);
+
+    // Long double reference
+    vector<long double> lC(C.begin(), C.end()), lCur, lOut((long)n*m);
+    vector<vector<long double>> lChain(depth);
+    for(int d = 0; d < depth; d++) lChain[d] = vector<long double>(chain[d].begin(), chain[d].end());
+    t0 = nowNs();
+    for(int r = 0; r < reps; r++){
+        lCur = lC;
+        for(int d = 0; d < depth; d++){
+            composeKernelReference(lCur.data(), lChain[d].data(), lOut.data(), n, m, m);
+            lCur.swap(lOut);
+        }
+    }
+    double tReference = (nowNs() - t0) / ((double)reps*depth);
+
+    long double maxError = 0;
+    for(long i = 0; i < (long)n*m; i++)
+        maxError = fmaxl(maxError, fabsl((long double)cur[i] - lCur[i]));
+
+    printf("%5d x %-5d depth %-3d %14.0f %14.0f %14.0f %10.2fx %12.3Le\n", n, m, depth, tNested, tKernel, tReference, tNested/tKernel, maxError);
+}
+
+int main(int argc, char *argv[]){
+    int reps = argc > 1 ? atoi(argv[1]) : 200;
+    srand(42);
+
+    printf("%-26s %14s %14s %14s %11s %12s\n", "size", "nested ns/op", "kernel ns/op", "ref ns/op", "speedup", "max error");
+    run(3, 50, 1, reps*50);     // C (3x50) composed with R (50x50)
+    run(3, 50, 10, reps*5);     // Cascade of 10 post-processing channels
+    run(3, 500, 1, reps);
+    run(50, 50, 10, reps);
+    run(200, 200, 4, reps/10 + 1);
+    run(500, 500, 1, reps/50 + 1);
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+/* Micro-benchmark of the conversion of the channel textboxes to values.
+ *
+ * Compares, for a 3 x 50 channel typed as decimals, fractions or with an invalid
+ * cell, the three implementations Data::checkChannelText has used:
+ *   legacy:  strings, substr, erase(remove(...)) and std::stold with exceptions
+ *   strtold: text checked and copied to a local buffer, then converted by strtold
+ *   parse:   parseNumber (numparse.h), single pass on the textbox buffer
+ * It prints the time and the heap allocations per channel, and the largest
+ * difference between the values of parseNumber and strtold.
+ *
+ * Usage: bench-numparse [repetitions]
+ */
+
+#include "../numparse.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Same sizes as graphics.h, which can not be included without raylib
+#define CHAR_BUFFER_SIZE 128
+#define MAX_CHANNEL_OUTPUTS 50
+#define NUMBER_SECRETS 3
+
+typedef char ChannelText[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE];
+
+// Heap allocations, counted by the global operator new
+static long allocations = 0;
+
+void* operator new(size_t size){
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if(p == NULL) throw bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept{
+    free(p);
+}
+
+// The conversion checkChannelText used before text2Value, kept as baseline
+static bool checkLegacy(ChannelText &text, int numSecrets, int numOutputs, vector<vector<long double>> &out){
+    string validCharacters = string("0123456789./");
+    vector<vector<pair<string, string>>> newChannel(numSecrets, vector<pair<string, string>>(numOutputs));
+    string value;
+
+    try{
+        for(int i = 0; i < numSecrets; i++){
+            for(int j = 0; j < numOutputs; j++){
+                value = string(text[i][j]);
+                for(long unsigned int k = 0; k < value.size(); k++){
+                    if(validCharacters.find(value[k]) == std::string::npos)
+                        return false;
+                }
+
+                size_t pos = value.find('/');
+                if(pos != string::npos){
+                    string numerator = value.substr(0, pos);
+                    string denominator = value.substr(pos+1, value.size()-pos-1);
+                    numerator.erase(remove(numerator.begin(), numerator.end(), ' '), numerator.end());
+                    denominator.erase(remove(denominator.begin(), denominator.end(), ' '), denominator.end());
+                    newChannel[i][j] = make_pair(numerator, denominator);
+                }else{
+                    newChannel[i][j] = make_pair("not fraction", value);
+                }
+            }
+        }
+
+        out = vector<vector<long double>>(numSecrets, vector<long double>(numOutputs));
+        for(int i = 0; i < numSecrets; i++){
+            for(int j = 0; j < numOutputs; j++){
+                if(newChannel[i][j].first == "not fraction")
+                    out[i][j] = std::stold(newChannel[i][j].second);
+                else
+                    out[i][j] = std::stold(newChannel[i][j].first)/std::stold(newChannel[i][j].second);
+            }
+        }
+        return true;
+    }catch(exception &e){
+        return false;
+    }
+}
+
+// The conversion text2Value used before numparse
+static bool valueStrtold(const char *begin, const char *end, long double &value){
+    char buffer[CHAR_BUFFER_SIZE];
+    long size = end - begin;
+    if(size <= 0 || size >= CHAR_BUFFER_SIZE)
+        return false;
+
+    for(long i = 0; i < size; i++){
+        if(!isdigit((unsigned char)begin[i]) && begin[i] != '.' && begin[i] != '/')
+            return false;
+    }
+
+    memcpy(buffer, begin, size);
+    buffer[size] = '\0';
+
+    char *slash = strchr(buffer, '/');
+    if(slash != NULL)
+        *slash = '\0';
+
+    char *stop;
+    long double number = strtold(buffer, &stop);
+    if(stop == buffer)
+        return false;
+
+    if(slash != NULL){
+        long double denominator = strtold(slash + 1, &stop);
+        if(stop == slash + 1)
+            return false;
+        number /= denominator;
+    }
+
+    value = number;
+    return true;
+}
+
+static bool checkStrtold(ChannelText &text, int numSecrets, int numOutputs, vector<long double> &out){
+    for(int i = 0; i < numSecrets; i++)
+        for(int j = 0; j < numOutputs; j++)
+            if(!valueStrtold(text[i][j], text[i][j] + strlen(text[i][j]), out[i*numOutputs + j]))
+                return false;
+    return true;
+}
+
+static bool checkParse(ChannelText &text, int numSecrets, int numOutputs, vector<long double> &out){
+    for(int i = 0; i < numSecrets; i++)
+        for(int j = 0; j < numOutputs; j++)
+            if(!parseNumber(text[i][j], out[i*numOutputs + j]))
+                return false;
+    return true;
+}
+
+static double nowNs(){
+    return (double) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Fill a numSecrets x numOutputs channel. kind: 0 decimals, 1 fractions, 2 decimals with an invalid last cell.
+static void fillChannel(ChannelText &text, int numSecrets, int numOutputs, int kind){
+    for(int i = 0; i < numSecrets; i++){
+        for(int j = 0; j < numOutputs; j++){
+            int weight = 1 + rand() % 97;
+            if(kind == 1) snprintf(text[i][j], CHAR_BUFFER_SIZE, "%d/%d", weight, 97*numOutputs);
+            else snprintf(text[i][j], CHAR_BUFFER_SIZE, "%.6f", (double)weight/(97*numOutputs));
+        }
+    }
+    if(kind == 2) strcpy(text[numSecrets-1][numOutputs-1], "0.5/");
+}
+
+static void run(ChannelText &text, const char *name, int numSecrets, int numOutputs, int kind, int reps){
+    fillChannel(text, numSecrets, numOutputs, kind);
+    vector<vector<long double>> legacy;
+    vector<long double> byStrtold(numSecrets*numOutputs), byParse(numSecrets*numOutputs);
+    bool valid[3] = {false, false, false};
+
+    long a0 = allocations;
+    double t0 = nowNs();
+    for(int r = 0; r < reps; r++) valid[0] = checkLegacy(text, numSecrets, numOutputs, legacy);
+    double tLegacy = (nowNs() - t0) / reps;
+    double aLegacy = (double)(allocations - a0) / reps;
+
+    a0 = allocations;
+    t0 = nowNs();
+    for(int r = 0; r < reps; r++) valid[1] = checkStrtold(text, numSecrets, numOutputs, byStrtold);
+    double tStrtold = (nowNs() - t0) / reps;
+    double aStrtold = (double)(allocations - a0) / reps;
+
+    a0 = allocations;
+    t0 = nowNs();
+    for(int r = 0; r < reps; r++) valid[2] = checkParse(text, numSecrets, numOutputs, byParse);
+    double tParse = (nowNs() - t0) / reps;
+    double aParse = (double)(allocations - a0) / reps;
+
+    long double maxError = 0;
+    if(valid[1] && valid[2]){
+        for(int k = 0; k < numSecrets*numOutputs; k++)
+            maxError = fmaxl(maxError, fabsl(byStrtold[k] - byParse[k]));
+    }
+
+    printf("%-10s %2d x %-3d %6s %12.0f %12.0f %12.0f %8.1f %8.1f %8.1f %10.2fx %12.3Le\n",
+        name, numSecrets, numOutputs, valid[0] == valid[2] && valid[1] == valid[2] ? "yes" : "NO",
+        tLegacy, tStrtold, tParse, aLegacy, aStrtold, aParse, tLegacy/tParse, maxError);
+}
+
+int main(int argc, char *argv[]){
+    int reps = argc > 1 ? atoi(argv[1]) : 2000;
+    static ChannelText text;
+    srand(42);
+
+    printf("%-10s %-8s %6s %12s %12s %12s %8s %8s %8s %11s %12s\n", "text", "size", "agree",
+        "legacy ns", "strtold ns", "parse ns", "legacy", "strtold", "parse", "speedup", "max error");
+    printf("%-10s %-8s %6s %12s %12s %12s %8s %8s %8s\n", "", "", "", "", "", "", "allocs", "allocs", "allocs");
+    run(text, "decimals", NUMBER_SECRETS, MAX_CHANNEL_OUTPUTS, 0, reps);
+    run(text, "fractions", NUMBER_SECRETS, MAX_CHANNEL_OUTPUTS, 1, reps);
+    run(text, "invalid", NUMBER_SECRETS, MAX_CHANNEL_OUTPUTS, 2, reps);
+    run(text, "decimals", MAX_CHANNEL_OUTPUTS, MAX_CHANNEL_OUTPUTS, 0, reps/10 + 1);
+    run(text, "fractions", MAX_CHANNEL_OUTPUTS, MAX_CHANNEL_OUTPUTS, 1, reps/10 + 1);
+
+    return 0;
+}
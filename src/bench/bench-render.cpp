@@ -0,0 +1,161 @@
+/* Headless benchmark of the drawing of the visualization.
+ *
+ * Draws the frame of the visualization panel of a random hyper with m posteriors
+ * into a RecordingRenderer, with the same GuiVisualization methods the app calls
+ * (panel, triangle with a heatmap level, prior cloud, prior circle, inners circles,
+ * hull and labels), and prints the primitives, vertices and state changes of the
+ * frame, and the time per frame of:
+ *
+ *      cached:   the CircleBatch of the inners is reused, as when nothing moves
+ *      animated: the CircleBatch is built again every frame, as while the prior is dragged
+ *
+ * The raygui widgets (button, status textbox, checkboxes) are not drawn through the
+ * renderer, and the textures of the heatmap and of the cloud are taken as uploaded.
+ * The counts do not depend on the machine, so they can be compared between
+ * runs to find regressions of the render cost.
+ *
+ * Usage: bench-render [frames]
+ */
+
+#include "../gui/guivisualization.h"
+#include "../renderer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+#define PATH_CACHED 0
+#define PATH_ANIMATED 1
+
+static const char *pathNames[] = {"cached", "animated"};
+
+// Rectangles, triangle and textures of the visualization panel
+static GuiVisualization visualization;
+
+static double nowNs(){
+    return (double) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Inners circles of a random hyper with m posteriors, as Data::buildInnerCircles places them, and their labels
+static void randomInners(vector<Circle> &circles, vector<pt> &hull, Distribution &outer, vector<string> &labels, int m){
+    outer.num_el = m;
+    outer.prob.resize(m);
+    long double sum = 0;
+    for(int j = 0; j < m; j++){
+        outer.prob[j] = 1 + rand() % 100;
+        sum += outer.prob[j];
+    }
+
+    circles.resize(m);
+    hull.resize(m);
+    labels.resize(m);
+    visualization.recLabelInnersCircles[CHANNEL_1].resize(m);
+    for(int j = 0; j < m; j++){
+        outer.prob[j] /= sum;
+        Real x1 = rand() % 1000, x2 = rand() % 1000, x3 = rand() % 1000 + 1;
+        Real total = x1 + x2 + x3;
+        Point p = dist2Bary(x1/total, x2/total, x3/total);
+        p = bary2Pixel(p.x, p.y, visualization.trianglePoints);
+        circles[j].center = p;
+        circles[j].radius = (int)sqrt(outer.prob[j] * PRIOR_RADIUS * PRIOR_RADIUS);
+        hull[j].x = p.x;
+        hull[j].y = p.y;
+        labels[j] = "I" + to_string(j+1);
+        visualization.recLabelInnersCircles[CHANNEL_1][j] = (Rectangle){(float)p.x - 8, (float)p.y - 11, 20, 20};
+    }
+    convexHull(hull);
+}
+
+// Finest level of a heatmap and a density image of the cloud, of the size the workers give, with their textures uploaded
+static void uploadedImages(HeatmapImage &heatmap, PriorCloudImage &cloud){
+    Vector2 *t = visualization.trianglePoints;
+    Rectangle area = {t[1].x, t[0].y, t[2].x - t[1].x, t[1].y - t[0].y};
+
+    heatmap.generation = 1;
+    heatmap.level = HEATMAP_LEVELS - 1;
+    heatmap.area = area;
+    heatmap.cell = HEATMAP_FINEST_CELL;
+    heatmap.width = (int)ceilf(area.width / heatmap.cell);
+    heatmap.height = (int)ceilf(area.height / heatmap.cell);
+    visualization.heatmapTexture.id = 3;
+    visualization.heatmapTexture.width = heatmap.width;
+    visualization.heatmapTexture.height = heatmap.height;
+    strcpy(visualization.LabelHeatmapText, "Vulnerability from 0.333 to 1.000");
+
+    cloud.generation = 1;
+    cloud.area = area;
+    cloud.width = (int)ceilf(area.width / PRIOR_CLOUD_CELL);
+    cloud.height = (int)ceilf(area.height / PRIOR_CLOUD_CELL);
+    visualization.cloudTexture.id = 4;
+    visualization.cloudTexture.width = cloud.width;
+    visualization.cloudTexture.height = cloud.height;
+}
+
+// The calls of drawGuiVisualization that go through the renderer, with every option shown
+static void drawFrame(RecordingRenderer &renderer, const HeatmapImage &heatmap, const PriorCloudImage &cloud, const Circle &prior,
+                      const vector<Circle> &circles, const vector<pt> &hull, const Distribution &outer, const vector<string> &labels,
+                      unsigned long version, Font font){
+    renderer.panel(visualization.recTitle, visualization.recContent, visualization.GroupBoxVisualizationText, BG_BASE_COLOR_LIGHT, WHITE, font);
+    renderer.rectangle(visualization.recTextBoxStatus, WHITE);
+
+    visualization.drawTriangle(renderer, heatmap, font, font);
+    visualization.drawPriorCloud(renderer, cloud);
+    visualization.drawCirclePrior(renderer, prior, true, font);
+    visualization.drawCirclesInners(renderer, CHANNEL_1, circles, (int)circles.size(), version, &hull, outer, &labels, font);
+}
+
+static void run(int m, int frames){
+    vector<Circle> circles;
+    vector<pt> hull;
+    Distribution outer;
+    vector<string> labels;
+    randomInners(circles, hull, outer, labels, m);
+
+    HeatmapImage heatmap;
+    PriorCloudImage cloud;
+    uploadedImages(heatmap, cloud);
+
+    Vector2 *t = visualization.trianglePoints;
+    Circle prior;
+    prior.center = Point((t[0].x + t[1].x + t[2].x)/3, (t[0].y + t[1].y + t[2].y)/3);
+    prior.radius = PRIOR_RADIUS;
+    visualization.recLabelPriorCircle = (Rectangle){(float)prior.center.x - 8, (float)prior.center.y - 15, 30, 30};
+
+    // Only the texture of the font is used by the recording renderer
+    Font font;
+    font.texture.id = 2;
+    font.baseSize = 20;
+
+    for(int path = PATH_CACHED; path <= PATH_ANIMATED; path++){
+        RecordingRenderer renderer;
+        visualization.innersBatch[CHANNEL_1] = CircleBatch();
+        unsigned long version = 1;
+
+        double t0 = nowNs();
+        for(int f = 0; f < frames; f++){
+            // The circles move in every frame of an animation, so their version changes
+            if(path == PATH_ANIMATED) version++;
+            renderer.beginFrame();
+            drawFrame(renderer, heatmap, cloud, prior, circles, hull, outer, labels, version, font);
+            renderer.endFrame();
+        }
+        double t = (nowNs() - t0) / frames;
+
+        RenderStats &s = renderer.frame;
+        printf("%6d %-9s %8ld %11ld %10ld %9ld %14.0f\n", m, pathNames[path], s.calls, s.primitives, s.vertices, s.stateChanges, t);
+    }
+}
+
+int main(int argc, char *argv[]){
+    int frames = argc > 1 ? atoi(argv[1]) : 1000;
+    srand(42);
+
+    printf("%6s %-9s %8s %11s %10s %9s %14s\n", "m", "path", "calls", "primitives", "vertices", "changes", "ns/frame");
+    run(3, frames);
+    run(10, frames);
+    run(50, frames);
+    run(200, frames/10 + 1);
+    run(1000, frames/50 + 1);
+
+    return 0;
+}
@@ -0,0 +1,498 @@
+/* Micro-benchmark suite of the numeric and formatting kernels.
+ *
+ * Every case is run for a sweep of channel sizes (3 x m channels, and m x m for
+ * the composed channel R and the mechanisms) with the same seed, and reports the
+ * time and the number of heap allocations per operation:
+ *
+ *      compose             composeChannels of C (3 x m) and R (m x m)
+ *      hyper_build         Hyper constructed from a 3 x m Channel
+ *      hyper_rebuild       Hyper::rebuildHyper for a new prior
+ *      hyper_cache         HyperCache::update for a new prior (the path taken while the prior is dragged)
+ *      posterior_map       PosteriorMap::evaluate of BENCH_PRIORS priors (compare with BENCH_PRIORS x hyper_rebuild)
+ *      prior_cloud         PriorCloudWorker job of PRIOR_CLOUD_SIZE priors after the channel changes, until its image is taken
+ *      heatmap             HeatmapWorker job, from its submission until the finest level is taken
+ *      convex_hull         convexHull of the m inners
+ *      convex_hull_indices convexHullIndices of the m inners with reused scratch memory
+ *      format_dist         formatDistribution of an outer with m posteriors
+ *      check_channel_text  text2Matrix of the text of a 3 x m channel (the parse of Data::checkChannelText)
+ *      read_qif_file       QIFFile::read and QIFFile::copyText of a .qifg file (the read of GuiMenu::readQIFFile)
+ *      random_response     RR::random_response::get_channel of size m
+ *      truncated_geometric TG::truncated_geometric::get_channel of size m
+ *
+ * Usage: bench-suite [-o file.json] [-t milliseconds] [case]
+ *      -o: Results in JSON (default bench-suite.json)
+ *      -t: Minimum time of each of the BENCH_SAMPLES samples of a case (default 20)
+ *      case: Run only the cases whose name contains this text
+ *
+ * The mechanisms print the result of their own checks to stderr, redirect it to
+ * keep only the report.
+ */
+
+#include "../graphics.h"
+#include "../chull.h"
+#include "../hypercache.h"
+#include "../posteriormap.h"
+#include "../priorcloud.h"
+#include "../heatmap.h"
+#include "../qiffile.h"
+#include "../random-response.h"
+#include "../truncated-geometric.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+#include <thread>
+
+#define BENCH_SEED 42
+#define BENCH_SAMPLES 5     // The median of the samples is reported
+#define BENCH_PRIORS 1000   // Priors of each batch of posterior_map
+
+static const int sizes[] = {3, 10, 50, 200, 1000};
+static const int numSizes = sizeof(sizes)/sizeof(sizes[0]);
+
+//------------------------------------------------------------------------------------
+// Allocation counter
+//------------------------------------------------------------------------------------
+
+/* Every allocation of the program goes through these operators. The suite is single-threaded,
+ * besides the workers of posterior_map, which do not allocate, and the workers of prior_cloud
+ * and heatmap, whose allocations are counted too, so the counters are atomic.
+ * They are not inlined, otherwise GCC reports free() of memory returned by operator new. */
+static atomic<unsigned long> allocations(0);
+static atomic<unsigned long> allocatedBytes(0);
+
+__attribute__((noinline)) void* operator new(size_t size){
+    allocations++;
+    allocatedBytes += size;
+    void *p = malloc(size > 0 ? size : 1);
+    if(p == NULL) throw bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void* operator new[](size_t size){
+    return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete[](void *p) noexcept{
+    free(p);
+}
+
+//------------------------------------------------------------------------------------
+// Measurement
+//------------------------------------------------------------------------------------
+
+typedef struct BenchResult{
+    string name;
+    int rows;
+    int cols;
+    long iterations;        // Iterations of each sample
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+}BenchResult;
+
+static vector<BenchResult> results;
+static double minSampleNs = 20e6;
+static const char *filter = NULL;
+
+// Keeps the result of an operation alive, so the compiler does not remove it
+static volatile double sink;
+
+static double nowNs(){
+    return (double) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool selected(const char *name){
+    return filter == NULL || strstr(name, filter) != NULL;
+}
+
+/* Run 'op' until a sample takes at least minSampleNs, then take BENCH_SAMPLES
+ * samples of that many iterations. Allocations are counted in the samples only,
+ * so the warm-up (i.e. the first reserve of a reused buffer) is not reported. */
+template<typename Op>
+static void measure(const char *name, int rows, int cols, Op op){
+    long iterations = 1;
+    for(;;){
+        double t0 = nowNs();
+        for(long k = 0; k < iterations; k++) op();
+        if(nowNs() - t0 >= minSampleNs || iterations >= (1L << 30)) break;
+        iterations *= 2;
+    }
+
+    double samples[BENCH_SAMPLES];
+    unsigned long allocs0 = allocations, bytes0 = allocatedBytes;
+    for(int s = 0; s < BENCH_SAMPLES; s++){
+        double t0 = nowNs();
+        for(long k = 0; k < iterations; k++) op();
+        samples[s] = (nowNs() - t0) / iterations;
+    }
+    double ops = (double)iterations * BENCH_SAMPLES;
+    sort(samples, samples + BENCH_SAMPLES);
+
+    BenchResult r;
+    r.name = name;
+    r.rows = rows;
+    r.cols = cols;
+    r.iterations = iterations;
+    r.nsPerOp = samples[BENCH_SAMPLES/2];
+    r.allocsPerOp = (allocations - allocs0) / ops;
+    r.bytesPerOp = (allocatedBytes - bytes0) / ops;
+    results.push_back(r);
+
+    printf("%-22s %5d x %-5d %14.1f %12.2f %14.1f\n", name, rows, cols, r.nsPerOp, r.allocsPerOp, r.bytesPerOp);
+    fflush(stdout);
+}
+
+//------------------------------------------------------------------------------------
+// Inputs
+//------------------------------------------------------------------------------------
+
+// Random channel (each row is a probability distribution)
+static void randomChannel(Matrix &M, int rows, int cols){
+    M.resize(rows, cols);
+    for(int i = 0; i < rows; i++){
+        Real sum = 0;
+        for(int j = 0; j < cols; j++){
+            M(i, j) = rand() % 100;
+            sum += M(i, j);
+        }
+        for(int j = 0; j < cols; j++)
+            M(i, j) = sum > 0 ? M(i, j)/sum : (j == 0);
+    }
+}
+
+// Random channel whose rows sum up to 1 exactly in long double, as libqif checks
+static void randomRows(vector<vector<long double>> &rows, int numRows, int numCols){
+    rows.assign(numRows, vector<long double>(numCols, 0));
+    for(int i = 0; i < numRows; i++){
+        long double sum = 0;
+        for(int j = 0; j < numCols - 1; j++){
+            rows[i][j] = (rand() % 100) / (100.0L * numCols);
+            sum += rows[i][j];
+        }
+        rows[i][numCols-1] = 1 - sum;
+    }
+}
+
+static Distribution randomPrior(){
+    vector<long double> p(NUMBER_SECRETS);
+    p[0] = (1 + rand() % 98) / 100.0L;
+    p[1] = (1 + rand() % (int)(99 - p[0]*100)) / 100.0L;
+    p[2] = 1 - p[0] - p[1];
+    return Distribution(p);
+}
+
+// Text of a value as it is typed in a textbox: a fraction or a decimal number
+static void randomValueText(char *text, int size){
+    if(rand() % 2) snprintf(text, size, "%d/%d", rand() % 100, 1 + rand() % 100);
+    else snprintf(text, size, "0.%03d", rand() % 1000);
+}
+
+//------------------------------------------------------------------------------------
+// Cases
+//------------------------------------------------------------------------------------
+
+static void benchCompose(int m){
+    if(!selected("compose")) return;
+    Matrix C, R, CR;
+    randomChannel(C, NUMBER_SECRETS, m);
+    randomChannel(R, m, m);
+    measure("compose", NUMBER_SECRETS, m, [&]{
+        composeChannels(C, R, CR);
+        sink = CR.values[0];
+    });
+}
+
+static void benchHyper(int m){
+    vector<vector<long double>> rows;
+    randomRows(rows, NUMBER_SECRETS, m);
+    Distribution prior = randomPrior();
+    Channel channel(prior, rows);
+
+    if(selected("hyper_build")){
+        measure("hyper_build", NUMBER_SECRETS, m, [&]{
+            Hyper hyper(channel);
+            sink = hyper.num_post;
+        });
+    }
+
+    // Two priors are alternated, so every call computes a new hyper
+    Distribution priors[2] = {randomPrior(), randomPrior()};
+    Hyper hyper(channel);
+    int k = 0;
+
+    if(selected("hyper_rebuild")){
+        measure("hyper_rebuild", NUMBER_SECRETS, m, [&]{
+            hyper.rebuildHyper(priors[k ^= 1]);
+            sink = hyper.num_post;
+        });
+    }
+
+    if(selected("hyper_cache")){
+        Matrix M(NUMBER_SECRETS, m);
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            for(int j = 0; j < m; j++)
+                M(i, j) = rows[i][j];
+        HyperCache cache;
+        cache.build(M);
+        Point bary[2] = {dist2Bary(priors[0]), dist2Bary(priors[1])};
+        measure("hyper_cache", NUMBER_SECRETS, m, [&]{
+            k ^= 1;
+            cache.update(bary[k], priors[k], hyper);
+            sink = hyper.num_post;
+        });
+    }
+}
+
+static void benchPosteriorMap(int m){
+    if(!selected("posterior_map")) return;
+    Matrix C;
+    randomChannel(C, NUMBER_SECRETS, m);
+    PosteriorMap map;
+    map.build(C);
+
+    // Priors as the rows of a NUMBER_SECRETS x BENCH_PRIORS matrix
+    Matrix priors(NUMBER_SECRETS, BENCH_PRIORS);
+    for(int k = 0; k < BENCH_PRIORS; k++){
+        Distribution prior = randomPrior();
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            priors(i, k) = prior.prob[i];
+    }
+
+    PosteriorBatch batch;
+    measure("posterior_map", NUMBER_SECRETS, m, [&]{
+        map.evaluate(priors.data(), BENCH_PRIORS, batch, ThreadPool::shared());
+        sink = batch.outer[0];
+    });
+}
+
+static void benchPriorCloud(int m){
+    if(!selected("prior_cloud")) return;
+    Matrix C;
+    randomChannel(C, NUMBER_SECRETS, m);
+    PriorCloud cloud;
+    cloud.sample(PRIOR_CLOUD_SIZE, PRIOR_CLOUD_ALPHA, BENCH_SEED);
+
+    // Triangle of the visualization panel (see GuiVisualization)
+    Vector2 triangle[3] = {{735, 173}, {420, 718}, {1050, 718}};
+    Color colors[PRIOR_CLOUD_LAYERS] = {PRIOR_COLOR, INNERS1_COLOR, INNERS2_COLOR};
+    PriorCloudJob job;
+    job.priors = cloud.priors;
+    job.count = cloud.count;
+    job.priorsVersion = cloud.version;
+    job.channels[0] = CHANNEL_1;
+    job.channels[1] = -1;
+    job.sources[1] = 0;
+    job.matrix[0] = C;
+    for(int i = 0; i < 3; i++)
+        job.trianglePoints[i] = triangle[i];
+    for(int l = 0; l < PRIOR_CLOUD_LAYERS; l++)
+        job.colors[l] = colors[l];
+
+    // A new version of the channel every time, so its map is built again
+    static PriorCloudWorker worker;
+    PriorCloudImage image;
+    image.generation = 0;
+    image.width = image.height = 0;
+    unsigned long version = 0;
+    measure("prior_cloud", NUMBER_SECRETS, m, [&]{
+        job.sources[0] = ++version;
+        worker.submit(job);
+        while(!worker.poll(image))
+            this_thread::yield();
+        sink = image.pixels[0].a;
+    });
+}
+
+static void benchHeatmap(int m){
+    if(!selected("heatmap")) return;
+    Matrix C;
+    randomChannel(C, NUMBER_SECRETS, m);
+
+    // Triangle of the visualization panel (see GuiVisualization)
+    Vector2 triangle[3] = {{735, 173}, {420, 718}, {1050, 718}};
+    HeatmapJob job;
+    job.channel = CHANNEL_1;
+    job.measure = HEATMAP_VULNERABILITY;
+    job.matrix = C;
+    for(int i = 0; i < 3; i++)
+        job.trianglePoints[i] = triangle[i];
+
+    static HeatmapWorker worker;
+    HeatmapImage image;
+    unsigned long version = 0;
+    measure("heatmap", NUMBER_SECRETS, m, [&]{
+        job.source = ++version;
+        worker.submit(job);
+
+        // Levels can be skipped if they are finished faster than they are taken
+        do{
+            this_thread::yield();
+        }while(!(worker.poll(image) && image.level == HEATMAP_LEVELS-1));
+        sink = image.pixels[0].a;
+    });
+}
+
+static void benchConvexHull(int m){
+    vector<pt> points(m), work;
+    for(int j = 0; j < m; j++){
+        points[j].x = rand() % 10000;
+        points[j].y = rand() % 10000;
+    }
+
+    if(selected("convex_hull")){
+        work.reserve(m);
+        measure("convex_hull", 1, m, [&]{
+            work.assign(points.begin(), points.end());
+            convexHull(work);
+            sink = work.size();
+        });
+    }
+
+    if(selected("convex_hull_indices")){
+        vector<int> hull, order;
+        measure("convex_hull_indices", 1, m, [&]{
+            convexHullIndices(points, hull, order);
+            sink = hull.size();
+        });
+    }
+}
+
+static void benchFormatDist(int m){
+    if(!selected("format_dist")) return;
+    vector<long double> p(m);
+    long double sum = 0;
+    for(int j = 0; j < m; j++){
+        p[j] = 1 + rand() % 100;
+        sum += p[j];
+    }
+    for(int j = 0; j < m; j++)
+        p[j] /= sum;
+    vector<TextCell> outer(m);
+    measure("format_dist", 1, m, [&]{
+        formatDistribution(p.data(), m, 1, PROB_PRECISION, outer[0].text, sizeof(TextCell));
+        sink = outer[m-1].text[0];
+    });
+}
+
+static void benchCheckChannelText(int m){
+    if(!selected("check_channel_text")) return;
+    TextGrid text;
+    text.reserve(NUMBER_SECRETS, m, TEXT_ZERO);
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        for(int j = 0; j < m; j++)
+            randomValueText(text[i][j], CHAR_BUFFER_SIZE);
+
+    Matrix channel;
+    measure("check_channel_text", NUMBER_SECRETS, m, [&]{
+        sink = text2Matrix(text, NUMBER_SECRETS, m, channel);
+    });
+}
+
+static void benchReadQIFFile(int m){
+    if(!selected("read_qif_file")) return;
+    const char *fileName = "bench-suite.qifg";
+    char value[CHAR_BUFFER_SIZE];
+
+    FILE *file = fopen(fileName, "w");
+    if(file == NULL){
+        fprintf(stderr, "Could not write %s\n", fileName);
+        return;
+    }
+    fprintf(file, "mode %d\nprior %d\n1/3 1/3 1/3\nchannel1 %d %d\n", MODE_SINGLE, NUMBER_SECRETS, NUMBER_SECRETS, m);
+    for(int i = 0; i < NUMBER_SECRETS; i++){
+        for(int j = 0; j < m; j++){
+            randomValueText(value, CHAR_BUFFER_SIZE);
+            fprintf(file, j < m-1 ? "%s " : "%s\n", value);
+        }
+    }
+    fclose(file);
+
+    QIFFile qifFile;
+    char prior[NUMBER_SECRETS][CHAR_BUFFER_SIZE];
+    TextGrid channel[NUMBER_CHANNELS];
+    int numSecrets[NUMBER_CHANNELS], numOutputs[NUMBER_CHANNELS];
+    measure("read_qif_file", NUMBER_SECRETS, m, [&]{
+        if(qifFile.read(string(fileName)) == INVALID_QIF_FILE) return;
+        qifFile.copyText(prior, channel, numSecrets, numOutputs);
+        sink = prior[0][0];
+    });
+
+    remove(fileName);
+}
+
+static void benchMechanisms(int m){
+    if(selected("random_response")){
+        RR::random_response<Real> rr(NUMBER_SECRETS, log(2), 0);
+        measure("random_response", m, m, [&]{
+            vector<vector<Real>> channel = rr.get_channel(m, log(2), 0);
+            sink = channel[0][0];
+        });
+    }
+
+    if(selected("truncated_geometric")){
+        TG::truncated_geometric<Real> tg(NUMBER_SECRETS, 0.5);
+        measure("truncated_geometric", m, m, [&]{
+            vector<vector<Real>> channel = tg.get_channel(m, 0.5);
+            sink = channel[0][0];
+        });
+    }
+}
+
+//------------------------------------------------------------------------------------
+// Report
+//------------------------------------------------------------------------------------
+
+static bool writeJSON(const char *fileName){
+    FILE *file = fopen(fileName, "w");
+    if(file == NULL)
+        return false;
+
+    fprintf(file, "{\n  \"precision\": \"%s\",\n  \"seed\": %d,\n  \"samples\": %d,\n  \"min_sample_ms\": %.1f,\n  \"results\": [\n",
+        REAL_NAME, BENCH_SEED, BENCH_SAMPLES, minSampleNs / 1e6);
+    for(unsigned long k = 0; k < results.size(); k++){
+        BenchResult &r = results[k];
+        fprintf(file, "    {\"name\": \"%s\", \"rows\": %d, \"cols\": %d, \"iterations\": %ld, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}%s\n",
+            r.name.c_str(), r.rows, r.cols, r.iterations, r.nsPerOp, r.allocsPerOp, r.bytesPerOp, k+1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+static void (*cases[])(int m) = {
+    benchCompose, benchHyper, benchPosteriorMap, benchPriorCloud, benchHeatmap, benchConvexHull, benchFormatDist, benchCheckChannelText, benchReadQIFFile, benchMechanisms
+};
+static const int numCases = sizeof(cases)/sizeof(cases[0]);
+
+int main(int argc, char *argv[]){
+    const char *output = "bench-suite.json";
+
+    for(int k = 1; k < argc; k++){
+        if(strcmp(argv[k], "-o") == 0 && k+1 < argc) output = argv[++k];
+        else if(strcmp(argv[k], "-t") == 0 && k+1 < argc) minSampleNs = atof(argv[++k]) * 1e6;
+        else filter = argv[k];
+    }
+
+    printf("%-22s %-13s %14s %12s %14s\n", "case", "size", "ns/op", "allocs/op", "bytes/op");
+    for(int s = 0; s < numSizes; s++){
+        // Every case starts from the same seed, so a filtered run sees the same inputs
+        for(int c = 0; c < numCases; c++){
+            srand(BENCH_SEED);
+            cases[c](sizes[s]);
+        }
+    }
+
+    if(!writeJSON(output)){
+        fprintf(stderr, "Could not write %s\n", output);
+        return 1;
+    }
+    return 0;
+}
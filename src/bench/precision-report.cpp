@@ -0,0 +1,141 @@
+/* Error report of the scalar types accepted by QIF_PRECISION.
+ *
+ * Runs the numeric core (barycentric coordinates, channel composition,
+ * posteriors and the truncated geometric and random response mechanisms)
+ * in float and double and prints the largest absolute difference to the
+ * same computation in long double, which is the reference.
+ *
+ * Usage: precision-report [samples]
+ *
+ * The mechanisms print the result of their own row checks to stderr,
+ * redirect it to keep only the report.
+ */
+
+#include "../graphics.h"
+#include "../truncated-geometric.h"
+#include "../random-response.h"
+#include <cstdio>
+#include <cstdlib>
+
+// Random channel (each row is a probability distribution)
+static void randomChannel(FlatMatrix<long double> &M, int rows, int cols){
+    M.resize(rows, cols);
+    for(int i = 0; i < rows; i++){
+        long double sum = 0;
+        for(int j = 0; j < cols; j++){
+            M(i, j) = rand() % 1000;
+            sum += M(i, j);
+        }
+        for(int j = 0; j < cols; j++)
+            M(i, j) = sum > 0 ? M(i, j)/sum : (j == 0);
+    }
+}
+
+template<typename T>
+static void convert(const FlatMatrix<long double> &from, FlatMatrix<T> &to){
+    to.resize(from.rows, from.cols);
+    for(unsigned long k = 0; k < from.values.size(); k++)
+        to.values[k] = from.values[k];
+}
+
+template<typename T>
+static long double maxError(const FlatMatrix<T> &M, const FlatMatrix<long double> &reference){
+    long double err = 0;
+    for(unsigned long k = 0; k < reference.values.size(); k++)
+        err = max(err, fabsl((long double)M.values[k] - reference.values[k]));
+    return err;
+}
+
+template<typename T>
+static long double maxError(const vector<vector<T>> &M, const vector<vector<long double>> &reference){
+    long double err = 0;
+    for(unsigned long i = 0; i < reference.size(); i++)
+        for(unsigned long j = 0; j < reference[i].size(); j++)
+            err = max(err, fabsl((long double)M[i][j] - reference[i][j]));
+    return err;
+}
+
+// Posteriors of a channel for a prior, inners(i, y) = prior[i]*C(i, y)/outer[y]
+template<typename T>
+static void posteriors(const FlatMatrix<T> &C, const T *prior, FlatMatrix<T> &inners){
+    inners.resize(C.rows, C.cols);
+    for(int y = 0; y < C.cols; y++){
+        T outer = 0;
+        for(int i = 0; i < C.rows; i++)
+            outer += prior[i] * C(i, y);
+        for(int i = 0; i < C.rows; i++)
+            inners(i, y) = outer > 0 ? prior[i] * C(i, y) / outer : 0;
+    }
+}
+
+// Largest error of each stage of the numeric core in precision T
+template<typename T>
+static void report(const char *name, int samples){
+    long double errBary = 0, errCompose = 0, errPosteriors = 0, errTG = 0, errRR = 0;
+    srand(1);
+
+    // Prior -> barycentric coordinate -> prior
+    for(int s = 0; s < samples; s++){
+        long double p[3] = {(long double)(rand() % 1001), (long double)(rand() % 1001), (long double)(rand() % 1001)};
+        long double sum = p[0] + p[1] + p[2];
+        if(sum == 0) continue;
+        for(int i = 0; i < 3; i++) p[i] /= sum;
+
+        long double reference[3];
+        T prob[3];
+        bool okReference = bary2Dist(dist2Bary(p[0], p[1], p[2]), reference);
+        bool ok = bary2Dist(dist2Bary((T)p[0], (T)p[1], (T)p[2]), prob);
+        if(ok != okReference){
+            errBary = INFINITY;
+            continue;
+        }
+        for(int i = 0; ok && i < 3; i++)
+            errBary = max(errBary, fabsl((long double)prob[i] - reference[i]));
+    }
+
+    // Composition of the channels of refinement mode and posteriors of the composition
+    int sizes[] = {3, 10, 50};
+    for(int s = 0; s < samples; s++){
+        int m = sizes[s % 3];
+        FlatMatrix<long double> C, R, CR, innersReference;
+        FlatMatrix<T> cC, cR, cCR, inners;
+        randomChannel(C, NUMBER_SECRETS, m);
+        randomChannel(R, m, m);
+        convert(C, cC);
+        convert(R, cR);
+
+        composeChannels(C, R, CR, true);
+        composeChannels(cC, cR, cCR);
+        errCompose = max(errCompose, maxError(cCR, CR));
+
+        long double prior[3] = {0.2L, 0.3L, 0.5L};
+        T cPrior[3] = {(T)0.2L, (T)0.3L, (T)0.5L};
+        posteriors(CR, prior, innersReference);
+        posteriors(cCR, cPrior, inners);
+        errPosteriors = max(errPosteriors, maxError(inners, innersReference));
+    }
+
+    // Mechanisms
+    for(int size = 2; size <= 50; size++){
+        long double alpha = 0.5L, epsilon = logl(2), delta = 0;
+        TG::truncated_geometric<long double> tgReference(size, alpha);
+        TG::truncated_geometric<T> tg(size, (T)alpha);
+        errTG = max(errTG, maxError(tg.get_channel(size, (T)alpha), tgReference.get_channel(size, alpha)));
+
+        RR::random_response<long double> rrReference(size, epsilon, delta);
+        RR::random_response<T> rr(size, (T)epsilon, (T)delta);
+        errRR = max(errRR, maxError(rr.get_channel(size, (T)epsilon, (T)delta), rrReference.get_channel(size, epsilon, delta)));
+    }
+
+    printf("%-8s %14.3Le %14.3Le %14.3Le %14.3Le %14.3Le\n", name, errBary, errCompose, errPosteriors, errTG, errRR);
+}
+
+int main(int argc, char *argv[]){
+    int samples = argc > 1 ? atoi(argv[1]) : 1000;
+
+    printf("Largest absolute error against long double (%d samples, build precision: %s)\n\n", samples, REAL_NAME);
+    printf("%-8s %14s %14s %14s %14s %14s\n", "type", "bary", "compose", "posteriors", "TG", "RR");
+    report<float>("float", samples);
+    report<double>("double", samples);
+    return 0;
+}
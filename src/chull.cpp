@@ -40,3 +40,42 @@ void convexHull(vector<pt>& a) {
     for (unsigned long int i = down.size() - 2; i > 0; i--)
         a.push_back(down[i]);
 }
+
+void convexHullIndices(const vector<pt>& a, vector<int>& hull, vector<int>& order) {
+    hull.clear();
+    if (a.empty())
+        return;
+
+    order.resize(a.size());
+    for (unsigned long int i = 0; i < a.size(); i++)
+        order[i] = i;
+
+    if (a.size() == 1) {
+        hull.push_back(0);
+        return;
+    }
+
+    sort(order.begin(), order.end(), [&a](int i, int j) { return cmp(a[i], a[j]); });
+    pt p1 = a[order[0]], p2 = a[order.back()];
+
+    // The upper chain is built in 'hull'. The lower chain is built in the beginning of 'order':
+    // at step i it has at most i+1 elements, so it never overwrites a point not read yet.
+    unsigned long int n = order.size(), down = 1;
+    hull.push_back(order[0]);
+    for (unsigned long int i = 1; i < n; i++) {
+        int k = order[i];
+        if (i == n - 1 || cw(p1, a[k], p2)) {
+            while (hull.size() >= 2 && !cw(a[hull[hull.size()-2]], a[hull[hull.size()-1]], a[k]))
+                hull.pop_back();
+            hull.push_back(k);
+        }
+        if (i == n - 1 || ccw(p1, a[k], p2)) {
+            while (down >= 2 && !ccw(a[order[down-2]], a[order[down-1]], a[k]))
+                down--;
+            order[down++] = k;
+        }
+    }
+
+    for (unsigned long int i = down - 2; i > 0; i--)
+        hull.push_back(order[i]);
+}
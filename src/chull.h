@@ -29,4 +29,9 @@ bool ccw(pt a, pt b, pt c);
 // Given a set of points return its convex hull
 void convexHull(vector<pt>& a);
 
+/* Given a set of points, fill 'hull' with the indices of the points that make up its
+ * convex hull, in the same order returned by convexHull. The points are not changed
+ * and 'order' is used as scratch memory, so repeated calls do not allocate. */
+void convexHullIndices(const vector<pt>& a, vector<int>& hull, vector<int>& order);
+
 #endif
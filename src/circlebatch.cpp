@@ -0,0 +1,78 @@
+#include "circlebatch.h"
+#include <cmath>
+
+int circleSegments(float radius){
+    if(radius <= CIRCLE_MAX_ERROR)
+        return CIRCLE_MIN_SEGMENTS;
+
+    // A segment of angle a is 1 - cos(a/2) times the radius away from the circle
+    int segments = (int)ceil(PI / acos(1.0f - CIRCLE_MAX_ERROR / radius));
+    return max(CIRCLE_MIN_SEGMENTS, min(CIRCLE_MAX_SEGMENTS, segments));
+}
+
+CircleBatch::CircleBatch(){
+    version = 0;
+    built = false;
+    withHull = false;
+}
+
+bool CircleBatch::needsBuild(unsigned long circlesVersion, bool showHull){
+    return !built || version != circlesVersion || (showHull && !withHull);
+}
+
+void CircleBatch::build(const vector<Circle> &circles, int n, const vector<pt> *hull, unsigned long circlesVersion){
+    fill.clear();
+    outline.clear();
+    hullFill.clear();
+    hullOutline.clear();
+
+    for(int i = 0; i < n; i++){
+        float x = circles[i].center.x, y = circles[i].center.y, r = circles[i].radius;
+        int segments = circleSegments(r);
+        float step = 2*PI/segments;
+
+        Vector2 previous = {x + r, y};
+        for(int k = 1; k <= segments; k++){
+            Vector2 cur = (k == segments) ? (Vector2){x + r, y} : (Vector2){x + r*cosf(k*step), y + r*sinf(k*step)};
+
+            // Counter clockwise on the screen, as DrawCircle does
+            fill.push_back((Vector2){x, y});
+            fill.push_back(cur);
+            fill.push_back(previous);
+
+            outline.push_back(previous);
+            outline.push_back(cur);
+            previous = cur;
+        }
+    }
+
+    int h = (hull == NULL) ? 0 : (int)hull->size();
+    for(int i = 0; i < h; i++){
+        const pt &p = (*hull)[i], &q = (*hull)[(i+1)%h];
+        Vector2 a = {(float)p.x, (float)p.y};
+        Vector2 b = {(float)q.x, (float)q.y};
+
+        // Fan from the first vertex, the same triangles DrawTriangle was called with
+        if(i > 0 && i < h-1){
+            hullFill.push_back((Vector2){(float)(*hull)[0].x, (float)(*hull)[0].y});
+            hullFill.push_back(a);
+            hullFill.push_back(b);
+        }
+
+        hullOutline.push_back(a);
+        hullOutline.push_back(b);
+    }
+
+    version = circlesVersion;
+    built = true;
+    withHull = hull != NULL;
+}
+
+void CircleBatch::draw(Renderer &renderer, Color colorFill, Color colorLines, Color colorHull, bool showHull){
+    renderer.vertices(fill, PRIMITIVE_TRIANGLES, colorFill);
+    renderer.vertices(outline, PRIMITIVE_LINES, colorLines);
+    if(showHull){
+        renderer.vertices(hullOutline, PRIMITIVE_LINES, colorLines);
+        renderer.vertices(hullFill, PRIMITIVE_TRIANGLES, colorHull);
+    }
+}
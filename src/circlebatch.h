@@ -0,0 +1,59 @@
+#ifndef _circlebatch
+#define _circlebatch
+
+#include "graphics.h"
+#include "chull.h"
+#include "renderer.h"
+#include <vector>
+
+using namespace std;
+
+// Largest distance (in pixels) between a circle and the polygon used to draw it
+#define CIRCLE_MAX_ERROR 0.5f
+#define CIRCLE_MIN_SEGMENTS 6
+#define CIRCLE_MAX_SEGMENTS 72
+
+/* Number of segments of the polygon used to draw a circle, so the polygon is never
+ * further than CIRCLE_MAX_ERROR from the circle. Small circles get a few segments. */
+int circleSegments(float radius);
+
+/* Vertices of the inners circles and the convex hull of a channel.
+ *
+ * Drawing each inner with DrawCircle and DrawCircleLines tessellates it again every frame
+ * with a fixed number of segments. The batch keeps the tessellated vertices and is rebuilt
+ * only when the circles change, so a frame only gives them to the renderer, with one
+ * call per primitive type. */
+class CircleBatch{
+public:
+	CircleBatch();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	unsigned long version;		// Version of the circles the vertices were built from
+	bool built;					// Flag that indicates wheter the vertices were built at least once
+	bool withHull;				// Flag that indicates wheter the hull vertices were built
+
+	vector<Vector2> fill;		// Triangles of the circles, 3 vertices each
+	vector<Vector2> outline;	// Segments of the circles borders, 2 vertices each
+	vector<Vector2> hullFill;	// Triangles of the convex hull, 3 vertices each
+	vector<Vector2> hullOutline;// Segments of the convex hull border, 2 vertices each
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Returns true if the vertices were not built from the given version of the circles,
+	 * or if the hull is needed and it was not built. */
+	bool needsBuild(unsigned long circlesVersion, bool showHull);
+
+	/* Tessellate the first n circles and, if it is not NULL, the hull (vertices in hull order).
+	 * The memory of the vertex arrays is reused, so it does not allocate while the sizes do not grow. */
+	void build(const vector<Circle> &circles, int n, const vector<pt> *hull, unsigned long circlesVersion);
+
+	/* Give the vertices to the renderer. The hull is drawn only if showHull is true. */
+	void draw(Renderer &renderer, Color colorFill, Color colorLines, Color colorHull, bool showHull);
+};
+
+#endif
@@ -0,0 +1,255 @@
+/* Headless batch evaluation of .qifg files.
+ *
+ * Computes the prior, the channels, the composition and the hypers of every
+ * file the same way the GUI does and streams the posteriors as CSV or JSON
+ * (one object per line). Files are spread across a thread pool and results
+ * are written as soon as each file is done, so the order of the output is
+ * not the order of the input.
+ *
+ * Usage: qif-graphics-cli [-f csv|json] [-j threads] [-p digits] file|directory ...
+ *      Directories are searched recursively for .qifg files.
+ *
+ * The exit status is 0 if every file was read and computed, and 1 if any file
+ * could not be read or had an error (it is still reported in the output), or
+ * if the arguments are invalid.
+ */
+
+#include "../qiffile.h"
+#include "../scenario.h"
+#include "../threadpool.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#define FORMAT_CSV 0
+#define FORMAT_JSON 1
+
+// Names of the error codes defined in graphics.h
+static const char *errorNames[] = {
+    "NO_ERROR", "INVALID_PRIOR", "INVALID_CHANNEL_1", "INVALID_CHANNEL_2_D", "INVALID_CHANNEL_2_R",
+    "INVALID_CHANNEL_3", "INVALID_VALUE_PRIOR", "INVALID_VALUE_CHANNEL_1", "INVALID_VALUE_CHANNEL_2",
+    "INVALID_VALUE_CHANNEL_3", "INVALID_QIF_FILE", "INVALID_COMPOSITION"
+};
+
+static const char* errorName(int error){
+    if(error < 0 || error >= (int)(sizeof(errorNames)/sizeof(errorNames[0])))
+        return "UNKNOWN_ERROR";
+    return errorNames[error];
+}
+
+static bool isDirectory(const string &path){
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool hasQIFExtension(const string &name){
+    return name.size() > 5 && name.compare(name.size() - 5, 5, ".qifg") == 0;
+}
+
+// Add the .qifg files of a directory and its subdirectories, sorted by name
+static void collectFiles(const string &dirName, vector<string> &files){
+    DIR *dir = opendir(dirName.c_str());
+    if(dir == NULL){
+        fprintf(stderr, "Could not open directory %s\n", dirName.c_str());
+        return;
+    }
+
+    vector<string> entries;
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL){
+        string name = entry->d_name;
+        if(name != "." && name != "..")
+            entries.push_back(dirName + "/" + name);
+    }
+    closedir(dir);
+
+    sort(entries.begin(), entries.end());
+    for(unsigned long i = 0; i < entries.size(); i++){
+        if(isDirectory(entries[i]))
+            collectFiles(entries[i], files);
+        else if(hasQIFExtension(entries[i]))
+            files.push_back(entries[i]);
+    }
+}
+
+static string csvField(const string &s){
+    if(s.find_first_of(",\"\n") == string::npos)
+        return s;
+
+    string out = "\"";
+    for(unsigned long i = 0; i < s.size(); i++){
+        if(s[i] == '"') out += '"';
+        out += s[i];
+    }
+    return out + "\"";
+}
+
+static string jsonString(const string &s){
+    string out = "\"";
+    char buffer[8];
+    for(unsigned long i = 0; i < s.size(); i++){
+        unsigned char c = s[i];
+        if(c == '"' || c == '\\'){
+            out += '\\';
+            out += c;
+        }else if(c < 0x20){
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        }else{
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static void appendNumber(string &out, long double value, int digits){
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*Lg", digits, value);
+    out += buffer;
+}
+
+// Results of one file in CSV, one line per posterior: file,mode,error,channel,posterior,outer,inner1,inner2,inner3
+static void formatCSV(const string &fileName, int read, Scenario &scenario, int digits, string &out){
+    string prefix = csvField(fileName) + ",";
+    if(read == INVALID_QIF_FILE){
+        out += prefix + "," + errorName(INVALID_QIF_FILE) + ",,,,,,\n";
+        return;
+    }
+
+    prefix += to_string(scenario.mode) + ",";
+    if(scenario.error != NO_ERROR){
+        out += prefix + errorName(scenario.error) + ",,,,,,\n";
+        return;
+    }
+
+    for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
+        if(!scenario.hyperReady[channel]) continue;
+
+        Hyper &hyper = scenario.hyper[channel];
+        for(int k = 0; k < hyper.num_post; k++){
+            out += prefix + errorName(NO_ERROR) + "," + to_string(channel + 1) + "," + to_string(k + 1) + ",";
+            appendNumber(out, hyper.outer.prob[k], digits);
+            for(int i = 0; i < NUMBER_SECRETS; i++){
+                out += ",";
+                appendNumber(out, hyper.inners[i][k], digits);
+            }
+            out += "\n";
+        }
+    }
+}
+
+// Results of one file as a JSON object in a single line
+static void formatJSON(const string &fileName, int read, Scenario &scenario, int digits, string &out){
+    out += "{\"file\":" + jsonString(fileName);
+    if(read == INVALID_QIF_FILE){
+        out += ",\"mode\":null,\"error\":\"" + string(errorName(INVALID_QIF_FILE)) + "\"}\n";
+        return;
+    }
+
+    out += ",\"mode\":" + to_string(scenario.mode) + ",\"error\":\"" + errorName(scenario.error) + "\"";
+    if(scenario.error != NO_ERROR){
+        out += "}\n";
+        return;
+    }
+
+    out += ",\"hypers\":[";
+    bool first = true;
+    for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
+        if(!scenario.hyperReady[channel]) continue;
+
+        Hyper &hyper = scenario.hyper[channel];
+        out += (first ? "" : ",") + string("{\"channel\":") + to_string(channel + 1) + ",\"outer\":[";
+        first = false;
+        for(int k = 0; k < hyper.num_post; k++){
+            if(k > 0) out += ",";
+            appendNumber(out, hyper.outer.prob[k], digits);
+        }
+        out += "],\"inners\":[";
+        for(int k = 0; k < hyper.num_post; k++){
+            out += k > 0 ? ",[" : "[";
+            for(int i = 0; i < NUMBER_SECRETS; i++){
+                if(i > 0) out += ",";
+                appendNumber(out, hyper.inners[i][k], digits);
+            }
+            out += "]";
+        }
+        out += "]}";
+    }
+    out += "]}\n";
+}
+
+static void usage(){
+    fprintf(stderr, "Usage: qif-graphics-cli [-f csv|json] [-j threads] [-p digits] file|directory ...\n");
+    fprintf(stderr, "Exit status: 0 if every file was read and computed, 1 if any file had an error or the arguments are invalid\n");
+}
+
+int main(int argc, char *argv[]){
+    int format = FORMAT_CSV, numThreads = 0, digits = 10;
+    vector<string> files;
+
+    for(int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if((arg == "-f" || arg == "-j" || arg == "-p") && i+1 < argc){
+            string value = argv[++i];
+            if(arg == "-f" && value == "csv") format = FORMAT_CSV;
+            else if(arg == "-f" && value == "json") format = FORMAT_JSON;
+            else if(arg == "-j") numThreads = atoi(value.c_str());
+            else if(arg == "-p") digits = atoi(value.c_str());
+            else{
+                usage();
+                return 1;
+            }
+        }else if(arg[0] == '-'){
+            usage();
+            return 1;
+        }else if(isDirectory(arg)){
+            collectFiles(arg, files);
+        }else{
+            files.push_back(arg);
+        }
+    }
+
+    if(files.empty()){
+        usage();
+        return 1;
+    }
+
+    ThreadPool pool(numThreads);
+    vector<QIFFile> qifFiles(pool.size());
+    vector<Scenario> scenarios(pool.size());
+    vector<string> buffers(pool.size());
+    mutex outputLock;
+    int numErrors = 0;
+
+    if(format == FORMAT_CSV)
+        printf("file,mode,error,channel,posterior,outer,inner1,inner2,inner3\n");
+
+    pool.parallelFor((int)files.size(), [&](int index, int worker){
+        QIFFile &qifFile = qifFiles[worker];
+        Scenario &scenario = scenarios[worker];
+        string &out = buffers[worker];
+
+        int read = qifFile.read(files[index]);
+        if(read != INVALID_QIF_FILE)
+            scenario.compute(qifFile);
+
+        out.clear();
+        if(format == FORMAT_CSV)
+            formatCSV(files[index], read, scenario, digits, out);
+        else
+            formatJSON(files[index], read, scenario, digits, out);
+
+        lock_guard<mutex> guard(outputLock);
+        fwrite(out.data(), 1, out.size(), stdout);
+        if(read == INVALID_QIF_FILE)
+            fprintf(stderr, "%s: %s\n", files[index].c_str(), qifFile.errorString().c_str());
+        if(read == INVALID_QIF_FILE || scenario.error != NO_ERROR)
+            numErrors++;
+    });
+
+    fprintf(stderr, "%d files, %d with errors\n", (int)files.size(), numErrors);
+    return numErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+#include "compose.h"
+
+// Vector of 32 bytes used by the innermost loop of composeKernel for each scalar type
+template<typename T>
+struct ComposeVector{
+    static const int width = 1;
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+    // Without AVX the compiler splits each operation in two SSE2 operations.
+    typedef double v4d __attribute__((vector_size(4*sizeof(double))));
+    typedef float v8f __attribute__((vector_size(8*sizeof(float))));
+
+    template<>
+    struct ComposeVector<double>{
+        typedef v4d type;
+        static const int width = 4;
+    };
+
+    template<>
+    struct ComposeVector<float>{
+        typedef v8f type;
+        static const int width = 8;
+    };
+#endif
+
+// Innermost loop of the kernel, o[j] += a*b[j] for j in [j, jEnd). Returns the first j not processed.
+template<typename T, int width>
+struct ComposeRow{
+    static int run(T a, const T *b, T *o, int j, int jEnd){
+        typedef typename ComposeVector<T>::type vec;
+        vec va;
+        for(int k = 0; k < width; k++) va[k] = a;
+        for(; j + width <= jEnd; j += width){
+            vec vb, vo;
+            memcpy(&vb, b + j, sizeof(vec));
+            memcpy(&vo, o + j, sizeof(vec));
+            vo += va * vb;
+            memcpy(o + j, &vo, sizeof(vec));
+        }
+        return j;
+    }
+};
+
+// Types without vector support go straight to the scalar loop
+template<typename T>
+struct ComposeRow<T, 1>{
+    static int run(T, const T*, T*, int j, int){
+        return j;
+    }
+};
+
+template<typename T>
+void composeKernel(const T *A, const T *B, T *out, int n, int m, int p){
+    for(int i = 0; i < n*p; i++)
+        out[i] = 0;
+
+    for(int kk = 0; kk < m; kk += COMPOSE_BLOCK_K){
+        int kEnd = kk + COMPOSE_BLOCK_K < m ? kk + COMPOSE_BLOCK_K : m;
+
+        for(int jj = 0; jj < p; jj += COMPOSE_BLOCK_J){
+            int jEnd = jj + COMPOSE_BLOCK_J < p ? jj + COMPOSE_BLOCK_J : p;
+
+            for(int i = 0; i < n; i++){
+                T *o = out + (long)i*p;
+
+                for(int k = kk; k < kEnd; k++){
+                    T a = A[(long)i*m + k];
+                    // Channels are usually sparse, zeros add nothing
+                    if(a == 0) continue;
+
+                    const T *b = B + (long)k*p;
+                    int j = ComposeRow<T, ComposeVector<T>::width>::run(a, b, o, jj, jEnd);
+                    for(; j < jEnd; j++)
+                        o[j] += a * b[j];
+                }
+            }
+        }
+    }
+}
+
+template void composeKernel(const float *A, const float *B, float *out, int n, int m, int p);
+template void composeKernel(const double *A, const double *B, double *out, int n, int m, int p);
+template void composeKernel(const long double *A, const long double *B, long double *out, int n, int m, int p);
+
+void composeKernelReference(const long double *A, const long double *B, long double *out, int n, int m, int p){
+    for(int i = 0; i < n*p; i++)
+        out[i] = 0;
+
+    for(int i = 0; i < n; i++){
+        for(int k = 0; k < m; k++){
+            long double a = A[(long)i*m + k];
+            for(int j = 0; j < p; j++)
+                out[(long)i*p + j] += a * B[(long)k*p + j];
+        }
+    }
+}
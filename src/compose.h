@@ -0,0 +1,31 @@
+#ifndef _compose
+#define _compose
+
+#include <vector>
+#include <string.h> // memcpy
+
+using namespace std;
+
+// Block sizes (in elements) of the composition kernel. A block of B with
+// COMPOSE_BLOCK_K rows and COMPOSE_BLOCK_J columns of doubles takes 32 KB.
+#define COMPOSE_BLOCK_K 64
+#define COMPOSE_BLOCK_J 64
+
+/* Multiply two row-major matrices stored in contiguous buffers, out = A*B.
+ * The loops are in i-k-j order and blocked on k and j, so rows of B are read
+ * sequentially and the innermost loop is vectorized (32 bytes per operation for
+ * float and double; long double is not vectorized).
+ * It is instantiated for float, double and long double.
+ * Parameters:
+ *		A:   n x m matrix
+ *		B:   m x p matrix
+ *		out: n x p matrix. It is overwritten and must not overlap A or B.
+ */
+template<typename T>
+void composeKernel(const T *A, const T *B, T *out, int n, int m, int p);
+
+/* Same as composeKernel, but in long double and without blocking or vectorization.
+ * Used as the reference when precision matters more than speed. */
+void composeKernelReference(const long double *A, const long double *B, long double *out, int n, int m, int p);
+
+#endif
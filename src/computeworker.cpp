@@ -0,0 +1,45 @@
+#include "computeworker.h"
+
+void ComputeTask::start(ComputeJob &job, ComputeResult &result){
+    stage = 0;
+    result.composed = false;
+    result.compositionError = NO_ERROR;
+    for(int c = 0; c < NUMBER_CHANNELS; c++)
+        result.built[c] = false;
+}
+
+int ComputeTask::step(ComputeJob &job, ComputeResult &result){
+    runStage(job, result, stage++);
+    return stage < COMPUTE_STAGES ? TASK_CONTINUE : TASK_DONE;
+}
+
+void ComputeTask::runStage(ComputeJob &job, ComputeResult &result, int stage){
+    if(stage == COMPUTE_STAGE_COMPOSITION){
+        if(!job.compose)
+            return;
+
+        // Multiply channels C and R
+        result.composed = true;
+        result.compositionError = INVALID_COMPOSITION;
+        if(composeChannels(job.channel[CHANNEL_1], job.channel[CHANNEL_2], job.channel[CHANNEL_3]) != NO_ERROR)
+            return;
+
+        job.channel[CHANNEL_3].toNested(rows);
+        if(!Channel::isChannel(rows))
+            return;
+
+        job.channelObj[CHANNEL_3] = Channel(job.prior, rows);
+        result.composition = job.channel[CHANNEL_3];
+        result.compositionObj = job.channelObj[CHANNEL_3];
+        result.compositionError = NO_ERROR;
+        return;
+    }
+
+    int channel = stage - COMPUTE_STAGE_HYPER_1;
+    if(!job.hyper[channel] || (channel == CHANNEL_3 && result.composed && result.compositionError != NO_ERROR))
+        return;
+
+    result.hyper[channel] = Hyper(job.channelObj[channel]);
+    result.hyperCache[channel].build(job.channel[channel]);
+    result.built[channel] = true;
+}
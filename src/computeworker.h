@@ -0,0 +1,58 @@
+#ifndef _computeworker
+#define _computeworker
+
+#include "graphics.h"
+#include "hypercache.h"
+#include "latestjobworker.h"
+
+using namespace std;
+
+// Stages of a job: the composition and then the hyper of each channel
+#define COMPUTE_STAGE_COMPOSITION 0
+#define COMPUTE_STAGE_HYPER_1 1
+#define COMPUTE_STAGES (1 + NUMBER_CHANNELS)
+
+// Time (in milliseconds) a frame can spend in the computation when there are no threads
+#define COMPUTE_SLICE_MS 8
+
+/* Snapshot of the inputs of a job. It is copied when the job is submitted,
+ * so the worker never reads the objects the interface keeps changing. */
+typedef struct ComputeJob{
+	unsigned long generation;			// Set by submit()
+	Distribution prior;					// Prior used to build the composition
+	Matrix channel[NUMBER_CHANNELS];	// Channel matrices. Channel 3 is only used if it is not composed.
+	Channel channelObj[NUMBER_CHANNELS];
+	bool compose;						// Flag that indicates wheter channel 3 is the composition of channels 1 and 2
+	bool hyper[NUMBER_CHANNELS];		// Flags that indicate which hypers are built
+} ComputeJob;
+
+typedef struct ComputeResult{
+	unsigned long generation;			// Generation of the job
+	bool composed;						// Flag that indicates wheter the composition was computed
+	int compositionError;				// NO_ERROR or INVALID_COMPOSITION
+	Matrix composition;
+	Channel compositionObj;
+	bool built[NUMBER_CHANNELS];		// Flags that indicate which hypers were built
+	Hyper hyper[NUMBER_CHANNELS];
+	HyperCache hyperCache[NUMBER_CHANNELS];
+} ComputeResult;
+
+/* Builds compositions and hypers out of the frame, a stage per step of a LatestJobWorker.
+ *
+ * A job that is cancelled stops at the end of its current stage (a hyper that is being
+ * built is not interrupted), and the result is only published when every stage is done. */
+class ComputeTask{
+public:
+	void start(ComputeJob &job, ComputeResult &result);
+	int step(ComputeJob &job, ComputeResult &result);
+
+private:
+	int stage;							// Next stage of the job
+	vector<vector<long double>> rows;	// Scratch memory for the composition channel object
+
+	void runStage(ComputeJob &job, ComputeResult &result, int stage);
+};
+
+typedef LatestJobWorker<ComputeJob, ComputeResult, ComputeTask, COMPUTE_SLICE_MS> ComputeWorker;
+
+#endif
@@ -1,127 +1,98 @@
 #include "data.h"
+#include "profiler.h"
 
 Data::Data(){
-    // Flags
-    for(int i = 0; i < 8; i++){
-        compute[i] = false;
-        ready[i] = false;
-    }
+    // Dependency graph
+    graph.addNode(NODE_PRIOR, "prior", {});
+    graph.addNode(NODE_CHANNEL_1, "channel1", {NODE_PRIOR});
+    graph.addNode(NODE_CHANNEL_2, "channel2", {NODE_PRIOR});
+    graph.addNode(NODE_CHANNEL_3, "composition", {NODE_CHANNEL_1, NODE_CHANNEL_2});
+    graph.addNode(NODE_HYPER_1, "hyper1", {NODE_CHANNEL_1});
+    graph.addNode(NODE_HYPER_2, "hyper2", {NODE_CHANNEL_2});
+    graph.addNode(NODE_HYPER_3, "hyper3", {NODE_CHANNEL_3});
+    graph.addNode(NODE_CIRCLES, "circles", {NODE_HYPER_1, NODE_HYPER_2, NODE_HYPER_3});
+    setMode(MODE_SINGLE);
 
     for(int i = 0; i < NUMBER_CHANNELS; i++)
         hyper[i] = Hyper();
 
     prior = vector<long double>(NUMBER_SECRETS, 0);
-    channel = vector<vector<vector<long double>>>(NUMBER_CHANNELS, vector<vector<long double>>(MAX_CHANNEL_OUTPUTS, vector<long double>(MAX_CHANNEL_OUTPUTS, 0)));
     
-    validCharacters = string("0123456789./");
     error = NO_ERROR;
-    for(int i = 0; i < NUMBER_CHANNELS; i++)
+    for(int i = 0; i < NUMBER_CHANNELS; i++){
         hyperReady[i] = false;
+        innersHullValid[i] = false;
+        innersHullDirty[i] = true;
+        circlesVersion[i] = 1;
+    }
     mouseClickedOnPrior = false;
+    computing = false;
     fileSaved = true;
     
-    // Calculates the number of frames the animation will have, considering the software is running in 60 FPS
-    animation = -1;
+    now = 0;
     animationRunning = false;
+    for(int i = 0; i < NUMBER_CHANNELS; i++)
+        animationPath[i] = false;
+
+    for(int i = 0; i < NUMBER_CHANNELS; i++)
+        matrixVersion[i] = 0;
+
+    heatmapJob.generation = 0;
+    heatmapJob.channel = -1;
+    heatmapJob.source = 0;
+    heatmapJob.measure = HEATMAP_NONE;
+    for(int i = 0; i < 3; i++)
+        heatmapJob.trianglePoints[i] = (Vector2){0, 0};
+    heatmapImage.level = -1;
+
+    cloudJob.generation = 0;
+    cloudJob.count = 0;
+    cloudJob.priorsVersion = 0;
+    for(int l = 0; l < 2; l++){
+        cloudJob.channels[l] = -1;
+        cloudJob.sources[l] = 0;
+    }
+    for(int i = 0; i < 3; i++)
+        cloudJob.trianglePoints[i] = (Vector2){0, 0};
+    Color colors[PRIOR_CLOUD_LAYERS] = {PRIOR_COLOR, INNERS1_COLOR, INNERS2_COLOR};
+    for(int l = 0; l < PRIOR_CLOUD_LAYERS; l++)
+        cloudJob.colors[l] = colors[l];
+    cloudImage.generation = 0;
 }
 
 int Data::checkPriorText(char prior_[NUMBER_SECRETS][CHAR_BUFFER_SIZE]){
-    vector<pair<string, string>> newPrior(NUMBER_SECRETS);
-    string value;
-
-    try{
-        for(int i = 0; i < NUMBER_SECRETS; i++){
-            value = string(prior_[i]);
-            // Check if user has typed an invalid character
-            for(long unsigned int j = 0; j < value.size(); j++){
-                if(validCharacters.find(value[j]) == std::string::npos){
-                    return INVALID_VALUE_PRIOR;
-                }
-            }
+    long double newPrior[NUMBER_SECRETS];
 
-            size_t pos = value.find('/');
-            if(pos != string::npos){ // If true, the user is typing a fraction
-                string numerator = value.substr(0, pos);
-                string denominator = value.substr(pos+1, value.size()-pos-1);
-                
-                // Remove blank spaces
-                numerator.erase(remove(numerator.begin(), numerator.end(), ' '), numerator.end());
-                denominator.erase(remove(denominator.begin(), denominator.end(), ' '), denominator.end());
-                
-                newPrior[i] = make_pair(numerator, denominator);
-            }else{
-            	newPrior[i] = make_pair("not fraction", value);
-            }
-        }
-        
-        // Update values
-        this->prior = vector<long double>(NUMBER_SECRETS);
-        for(int i = 0; i < NUMBER_SECRETS; i++){
-        	if(newPrior[i].first == "not fraction"){
-        		this->prior[i] = std::stold(newPrior[i].second);
-        	}else{
-        		this->prior[i] = std::stold(newPrior[i].first)/std::stold(newPrior[i].second);
-        	}
-        }
-        
-        if(Distribution::isDistribution(this->prior))
-            priorObj = Distribution(this->prior);
-
-        return NO_ERROR;
-    }catch(exception& e){
-        return INVALID_VALUE_PRIOR;
+    for(int i = 0; i < NUMBER_SECRETS; i++){
+        if(!text2Value(prior_[i], newPrior[i]))
+            return INVALID_VALUE_PRIOR;
     }
+
+    // Update values
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        this->prior[i] = newPrior[i];
+
+    if(Distribution::isDistribution(this->prior))
+        priorObj = Distribution(this->prior);
+
+    return NO_ERROR;
 }
 
-int Data::checkChannelText(char channel_[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE], int channel, int numSecrets, int numOutputs){
-    vector<vector<pair<string, string>>> newChannel(numSecrets, vector<pair<string, string>>(numOutputs));
-    string value;
-
-    try{
-        for(int i = 0; i < numSecrets; i++){
-            for(int j = 0; j < numOutputs; j++){
-                value = string(channel_[i][j]);
-                // Check if user has typed an invalid character
-                for(long unsigned int k = 0; k < value.size(); k++){
-                    if(validCharacters.find(value[k]) == std::string::npos){
-                        return INVALID_VALUE_CHANNEL_1+channel;
-                    }
-                }
-
-                size_t pos = value.find('/');
-                if(pos != string::npos){ // If true, the user is typing a fraction
-                    string numerator = value.substr(0, pos);
-                    string denominator = value.substr(pos+1, value.size()-pos-1);
-                    
-                    // Remove blank spaces
-                    numerator.erase(remove(numerator.begin(), numerator.end(), ' '), numerator.end());
-                    denominator.erase(remove(denominator.begin(), denominator.end(), ' '), denominator.end());
-
-                    newChannel[i][j] = make_pair(numerator, denominator);
-                }else{
-                    newChannel[i][j] = make_pair("not fraction", value);
-                }
-            }
-        }
+int Data::checkChannelText(TextGrid &channel_, int channel, int numSecrets, int numOutputs){
+    // Columns and rows are inverted in channelStr.
+    if(!text2Matrix(channel_, numSecrets, numOutputs, this->channel[channel]))
+        return INVALID_VALUE_CHANNEL_1+channel;
 
-        // Update values. Columns and rows are inverted in channelStr.
-        this->channel[channel] = vector<vector<long double>>(numSecrets, vector<long double>(numOutputs));
-        for(int i = 0; i < numSecrets; i++){
-        	for(int j = 0; j < numOutputs; j++){
-        		if(newChannel[i][j].first == "not fraction"){
-        			this->channel[channel][i][j] = std::stold(newChannel[i][j].second);
-        		}else{
-        			this->channel[channel][i][j] = std::stold(newChannel[i][j].first)/std::stold(newChannel[i][j].second);
-        		}
-        	}
-        }
+    return NO_ERROR;
+}
 
-        return NO_ERROR;
-    }catch(exception& e){
-        if(channel == CHANNEL_1)
-            return INVALID_VALUE_CHANNEL_1;
-        return INVALID_VALUE_CHANNEL_2;
-    }
+int Data::buildChannel(int channel, Distribution &prior){
+    this->channel[channel].toNested(channelRows[channel]);
+    if(!Channel::isChannel(channelRows[channel]))
+        return INVALID_CHANNEL_1+channel;
+
+    channelObj[channel] = Channel(prior, channelRows[channel]);
+    return NO_ERROR;
 }
 
 void Data::buildPriorCircle(Vector2 TrianglePoints[3]){
@@ -132,44 +103,99 @@ void Data::buildPriorCircle(Vector2 TrianglePoints[3]){
     priorCircle.radius = PRIOR_RADIUS;
 }
 	
+void Data::startAnimation(double now){
+    this->now = now;
+    animation.begin(now, ANIMATION_DURATION, ANIMATION_EASING);
+    animationRunning = true;
+    for(int i = 0; i < NUMBER_CHANNELS; i++)
+        animationPath[i] = false;
+}
+
 void Data::buildInnerCircles(Vector2 TrianglePoints[3], int channel, int mode){
+    ProfileScope scope(PROFILE_INNER_CIRCLES);
     Point p;
+    int n = hyper[channel].num_post;
+
+    // Memory is kept while the number of posteriors does not grow
+    innersCircles[channel].resize(n);
+
+    if(animationRunning && !animation.finished(now)){
+        if(!animationPath[channel]){
+            // First draw of the animation: final positions and radius of the inners
+            innersTargetX[channel].resize(n);
+            innersTargetY[channel].resize(n);
+            innersHull[channel].resize(n);
+            for(int i = 0; i < n; i++){
+                p = dist2Bary(hyper[channel].inners[0][i], hyper[channel].inners[1][i], hyper[channel].inners[2][i]);
+                p = bary2Pixel(p.x, p.y, TrianglePoints);
+                innersTargetX[channel][i] = p.x;
+                innersTargetY[channel][i] = p.y;
+                innersCircles[channel][i].radius = (int)sqrt(hyper[channel].outer.prob[i] * PRIOR_RADIUS * PRIOR_RADIUS);
+                innersHull[channel][i].x = p.x;
+                innersHull[channel][i].y = p.y;
+            }
 
-    if(animationRunning && ((mode == MODE_SINGLE && animation == STEPS) || (mode != MODE_SINGLE && animation >= 2*STEPS))){
-        // First draw of the animation
-        for(int i = 0; i < hyper[channel].num_post; i++){
-            p = dist2Bary(hyper[channel].inners[0][i], hyper[channel].inners[1][i], hyper[channel].inners[2][i]);
-            p = bary2Pixel(p.x, p.y, TrianglePoints);
-            // All inners starts in prior position
-            innersCircles[channel][i].center = priorCircle.center;
-            innersCircles[channel][i].radius = (int)sqrt(hyper[channel].outer.prob[i] * PRIOR_RADIUS * PRIOR_RADIUS);
-            
-            long double deltaX = p.x - priorCircle.center.x;
-            long double deltaY = p.y - priorCircle.center.y;
-            xJumpAnimation[channel][i] = deltaX/STEPS;
-            yJumpAnimation[channel][i] = deltaY/STEPS;
+            /* All inners move from the prior to their final positions with the same progress,
+               i.e. at each frame they are a scaling of the final positions around the prior. 
+               The hull vertices are the same during the whole animation, so they are found once
+               using the final positions. */
+            convexHullIndices(innersHull[channel], innersHullIndex[channel], hullScratch);
+            innersHullValid[channel] = true;
+            animationPath[channel] = true;
         }
-        
-        animation--;
-    }else if(animationRunning && animation > 0){
-        // The animation is happening
-        for(int i = 0; i < hyper[channel].num_post; i++){
-            innersCircles[channel][i].center.x += xJumpAnimation[channel][i];
-            innersCircles[channel][i].center.y += yJumpAnimation[channel][i];
+
+        // Every inner at the same progress, in a single pass over the final positions
+        Real t = animation.progress(now);
+        Real x0 = priorCircle.center.x, y0 = priorCircle.center.y;
+        const Real *targetX = innersTargetX[channel].data(), *targetY = innersTargetY[channel].data();
+        Circle *circles = innersCircles[channel].data();
+        for(int i = 0; i < n; i++){
+            circles[i].center.x = x0 + t*(targetX[i] - x0);
+            circles[i].center.y = y0 + t*(targetY[i] - y0);
         }
-        animation--;
-    }else if((animationRunning && animation == 0) || animation == UPDATE_CIRCLES_BY_MOUSE){
+        innersHullDirty[channel] = true;
+        circlesVersion[channel]++;
+    }else{
         // The animation has finished or user moved the prior with the mouse
-        for(int i = 0; i < hyper[channel].num_post; i++){
+        for(int i = 0; i < n; i++){
             p = dist2Bary(hyper[channel].inners[0][i], hyper[channel].inners[1][i], hyper[channel].inners[2][i]);
             p = bary2Pixel(p.x, p.y, TrianglePoints);
             innersCircles[channel][i].center = Point(p.x, p.y);
             innersCircles[channel][i].radius = (int)sqrt(hyper[channel].outer.prob[i] * PRIOR_RADIUS * PRIOR_RADIUS);
         }
+        innersHullValid[channel] = false;
+        innersHullDirty[channel] = true;
+        circlesVersion[channel]++;
         animationRunning = false;
     }
 }
 
+void Data::updateInnersHull(int channel){
+    if(!innersHullDirty[channel])
+        return;
+
+    int n = hyper[channel].num_post;
+    if(!innersHullValid[channel]){
+        innersHull[channel].resize(n);
+        for(int i = 0; i < n; i++){
+            innersHull[channel][i].x = innersCircles[channel][i].center.x;
+            innersHull[channel][i].y = innersCircles[channel][i].center.y;
+        }
+        convexHullIndices(innersHull[channel], innersHullIndex[channel], hullScratch);
+        innersHullValid[channel] = true;
+    }
+
+    // Vertices in hull order
+    int h = (int) innersHullIndex[channel].size();
+    innersHull[channel].resize(h);
+    for(int i = 0; i < h; i++){
+        innersHull[channel][i].x = innersCircles[channel][innersHullIndex[channel][i]].center.x;
+        innersHull[channel][i].y = innersCircles[channel][innersHullIndex[channel][i]].center.y;
+    }
+
+    innersHullDirty[channel] = false;
+}
+
 int Data::orientation(Point p1, Point p2, Point p3){
     int val = (p2.y - p1.y) * (p3.x - p2.x) - 
               (p2.x - p1.x) * (p3.y - p2.y); 
@@ -182,16 +208,16 @@ int Data::orientation(Point p1, Point p2, Point p3){
 
 Point Data::pointIntersection(Point A, Point B, Point C, Point D){
     // Line AB represented as a1x + b1y = c1 
-    long double a1 = B.y - A.y; 
-    long double b1 = A.x - B.x; 
-    long double c1 = a1*(A.x) + b1*(A.y); 
+    Real a1 = B.y - A.y; 
+    Real b1 = A.x - B.x; 
+    Real c1 = a1*(A.x) + b1*(A.y); 
   
     // Line CD represented as a2x + b2y = c2 
-    long double a2 = D.y - C.y; 
-    long double b2 = C.x - D.x; 
-    long double c2 = a2*(C.x)+ b2*(C.y); 
+    Real a2 = D.y - C.y; 
+    Real b2 = C.x - D.x; 
+    Real c2 = a2*(C.x)+ b2*(C.y); 
   
-    long double determinant = a1*b2 - a2*b1; 
+    Real determinant = a1*b2 - a2*b1; 
   
     Point p = Point((b2*c1 - b1*c2)/determinant, (a1*c2 - a2*c1)/determinant);
 
@@ -300,24 +326,37 @@ Point Data::adjustPrior(Vector2 TrianglePoints[3], Vector2 mouse){
     return p;
 }
 
-void Data::updateHyper(Vector2 TrianglePoints[3], int mode){
+bool Data::updateHyper(Vector2 TrianglePoints[3], int mode){
+    ProfileScope scope(PROFILE_UPDATE_HYPER);
     Point mousePosition;
-    vector<long double> newPrior(NUMBER_SECRETS);
 
     mousePosition = adjustPrior(TrianglePoints, GetMousePosition());
     mousePosition = pixel2Bary(mousePosition.x, mousePosition.y, TrianglePoints);
     
-    bary2Dist(mousePosition, newPrior);
-    priorObj = Distribution(newPrior);
+    // The prior is written in place, so dragging does not allocate
+    if(!bary2Dist(mousePosition, prior))
+        return false;
 
-    hyper[CHANNEL_1].rebuildHyper(priorObj);
+    if(priorObj.num_el == NUMBER_SECRETS){
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            priorObj.prob[i] = prior[i];
+    }else{
+        priorObj = Distribution(prior);
+    }
 
-    if(mode == MODE_TWO)
-        hyper[CHANNEL_2].rebuildHyper(priorObj);
-    else if(mode == MODE_REF)
-        hyper[CHANNEL_3].rebuildHyper(priorObj);
+    // Hypers are changed in place, so only the nodes downstream (circles and textboxes) are affected
+    bool changed = false;
+    for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
+        if(!graph.ready(NODE_HYPER_1+channel))
+            continue;
 
-    prior = vector<long double>({newPrior[0], newPrior[1], newPrior[2]});
+        if(hyperCache[channel].update(mousePosition, priorObj, hyper[channel])){
+            graph.modified(NODE_HYPER_1+channel);
+            changed = true;
+        }
+    }
+
+    return changed;
 }
 
 void Data::newRandomPrior(){
@@ -337,10 +376,10 @@ void Data::newRandomPrior(){
 
 void Data::newRandomChannel(int curChannel, int numSecrets, int numOutputs){
     srand(unsigned(time(0)));
-    vector<long double> prob(numOutputs);
-    channel[curChannel] = vector<vector<long double>>(numSecrets, vector<long double>(numOutputs, 0));
+    channel[curChannel].resize(numSecrets, numOutputs);
 
     for(int i = 0; i < numSecrets; i++){
+        Real *prob = channel[curChannel].row(i);
         int threshold = 100, p;
         for(int j = 0; j < numOutputs-1; j++){
             p = rand() % threshold;
@@ -349,27 +388,106 @@ void Data::newRandomChannel(int curChannel, int numSecrets, int numOutputs){
         }
         prob[numOutputs-1] = threshold/100.0;
 
-        random_shuffle(prob.begin(), prob.end());
-
-        for(int j = 0; j < numOutputs; j++){
-            channel[curChannel][i][j] = prob[j];
-        }
+        random_shuffle(prob, prob + numOutputs);
     }
+    matrixVersion[curChannel]++;
 
-    if(ready[FLAG_PRIOR] && numSecrets == NUMBER_SECRETS){
-        channelObj[curChannel] = Channel(priorObj, channel[curChannel]);
+    if(graph.ready(NODE_PRIOR) && numSecrets == NUMBER_SECRETS){
+        buildChannel(curChannel, priorObj);
     }else{
         fakePrior = Distribution(numSecrets, "uniform");
-        channelObj[curChannel] = Channel(fakePrior, channel[curChannel]);
+        buildChannel(curChannel, fakePrior);
     }
 }
 
-void Data::resetAllExceptComputeChannel1(){
-    for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
-        ready[FLAG_CHANNEL_1+channel] = false;
-        compute[FLAG_CHANNEL_1+channel] = false;
-        ready[FLAG_HYPER_1+channel] = false;
-        compute[FLAG_HYPER_1+channel] = false;
+void Data::setMode(int mode){
+    graph.setEnabled(NODE_CHANNEL_2, mode == MODE_TWO || mode == MODE_REF);
+    graph.setEnabled(NODE_CHANNEL_3, mode == MODE_REF);
+    graph.setEnabled(NODE_HYPER_2, mode == MODE_TWO);
+    graph.setEnabled(NODE_HYPER_3, mode == MODE_REF);
+}
+
+bool Data::updatePriorCloud(Vector2 TrianglePoints[3], int mode, bool shown){
+    if(shown && cloud.count == 0)
+        cloud.sample(PRIOR_CLOUD_SIZE, PRIOR_CLOUD_ALPHA, unsigned(time(0)));
+
+    // The same channels whose inners are drawn
+    int channels[2] = {CHANNEL_1, -1};
+    if(mode == MODE_TWO) channels[1] = CHANNEL_2;
+    else if(mode == MODE_REF) channels[1] = CHANNEL_3;
+
+    unsigned long sources[2] = {0, 0};
+    for(int l = 0; l < 2; l++){
+        if(channels[l] < 0) continue;
+        int node = NODE_CHANNEL_1 + channels[l];
+        if(graph.ready(node)) sources[l] = matrixVersion[channels[l]];
+        else channels[l] = -1;
+    }
+
+    unsigned long priorsVersion = shown ? cloud.version : 0;
+    bool same = priorsVersion == cloudJob.priorsVersion;
+    for(int l = 0; l < 2 && same; l++)
+        same = channels[l] == cloudJob.channels[l] && sources[l] == cloudJob.sources[l];
+    for(int i = 0; i < 3 && same; i++)
+        same = TrianglePoints[i].x == cloudJob.trianglePoints[i].x && TrianglePoints[i].y == cloudJob.trianglePoints[i].y;
+
+    bool changed = false;
+    if(!same){
+        cloudJob.priorsVersion = priorsVersion;
+        for(int l = 0; l < 2; l++){
+            cloudJob.channels[l] = channels[l];
+            cloudJob.sources[l] = sources[l];
+        }
+        for(int i = 0; i < 3; i++)
+            cloudJob.trianglePoints[i] = TrianglePoints[i];
+
+        // The previous image is kept until the new one is finished
+        if(priorsVersion > 0){
+            cloudJob.priors = cloud.priors;
+            cloudJob.count = cloud.count;
+            for(int l = 0; l < 2; l++)
+                if(channels[l] >= 0) cloudJob.matrix[l] = channel[channels[l]];
+            cloudWorker.submit(cloudJob);
+        }else{
+            cloudWorker.cancel();
+            cloudJob.priors.reset();
+            changed = cloudImage.generation > 0;
+            cloudImage.generation = 0;
+        }
     }
-    compute[FLAG_CHANNEL_1] = true;
+
+    return cloudWorker.poll(cloudImage) || changed;
+}
+
+bool Data::updateHeatmap(Vector2 TrianglePoints[3], int channel, int measure){
+    int node = NODE_CHANNEL_1 + channel;
+
+    // Only channels with NUMBER_SECRETS rows are drawn over the triangle
+    bool ready = measure != HEATMAP_NONE && graph.ready(node) && this->channel[channel].rows == NUMBER_SECRETS;
+    unsigned long source = ready ? matrixVersion[channel] : 0;
+
+    bool same = source == heatmapJob.source && channel == heatmapJob.channel && measure == heatmapJob.measure;
+    for(int i = 0; i < 3 && same; i++)
+        same = TrianglePoints[i].x == heatmapJob.trianglePoints[i].x && TrianglePoints[i].y == heatmapJob.trianglePoints[i].y;
+
+    bool changed = false;
+    if(!same){
+        heatmapJob.channel = channel;
+        heatmapJob.source = source;
+        heatmapJob.measure = measure;
+        for(int i = 0; i < 3; i++)
+            heatmapJob.trianglePoints[i] = TrianglePoints[i];
+
+        // The levels of the previous job are not shown under the channel or the measure of the new one
+        if(source > 0){
+            heatmapJob.matrix = this->channel[channel];
+            heatmap.submit(heatmapJob);
+        }else{
+            heatmap.cancel();
+        }
+        changed = heatmapImage.level >= 0;
+        heatmapImage.level = -1;
+    }
+
+    return heatmap.poll(heatmapImage) || changed;
 }
@@ -2,6 +2,13 @@
 #define _data
 
 #include "graphics.h"
+#include "hypercache.h"
+#include "chull.h"
+#include "depgraph.h"
+#include "computeworker.h"
+#include "timeline.h"
+#include "priorcloud.h"
+#include "heatmap.h"
 #include <exception>
 #include <algorithm> // std::random_shuffle
 #include <ctime> // std::time
@@ -10,18 +17,18 @@
 #include <iostream>
 
 #define ANIMATION_DURATION 1 // Animation in seconds
-#define FPS 60
-#define STEPS (ANIMATION_DURATION*FPS)
-#define UPDATE_CIRCLES_BY_MOUSE -1
-
-// Indexes to be used by attributes compute and ready
-#define FLAG_PRIOR 0
-#define FLAG_CHANNEL_1 1
-#define FLAG_CHANNEL_2 2
-#define FLAG_CHANNEL_3 3
-#define FLAG_HYPER_1 4
-#define FLAG_HYPER_2 5
-#define FLAG_HYPER_3 6
+#define ANIMATION_EASING EASE_OUT_CUBIC
+
+// Nodes of the dependency graph, in topological order
+#define NODE_PRIOR 0
+#define NODE_CHANNEL_1 1
+#define NODE_CHANNEL_2 2
+#define NODE_CHANNEL_3 3		// Composition of channels 1 and 2 in MODE_REF
+#define NODE_HYPER_1 4
+#define NODE_HYPER_2 5
+#define NODE_HYPER_3 6
+#define NODE_CIRCLES 7			// Prior and inners circles
+#define NUMBER_NODES 8
 
 class Data{
 public:
@@ -34,28 +41,56 @@ public:
 	vector<long double> prior; // Prior distribution
 	Distribution fakePrior; // Used to create channel object for CHANNEL_2 in MODE_REF
 	Distribution priorObj;
-	vector<vector<vector<long double>>> channel; // Channel matrix
+	Matrix channel[NUMBER_CHANNELS]; // Channel matrices
+	Matrix previousChannel; // Copy of a channel before it is parsed again, used to know if it changed
+	unsigned long matrixVersion[NUMBER_CHANNELS]; // Changes only when the values of a channel matrix change (the version of its node also changes with the prior), 0 until it is set
+	vector<vector<long double>> channelRows[NUMBER_CHANNELS]; // Channel matrices in the layout expected by libqif
 	Channel channelObj[NUMBER_CHANNELS];
 	Hyper hyper[NUMBER_CHANNELS]; // Hyper-distributions
+	HyperCache hyperCache[NUMBER_CHANNELS]; // Column structure of each channel, used while the prior is dragged
 
-	string validCharacters;	// Used to check user input in textboxes
 	int error;		// Indicates if there is error with prior or channel
 	bool hyperReady[NUMBER_CHANNELS];  // Flag that indicates wheter a hyper distribution has been built.
 	bool mouseClickedOnPrior; // Flag that indicates wheter the mouse was clicked in the previous frame on the prior circle.
 	bool fileSaved; // Flag that indicates wheter the current prior/channel has been saved
-	int animation; // Animation control
+	double now; // Time of the current frame (seconds), it drives the animation
+	Timeline animation; // Inners moving from the prior to their positions
 	bool animationRunning;
+	bool animationPath[NUMBER_CHANNELS]; // Flags that indicate wheter the final positions of the animation were computed
 	
-	// Flag for prior, channel and hypers to indicate if in that frame the object needs to be computed
-	bool compute[8];
+	// Objects computed from the textboxes and their dependencies:
+	// prior -> channels -> composition -> hypers -> circles
+	DepGraph graph;
 
-	// Flag to indicate if the prior, channel and hypers were checked and are ready to be drawn
-	bool ready[8];
+	// The composition and the hypers are computed in the background
+	ComputeWorker worker;
+	ComputeJob job;			// Snapshot of the last job submitted
+	ComputeResult result;	// Buffer swapped with the results of the worker
+	bool computing;			// Flag that indicates wheter the status bar shows that the hypers are being built
 
 	Circle priorCircle;
-	Circle innersCircles[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS];
-	long double xJumpAnimation[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS]; 		// x axis jump per inner
-	long double yJumpAnimation[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS]; 		// y axis jump per inner
+	vector<Circle> innersCircles[NUMBER_CHANNELS];		// One per posterior, sized by buildInnerCircles
+	vector<Real> innersTargetX[NUMBER_CHANNELS];		// Final x of each inner in the animation
+	vector<Real> innersTargetY[NUMBER_CHANNELS];		// Final y of each inner in the animation
+
+	// Convex hull of the inners circles of each channel, rebuilt only when the circles move
+	vector<pt> innersHull[NUMBER_CHANNELS];			// Hull vertices (in pixels)
+	vector<int> innersHullIndex[NUMBER_CHANNELS];	// Index of the inner of each hull vertex
+	bool innersHullValid[NUMBER_CHANNELS];			// Flag that indicates wheter innersHullIndex can be reused
+	bool innersHullDirty[NUMBER_CHANNELS];			// Flag that indicates wheter innersHull must be refreshed
+	vector<int> hullScratch;						// Scratch memory used by convexHullIndices
+	unsigned long circlesVersion[NUMBER_CHANNELS];	// Changes each time the inners circles of a channel move
+
+	// Priors shown at once in the visualization, drawn with their inners in the background
+	PriorCloud cloud;
+	PriorCloudWorker cloudWorker;
+	PriorCloudJob cloudJob;		// Snapshot of the last job submitted, its priorsVersion is 0 if there is none
+	PriorCloudImage cloudImage;	// Last image taken from the worker, its generation is 0 if there is none
+
+	// Heatmap of the triangle, computed in the background
+	HeatmapWorker heatmap;
+	HeatmapJob heatmapJob;		// Snapshot of the last job submitted, its source is 0 if there is none
+	HeatmapImage heatmapImage;	// Last level taken from the worker, its level is -1 if there is none
 
 	//------------------------------------------------------------------------------------
     // Methods
@@ -67,18 +102,33 @@ public:
 	int checkPriorText(char prior_[NUMBER_SECRETS][CHAR_BUFFER_SIZE]);
 
 	/* Check if the numbers or fractions were typed correctly in the channel.
-	 * If so, conver text to long double values and add them to this->channel.
+	 * If so, conver text to Real values and add them to this->channel.
 	 * Returns NO_ERROR or INVALID_VALUE */
-	int checkChannelText(char channel_[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE], int channel, int numSecrets, int numOutputs);
+	int checkChannelText(TextGrid &channel_, int channel, int numSecrets, int numOutputs);
+
+	/* Check if channel[channel] is a valid channel matrix and, if so, build channelObj[channel] with a given prior.
+	 * The memory of channelRows is reused, so it does not allocate while the size of the channel does not change.
+	 * Returns NO_ERROR or INVALID_CHANNEL_1+channel */
+	int buildChannel(int channel, Distribution &prior);
 
 	/* Calculate circle points and radius for prior. */
 	void buildPriorCircle(Vector2 TrianglePoints[3]);
 	
+	/* Start the animation of the inners at time 'now'. The circles are placed by buildInnerCircles. */
+	void startAnimation(double now);
+
 	/* Calculate circle points and radius for inners of a given channel.
+	   While the animation runs, the inners are placed between the prior and their final
+	   positions according to the time of the frame (this->now).
 	   It asssumes the hyper distribution has been already built and
 	   that buildPriorCircle has been already called. */
 	void buildInnerCircles(Vector2 TrianglePoints[3], int channel, int mode);
 
+	/* Refresh the convex hull of the inners circles of a given channel if they have moved since the last call.
+	   If the hull indices are still valid (the circles moved linearly from the prior) only the vertices
+	   positions are updated. */
+	void updateInnersHull(int channel);
+
 	/* Given three points, returns 0 if the orientation is colinear, 1 if it is
 	 * clock wise or 2 if it is counterclock wise. */
 	int orientation(Point p1, Point p2, Point p3);
@@ -92,12 +142,14 @@ public:
 
 	/* Update the hyper distribution if the user moves the prior distribution
      * This function assumes that the hyper distribution has already been built. 
+	 * It does not allocate memory while the channels do not change.
 	 *
 	 * @Parameters:
 	 *		TrianglePoints: From Layout object.
 	 *
+	 * Returns true if the prior has moved since the last call or false otherwise.
      */
-	void updateHyper(Vector2 TrianglePoints[3], int mode);
+	bool updateHyper(Vector2 TrianglePoints[3], int mode);
 
 	/* Generates a new random prior and keeps it in attribute 'prior'. */
 	void newRandomPrior();
@@ -109,8 +161,22 @@ public:
 	*/
 	void newRandomChannel(int curChannel, int numSecrets, int numOutputs);
 
-	/* Set ready and compute off all channels and hypers to false except compute channel 1. */
-	void resetAllExceptComputeChannel1();
+	/* Enable the nodes of the graph used in a mode. Nodes that are enabled again are recomputed. */
+	void setMode(int mode);
+
+	/* Submit a density image of the prior cloud (if 'shown') with the inners of the channels drawn in a mode
+	 * whose nodes are ready, if the priors, the channels or the versions of their matrices changed since the last call,
+	 * and take the image when the worker finishes it. PRIOR_CLOUD_SIZE priors are sampled if the cloud
+	 * is empty. Returns true if cloudImage changed. */
+	bool updatePriorCloud(Vector2 TrianglePoints[3], int mode, bool shown);
+
+	/* Submit a heatmap of a measure (HEATMAP_NONE to hide it) over the triangle for a channel, if the
+	 * channel, the version of its matrix or the measure changed since the last call, and take the levels
+	 * finished by the worker. The measure does not depend on the prior, so editing it does not submit
+	 * anything. The image of the previous job is dropped when a job is submitted, so it is never shown
+	 * with the label of the new one. Nothing is submitted while the node of the channel is not ready.
+	 * Returns true if heatmapImage changed. */
+	bool updateHeatmap(Vector2 TrianglePoints[3], int channel, int measure);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "depgraph.h"
+#include <cstdio>
+
+DepGraph::DepGraph(){
+
+}
+
+void DepGraph::addNode(int node, const char *name, initializer_list<int> inputs){
+    if((int)nodes.size() <= node)
+        nodes.resize(node + 1);
+
+    Node &n = nodes[node];
+    n.name = name;
+    n.inputs.assign(inputs.begin(), inputs.end());
+    n.seen.assign(n.inputs.size(), 0);
+    n.version = 0;
+    n.stale = true;
+    n.valid = false;
+    n.enabled = true;
+    n.pending = false;
+    n.error = 0;
+    n.recomputations = 0;
+}
+
+void DepGraph::touch(int node){
+    nodes[node].stale = true;
+}
+
+void DepGraph::modified(int node){
+    nodes[node].version++;
+}
+
+void DepGraph::setEnabled(int node, bool enabled){
+    Node &n = nodes[node];
+    if(n.enabled == enabled)
+        return;
+
+    n.enabled = enabled;
+    n.stale = true;
+    n.version++;
+    if(!enabled){
+        n.valid = false;
+        n.pending = false;
+        n.error = 0;
+    }
+}
+
+bool DepGraph::needsUpdate(int node){
+    Node &n = nodes[node];
+    return n.enabled && (n.stale || inputsChanged(node));
+}
+
+bool DepGraph::inputsChanged(int node){
+    Node &n = nodes[node];
+    for(unsigned long i = 0; i < n.inputs.size(); i++)
+        if(nodes[n.inputs[i]].version != n.seen[i])
+            return true;
+    return false;
+}
+
+bool DepGraph::inputsReady(int node){
+    Node &n = nodes[node];
+    for(unsigned long i = 0; i < n.inputs.size(); i++){
+        Node &input = nodes[n.inputs[i]];
+        if(input.enabled && !input.valid)
+            return false;
+    }
+    return true;
+}
+
+void DepGraph::record(int node, bool changed){
+    Node &n = nodes[node];
+    for(unsigned long i = 0; i < n.inputs.size(); i++)
+        n.seen[i] = nodes[n.inputs[i]].version;
+    n.stale = false;
+    n.pending = false;
+    if(changed)
+        n.version++;
+}
+
+void DepGraph::update(int node, int error, bool changed){
+    Node &n = nodes[node];
+    changed = changed || !n.valid || error != 0;
+    n.valid = error == 0;
+    n.error = error;
+    n.recomputations++;
+    record(node, changed);
+}
+
+void DepGraph::begin(int node){
+    Node &n = nodes[node];
+    bool changed = n.valid;
+    n.valid = false;
+    n.error = 0;
+    record(node, changed);
+    n.pending = true;
+}
+
+void DepGraph::finish(int node, int error){
+    Node &n = nodes[node];
+    n.valid = error == 0;
+    n.error = error;
+    n.pending = false;
+    n.recomputations++;
+    n.version++;
+}
+
+bool DepGraph::pending(int node){
+    return nodes[node].enabled && nodes[node].pending;
+}
+
+bool DepGraph::computing(){
+    for(unsigned long i = 0; i < nodes.size(); i++)
+        if(pending(i))
+            return true;
+    return false;
+}
+
+void DepGraph::invalidate(int node){
+    Node &n = nodes[node];
+    bool changed = n.valid || n.stale;
+    n.valid = false;
+    n.error = 0;
+
+    // Nodes downstream are already invalid if this node was invalid, so they do not have to be visited again
+    record(node, changed);
+}
+
+void DepGraph::markComputed(int node){
+    Node &n = nodes[node];
+    n.valid = true;
+    n.error = 0;
+    record(node, true);
+}
+
+bool DepGraph::ready(int node){
+    Node &n = nodes[node];
+    return n.enabled && n.valid && !needsUpdate(node);
+}
+
+unsigned long DepGraph::version(int node){
+    return nodes[node].version;
+}
+
+int DepGraph::firstError(){
+    for(unsigned long i = 0; i < nodes.size(); i++)
+        if(nodes[i].enabled && nodes[i].error != 0)
+            return nodes[i].error;
+    return 0;
+}
+
+string DepGraph::report(){
+    string out;
+    char buffer[128];
+    for(unsigned long i = 0; i < nodes.size(); i++){
+        snprintf(buffer, sizeof(buffer), "%-12s %ld recomputations\n", nodes[i].name, nodes[i].recomputations);
+        out += buffer;
+    }
+    return out;
+}
@@ -0,0 +1,115 @@
+#ifndef _depgraph
+#define _depgraph
+
+#include <vector>
+#include <string>
+#include <initializer_list>
+
+using namespace std;
+
+/* Dependency graph of the objects computed from the textboxes.
+ *
+ * Every node has a version that changes each time its value changes, and it
+ * remembers the versions of its inputs used the last time it was computed.
+ * A node needs to be updated if it was touched (its own source, i.e. a textbox,
+ * changed) or if the version of any input changed since then. Dirtiness is
+ * therefore propagated lazily: updating the nodes in topological order once per
+ * frame recomputes only the nodes downstream of what actually changed.
+ *
+ * The graph does not know how to compute a node. The caller checks needsUpdate(),
+ * computes the value and records the result with update(). Nodes computed in the
+ * background are marked with begin() when their inputs are sent and recorded with
+ * finish() when the result arrives; they are pending, and not ready, in between.
+ */
+class DepGraph{
+public:
+	DepGraph();
+
+	typedef struct Node{
+		const char *name;
+		vector<int> inputs;
+		vector<unsigned long> seen;	// Versions of the inputs used in the last update
+		unsigned long version;
+		bool stale;					// Flag that indicates wheter the node was touched
+		bool valid;					// Flag that indicates wheter the last update succeeded
+		bool enabled;				// Disabled nodes are never ready (i.e. channels not used in the mode)
+		bool pending;				// Flag that indicates wheter the node is being computed in the background
+		int error;					// Error code of the last update
+		long recomputations;		// Number of times the node was computed
+	} Node;
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	vector<Node> nodes;
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Add a node. Inputs must have been added before, so the ids are a topological order. */
+	void addNode(int node, const char *name, initializer_list<int> inputs);
+
+	/* The source of a node changed, so it must be recomputed. */
+	void touch(int node);
+
+	/* The value of a node was changed in place (i.e. while the prior is dragged).
+	 * It stays up to date and the nodes downstream need to be updated. */
+	void modified(int node);
+
+	/* Enable or disable a node. A node that is enabled again is recomputed. */
+	void setEnabled(int node, bool enabled);
+
+	/* Returns true if the node is enabled and was touched or any input changed since the last update. */
+	bool needsUpdate(int node);
+
+	/* Returns true if every enabled input is ready. */
+	bool inputsReady(int node);
+
+	/* Returns true if the version of any input changed since the last update. */
+	bool inputsChanged(int node);
+
+	/* Record the result of computing a node: it is valid if error is NO_ERROR (0).
+	 * If 'changed' is false and the node was and still is valid, its version is kept,
+	 * so retyping the same value in a textbox does not recompute anything downstream. */
+	void update(int node, int error, bool changed = true);
+
+	/* The inputs of a node were sent to be computed in the background. The node is not ready until
+	 * finish() is called, but it does not need to be updated again unless its inputs change. */
+	void begin(int node);
+
+	/* Record the result of a node computed in the background. The inputs versions are the ones
+	 * seen by begin(), so the node is updated again if they changed in the meantime. */
+	void finish(int node, int error);
+
+	/* Returns true if the node is waiting for a result of the background computation. */
+	bool pending(int node);
+
+	/* Returns true if any enabled node is pending. */
+	bool computing();
+
+	/* Record that a node can not be computed because an input is not ready. */
+	void invalidate(int node);
+
+	/* Record a value that was set without computing it (i.e. restored from a session). */
+	void markComputed(int node);
+
+	/* Returns true if the node is enabled, valid and up to date. */
+	bool ready(int node);
+
+	/* Version of the value of a node. It is 0 until the node is computed for the first time,
+	 * so a ready node never has version 0. */
+	unsigned long version(int node);
+
+	/* Error of the first enabled node, in topological order, whose last update failed. */
+	int firstError();
+
+	/* Number of recomputations of each node, one line per node. */
+	string report();
+
+private:
+	void record(int node, bool changed);
+};
+
+#endif
@@ -0,0 +1,113 @@
+#include "framescheduler.h"
+#include "../libs/raylib/src/rlgl.h"
+#include <cstdio>
+
+FrameScheduler::FrameScheduler(){
+    rendered = 0;
+    skipped = 0;
+    loaded = false;
+    valid = false;
+    linger = FRAME_LINGER;
+    fps = FRAME_ACTIVE_FPS;
+    lastMouse = (Vector2){-1, -1};
+}
+
+void FrameScheduler::load(int width, int height){
+#if !defined(PLATFORM_WEB)
+    frame = LoadRenderTexture(width, height);
+    loaded = true;
+#endif
+    valid = false;
+}
+
+void FrameScheduler::unload(){
+    if(loaded) UnloadRenderTexture(frame);
+    loaded = false;
+    valid = false;
+}
+
+bool FrameScheduler::input(){
+    bool any = false;
+
+    Vector2 mouse = GetMousePosition();
+    if(mouse.x != lastMouse.x || mouse.y != lastMouse.y) any = true;
+    lastMouse = mouse;
+
+    if(GetMouseWheelMove() != 0) any = true;
+
+    for(int button = MOUSE_LEFT_BUTTON; button <= MOUSE_MIDDLE_BUTTON && !any; button++)
+        if(IsMouseButtonDown(button) || IsMouseButtonReleased(button)) any = true;
+
+    // Typed characters always come with a key pressed, and GetCharPressed can not be used here because it takes them from the queue
+    for(int key = KEY_SPACE; key <= KEY_KB_MENU && !any; key++)
+        if(IsKeyDown(key) || IsKeyReleased(key)) any = true;
+
+    return any;
+}
+
+bool FrameScheduler::beginFrame(bool busy){
+    if(input() || busy)
+        linger = FRAME_LINGER;
+
+    bool render = linger > 0 || !valid;
+    if(render){
+        if(linger > 0) linger--;
+        rendered++;
+    }else{
+        skipped++;
+    }
+
+#if !defined(PLATFORM_WEB)
+    int target = render ? FRAME_ACTIVE_FPS : FRAME_IDLE_FPS;
+    if(target != fps){
+        fps = target;
+        SetTargetFPS(fps);
+    }
+#endif
+
+    return render;
+}
+
+void FrameScheduler::beginDrawing(){
+    if(loaded) BeginTextureMode(frame);
+    else BeginDrawing();
+}
+
+void FrameScheduler::endDrawing(){
+    valid = true;
+    if(!loaded){
+        EndDrawing();
+        return;
+    }
+
+    EndTextureMode();
+    BeginDrawing();
+        drawFrame();
+    EndDrawing();
+}
+
+void FrameScheduler::present(){
+    if(!loaded)
+        return;
+
+    BeginDrawing();
+        drawFrame();
+    EndDrawing();
+}
+
+void FrameScheduler::drawFrame(){
+    // The frame is copied as it is: its alpha comes from the translucent shapes blended into it
+    rlDrawRenderBatchActive();
+    rlDisableColorBlend();
+        // Render textures are upside down
+        DrawTextureRec(frame.texture, (Rectangle){0, 0, (float)frame.texture.width, (float)-frame.texture.height}, (Vector2){0, 0}, WHITE);
+        rlDrawRenderBatchActive();
+    rlEnableColorBlend();
+}
+
+string FrameScheduler::report(){
+    char buffer[128];
+    long total = rendered + skipped;
+    snprintf(buffer, sizeof(buffer), "%ld frames rendered, %ld skipped (%.1f%%)", rendered, skipped, total > 0 ? 100.0*skipped/total : 0.0);
+    return buffer;
+}
@@ -0,0 +1,73 @@
+#ifndef _framescheduler
+#define _framescheduler
+
+#include "../libs/raylib/src/raylib.h"
+#include <string>
+
+using namespace std;
+
+#define FRAME_ACTIVE_FPS 60		// Frames per second while something changes
+#define FRAME_IDLE_FPS 20		// Frames per second while nothing changes, only to check the input (desktop)
+#define FRAME_LINGER 10			// Frames rendered after the last event, so the interface can settle
+
+/* Decides whether a frame must be rendered.
+ *
+ * raygui is an immediate mode interface, so a frame in which nothing happens draws the
+ * same image as the previous one. A frame is rendered if there is input (mouse moved,
+ * a button or key is down or released, wheel moved) or the caller is busy (an animation
+ * is running or a result of the background computation has to be taken), and for
+ * FRAME_LINGER frames after that, because some controls act in the frame after the event.
+ *
+ * On desktop the rendered frame is drawn into a texture. Skipped frames only copy it to
+ * the screen, which also polls the input events, and run at FRAME_IDLE_FPS, so the
+ * process sleeps most of the time. On the web the browser keeps the canvas, so skipped
+ * frames return without drawing anything. */
+class FrameScheduler{
+public:
+	FrameScheduler();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	long rendered;	// Number of frames rendered
+	long skipped;	// Number of frames skipped because nothing changed
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Create the texture that keeps the last frame. It must be called after InitWindow. */
+	void load(int width, int height);
+	void unload();
+
+	/* Returns true if the frame must be updated and rendered.
+	 * 'busy' is true if something not driven by the input changes in this frame. */
+	bool beginFrame(bool busy);
+
+	/* Replace BeginDrawing and EndDrawing in a rendered frame. */
+	void beginDrawing();
+	void endDrawing();
+
+	/* Show the last rendered frame again. It is called in a skipped frame. */
+	void present();
+
+	/* Rendered and skipped frames. */
+	string report();
+
+private:
+	RenderTexture2D frame;	// Last rendered frame (desktop)
+	bool loaded;
+	bool valid;				// Flag that indicates wheter 'frame' holds a rendered frame
+	int linger;				// Frames that are still rendered after the last event
+	int fps;				// Current target FPS
+	Vector2 lastMouse;
+
+	/* Returns true if there is any input in this frame. */
+	bool input();
+
+	/* Draw 'frame' on the screen, replacing what is there. */
+	void drawFrame();
+};
+
+#endif
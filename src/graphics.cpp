@@ -1,15 +1,5 @@
 #include "graphics.h"
 
-Point::Point(){
-	this->x = 0.0f;
-	this->y = 0.0f;
-}
-
-Point::Point(long double x, long double y){
-	this->x = x;
-	this->y = y;
-}
-
 Point dist2Bary(Distribution &prior){
 	Point p;
 	p.x = prior.prob[2] + prior.prob[0]/2.0f;
@@ -17,37 +7,50 @@ Point dist2Bary(Distribution &prior){
 	return p;
 }
 
-Point dist2Bary(long double x1, long double x2, long double x3){
-	Point p;
-	p.x = x3 + x1/2.0f;
+template<typename T>
+PointT<T> dist2Bary(T x1, T x2, T x3){
+	PointT<T> p;
+	p.x = x3 + x1/2;
 	p.y = x1;
 	return p;
 }
 
-bool bary2Dist(Point p, vector<long double> &prob){
-	vector<long double> prob_aux(3);
+template<typename T>
+bool bary2Dist(PointT<T> p, T prob[3]){
+	T prob_aux[3];
 	prob_aux[0] = p.y;
-	prob_aux[1] = 1 - p.x - p.y/2.0f;
-	prob_aux[2] = p.x - p.y/2.0f;
+	prob_aux[1] = 1 - p.x - p.y/2;
+	prob_aux[2] = p.x - p.y/2;
 
 	// Fix bug of approximation in function Information::adjustPrior()
-	for(int i = 0; i < 3; i++) if(-1e-6 <= prob_aux[i] && prob_aux[i] <= 1e-6) prob_aux[i] = 0.0f;
+	for(int i = 0; i < 3; i++) if(-1e-6 <= prob_aux[i] && prob_aux[i] <= 1e-6) prob_aux[i] = 0;
 
-	if(Distribution::isDistribution(prob_aux)){
-		prob[0] = prob_aux[0];
-		prob[1] = prob_aux[1];
-		prob[2] = prob_aux[2];
-		return true;
-	}
+	// The three values always sum to 1, so it is a distribution if none of them is negative
+	for(int i = 0; i < 3; i++) if(prob_aux[i] < 0) return false;
 
-	return false;
+	prob[0] = prob_aux[0];
+	prob[1] = prob_aux[1];
+	prob[2] = prob_aux[2];
+	return true;
+}
+
+bool bary2Dist(Point p, vector<long double> &prob){
+	// It runs on every frame the prior is dragged, so it does not allocate
+	Real prob_aux[3];
+	if(!bary2Dist(p, prob_aux))
+		return false;
+
+	prob[0] = prob_aux[0];
+	prob[1] = prob_aux[1];
+	prob[2] = prob_aux[2];
+	return true;
 }
 
-long double euclidianDistance(Point a, Point b){
+Real euclidianDistance(Point a, Point b){
 	return sqrt((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
 }
 
-long double euclidianDistance(Point a, Vector2 b){
+Real euclidianDistance(Point a, Vector2 b){
 	return sqrt((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
 }
 
@@ -75,54 +78,151 @@ Point bary2Pixel(double x, double y, Vector2 TrianglePoints[3]){
 	return p;
 }
 
-vector<string> getStrTruncatedDist(Distribution dist, int precision){
-	int sum = 0;
-	vector<int> newDist(dist.num_el);
-	vector<string> newStrDist(dist.num_el);
+// Units of 10^-precision in a probability, truncated. 'remainder' receives the rest as a fraction of a unit in 32 bits.
+static inline unsigned long long probUnits(long double p, unsigned long long scale, unsigned long long &remainder){
+	remainder = 0;
+	if(!(p > 0)) return 0;	// Also NaN
+	if(p >= 1) return scale;
 
-	if(dist.num_el == 0)
-		return newStrDist;
+	long double scaled = p * scale;
+	unsigned long long units = (unsigned long long) scaled;
+	remainder = (unsigned long long) ((scaled - units) * 4294967296.0L);
+	return units;
+}
 
-	istringstream probs = istringstream(dist.toString(precision));
-	string prob;
-	int i = 0;
-	while(probs >> prob){
-		newDist[i] = prob != "1.000" ? stoi(prob.substr(2)) : 1000;
-		sum += newDist[i];
-		newStrDist[i] = prob;
-		i++;
-	}
-	
-	// Fix the probability distribution truncation increasing or decreasing the value of the last element
-	newDist[dist.num_el-1] += (1000 - sum);
-	if(newDist[dist.num_el-1] < 10){
-		newStrDist[dist.num_el-1] = "0.00" + to_string(newDist[dist.num_el-1]);
-	}else if(newDist[dist.num_el-1] < 100){
-		newStrDist[dist.num_el-1] = "0.0" + to_string(newDist[dist.num_el-1]);
-	}else if(newDist[dist.num_el-1] < 1000){
-		newStrDist[dist.num_el-1] = "0." + to_string(newDist[dist.num_el-1]);
-	}else{
-		newStrDist[dist.num_el-1] = "1.000";
+// Write 'units' of 1/scale as a decimal number with 'precision' digits after the point
+static void writeUnits(char *out, unsigned long long units, unsigned long long scale, int precision){
+	unsigned long long whole = units / scale, fraction = units % scale;
+	char digits[24];
+	int d = 0;
+	do{
+		digits[d++] = '0' + whole % 10;
+		whole /= 10;
+	}while(whole > 0);
+	while(d > 0)
+		*out++ = digits[--d];
+
+	if(precision > 0){
+		*out++ = '.';
+		for(int k = precision - 1; k >= 0; k--){
+			out[k] = '0' + fraction % 10;
+			fraction /= 10;
+		}
+		out += precision;
 	}
-	return newStrDist;
+	*out = '\0';
 }
 
-Channel composeChannels(Channel &C, Channel &R){
-	// Verify if channels are compatible
-	if(C.num_out != R.prior.num_el){
-		printf("Channels are not compatible to be composed!");
-		exit(0);
-	}
+template<typename T>
+void formatDistribution(const T *prob, int n, int stride, int precision, char *text, long textStride){
+	precision = max(0, min(PROB_MAX_PRECISION, precision));
+	unsigned long long scale = 1;
+	for(int k = 0; k < precision; k++)
+		scale *= 10;
+
+	unsigned long long remainder, sum = 0;
+	for(int k = 0; k < n; k++)
+		sum += probUnits(prob[(long)k*stride], scale, remainder);
+	long long missing = (long long)scale - (long long)sum;
+
+	/* The 'missing' largest remainders are those above 'threshold', plus the first 'ties' equal to it.
+	   The threshold is selected one byte at a time, from the highest, with a histogram of the values
+	   whose higher bytes match the bytes already selected. Remainders are computed again in each
+	   pass, so the only memory used is the histogram. */
+	unsigned long long threshold = 0;
+	long long ties = 0;
+	bool largestRemainder = missing > 0 && missing <= n;
+	if(largestRemainder){
+		long long need = missing;
+		int histogram[256];
+		for(int shift = 24; shift >= 0; shift -= 8){
+			for(int b = 0; b < 256; b++)
+				histogram[b] = 0;
+			for(int k = 0; k < n; k++){
+				probUnits(prob[(long)k*stride], scale, remainder);
+				if((remainder >> (shift + 8)) == threshold)
+					histogram[(remainder >> shift) & 255]++;
+			}
 
-	vector<vector<long double>> matrix = vector<vector<long double>>(C.prior.num_el, vector<long double>(R.num_out, 0));
-	for(int i = 0; i < C.prior.num_el; i++){
-		for(int j = 0; j < R.num_out; j++){
-			for(int k = 0; k < C.num_out; k++){
-				matrix[i][j] += (C.matrix[i][k] * R.matrix[k][j]);
+			int b = 255;
+			while(histogram[b] < need){
+				need -= histogram[b];
+				b--;
 			}
+			threshold = (threshold << 8) | b;
+		}
+		ties = need;
+	}
+
+	for(int k = 0; k < n; k++){
+		long long units = probUnits(prob[(long)k*stride], scale, remainder);
+		if(largestRemainder && (remainder > threshold || (remainder == threshold && ties-- > 0)))
+			units++;
+		else if(!largestRemainder && k == n-1)
+			units = max(0LL, min((long long)scale, units + missing));
+
+		writeUnits(text + k*textStride, units, scale, precision);
+	}
+}
+
+bool text2Value(const char *begin, const char *end, long double &value){
+	return parseNumber(begin, end, value);
+}
+
+bool text2Value(const char *text, long double &value){
+	return parseNumber(text, value);
+}
+
+bool text2Value(const string &text, long double &value){
+	return parseNumber(text.data(), text.data() + text.size(), value);
+}
+
+bool text2Matrix(const TextGrid &text, int numRows, int numCols, Matrix &matrix){
+	long double value;
+	matrix.resize(numRows, numCols);
+	for(int i = 0; i < numRows; i++){
+		Real *row = matrix.row(i);
+		for(int j = 0; j < numCols; j++){
+			if(!text2Value(text[i][j], value))
+				return false;
+			row[j] = value;
 		}
 	}
-	Channel CR = Channel(C.prior, matrix);
+	return true;
+}
+
+template<typename T>
+int composeChannels(const FlatMatrix<T> &C, const FlatMatrix<T> &R, FlatMatrix<T> &CR, bool reference){
+	// Verify if channels are compatible
+	if(C.cols != R.rows || C.rows == 0 || R.cols == 0)
+		return INVALID_COMPOSITION;
+
+	int n = C.rows, m = C.cols, p = R.cols;
+	CR.resize(n, p);
+
+	if(reference){
+		FlatMatrix<long double> a(n, m), b(m, p), out(n, p);
+		for(int k = 0; k < n*m; k++) a.values[k] = C.values[k];
+		for(int k = 0; k < m*p; k++) b.values[k] = R.values[k];
+		composeKernelReference(a.data(), b.data(), out.data(), n, m, p);
+		for(int k = 0; k < n*p; k++) CR.values[k] = out.values[k];
+	}else{
+		composeKernel(C.data(), R.data(), CR.data(), n, m, p);
+	}
+
+	return NO_ERROR;
+}
 
-	return CR;
-}
\ No newline at end of file
+// Instantiations for every precision accepted by QIF_PRECISION
+template PointT<float> dist2Bary(float x1, float x2, float x3);
+template PointT<double> dist2Bary(double x1, double x2, double x3);
+template PointT<long double> dist2Bary(long double x1, long double x2, long double x3);
+template bool bary2Dist(PointT<float> p, float prob[3]);
+template bool bary2Dist(PointT<double> p, double prob[3]);
+template bool bary2Dist(PointT<long double> p, long double prob[3]);
+template int composeChannels(const FlatMatrix<float> &C, const FlatMatrix<float> &R, FlatMatrix<float> &CR, bool reference);
+template int composeChannels(const FlatMatrix<double> &C, const FlatMatrix<double> &R, FlatMatrix<double> &CR, bool reference);
+template int composeChannels(const FlatMatrix<long double> &C, const FlatMatrix<long double> &R, FlatMatrix<long double> &CR, bool reference);
+template void formatDistribution(const float *prob, int n, int stride, int precision, char *text, long textStride);
+template void formatDistribution(const double *prob, int n, int stride, int precision, char *text, long textStride);
+template void formatDistribution(const long double *prob, int n, int stride, int precision, char *text, long textStride);
@@ -3,7 +3,14 @@
 
 #include "../libs/qif/qif.h"
 #include "../libs/raylib/src/raylib.h"
+#include "precision.h"
+#include "compose.h"
+#include "matrix.h"
+#include "numparse.h"
+#include "grid.h"
 #include <string>
+#include <cstdlib>
+#include <cctype>
 
 using namespace std;
 
@@ -19,15 +26,19 @@ using namespace std;
 #define INVALID_VALUE_CHANNEL_2 8 // i.e. "1/$2"
 #define INVALID_VALUE_CHANNEL_3 9 // i.e. "1/$2"
 #define INVALID_QIF_FILE 10
+#define INVALID_COMPOSITION 11 // Number of outputs of C differs from number of inputs of R
+#define STATUS_COMPUTING 12 // Not an error, the hypers are being built in the background
+#define INVALID_PRIOR_CLOUD_FILE 13
 
 // Settings ------------------------------------------------------------------------------------
 #define WINDOWS_WIDTH 750
 #define WINDOWS_HEIGHT 630
 #define TEXTBOX_SIZE 50
 #define PROB_PRECISION 3 // Precision of float numbers (# digits after .)
+#define PROB_MAX_PRECISION 15 // Largest precision accepted by formatDistribution, 10^15 units fit in the mantissa of a double
 #define CHAR_BUFFER_SIZE 128
 #define NUMBER_SECRETS 3
-#define MAX_CHANNEL_OUTPUTS 50
+#define MAX_CHANNEL_OUTPUTS 4096 // Largest number of outputs (and of rows of channel R). Storage grows with the actual channels.
 
 #define NUMBER_CHANNELS 3
 #define CHANNEL_1 0
@@ -73,20 +84,56 @@ using namespace std;
 // Prior probability distribution radius (in pixels) ----------------------------------------------/
 #define PRIOR_RADIUS 40
 
-class Point{
+template<typename T>
+class PointT{
 	public:
-		long double x;
-		long double y;
+		T x;
+		T y;
 
-		Point();
-		Point(long double x, long double y);
+		PointT() : x(0), y(0) {}
+		PointT(T x, T y) : x(x), y(y) {}
+
+		// Conversion between precisions
+		template<typename U>
+		PointT(const PointT<U> &p) : x(p.x), y(p.y) {}
 };
 
+typedef PointT<Real> Point;
+
 typedef struct Circle{
 	Point center; // Pixel coordinates
 	float radius;
 }Circle;
 
+// Text of a textbox. It converts to char*, so it is given to strcpy, sprintf or GuiTextBox as a char array.
+typedef struct TextCell{
+	char text[CHAR_BUFFER_SIZE];
+
+	operator char*() { return text; }
+	operator const char*() const { return text; }
+}TextCell;
+
+typedef Grid<TextCell> TextGrid;
+
+static const TextCell TEXT_ZERO = {"0"};
+
+/* Key of the values some textboxes were last written from: a source (i.e. a channel),
+ * the version of its values and the precision of the text. Formatting is skipped
+ * while the key does not change. */
+typedef struct TextCache{
+	int source;				// -1 if the text was not written from any source
+	unsigned long version;
+	int precision;
+
+	bool current(int source, unsigned long version, int precision) const {
+		return this->source == source && this->version == version && this->precision == precision;
+	}
+	void store(int source, unsigned long version, int precision) {
+		this->source = source; this->version = version; this->precision = precision;
+	}
+	void invalidate() { source = -1; }
+}TextCache;
+
 /* Transforms a probability distribution on 3 elements in a barycentric coordinate
  * Parameters:
  * 		prior: Probability distribution
@@ -103,20 +150,25 @@ Point dist2Bary(Distribution &prior);
  *
  * Return: A 'Point' structure containing a barycentric coordinate.
  */
-Point dist2Bary(long double x1, long double x2, long double x3);
+template<typename T>
+PointT<T> dist2Bary(T x1, T x2, T x3);
 
 /* Transforms a barycentric coordiante in a probability distribution on 3 elements.
  * Parameters:
  *		p: 	  Point containing a barycentric coordinate
- *		prob: A vector which will receive the new probability distribution
+ *		prob: An array which will receive the new probability distribution
  *
  * Return: true if a probability distribution was succesfully generated or false otherwise.
  */
+template<typename T>
+bool bary2Dist(PointT<T> p, T prob[3]);
+
+// Same as above, for the long double vector of a Distribution
 bool bary2Dist(Point p, vector<long double> &prob);
 
 // Euclidian distance between two points
-long double euclidianDistance(Point a, Point b);
-long double euclidianDistance(Point a, Vector2 b);
+Real euclidianDistance(Point a, Point b);
+Real euclidianDistance(Point a, Vector2 b);
 
 /* Transforms a pixel coordinate in barycentric coordinate
  * Parameters:
@@ -138,19 +190,52 @@ Point pixel2Bary(double x, double y, Vector2 TrianglePoints[3]);
  */
 Point bary2Pixel(double x, double y, Vector2 TrianglePoints[3]);
 
-/* Truncate a probability distribution to a given precision.
-   The truncation can increase or decrease the probability of the last element.
-   Returns a vector of strings containing the probability distribution.
+/* Write a probability distribution as text with 'precision' digits after the point (i.e. "0.250").
+ * Values are rounded to units of 10^-precision by the largest remainder method: each value is
+ * truncated and the units missing to reach 1 are given to the values with the largest remainders
+ * (the first ones if they tie), so the texts always add up to exactly 1 and no value changes by
+ * a whole unit. If the values are far from adding up to 1, the difference goes to the last one.
+ * It does not allocate.
+ * Parameters:
+ *		prob: The n values of the distribution, 'stride' elements apart
+ *		n: Number of values
+ *		stride: Distance (in elements) between two consecutive values
+ *		precision: Digits after the point, from 0 to PROB_MAX_PRECISION
+ *		text: Receives the n texts, each one in a buffer of CHAR_BUFFER_SIZE characters
+ *		textStride: Distance (in bytes) between two consecutive buffers
+ */
+template<typename T>
+void formatDistribution(const T *prob, int n, int stride, int precision, char *text, long textStride);
+
+/* Convert the text of a textbox, a number (i.e. "0.25") or a fraction (i.e. "1/4"), to a value.
+ * The text is given by the range [begin, end), a null-terminated buffer or a string.
+ * The grammar is described in numparse.h. It does not allocate or throw.
+ * Returns: true if the text is valid or false otherwise ('value' is not changed).
+ */
+bool text2Value(const char *begin, const char *end, long double &value);
+bool text2Value(const char *text, long double &value);
+bool text2Value(const string &text, long double &value);
+
+/* Convert the texts of the textboxes of a channel to its matrix, with text2Value.
+ * Parameters:
+ *		text: numRows x numCols texts
+ *		matrix: Receives the values. Its memory is reused.
+ * Returns: true if all texts are valid or false otherwise (the matrix is left partially filled).
  */
-vector<string> getStrTruncatedDist(Distribution dist, int precision);
+bool text2Matrix(const TextGrid &text, int numRows, int numCols, Matrix &matrix);
 
-/* Given two channels C and R, multiply their matrices and create the channel CR. 
+/* Given the matrices of two channels C and R, multiply them into CR.
+ * The product is computed by composeKernel in the precision of the matrices, or by
+ * composeKernelReference in long double if 'reference' is true.
  * Parameters:
- * 		C: Channel 1
- * 		R: Channel 2
+ * 		C: Matrix of channel 1
+ * 		R: Matrix of channel 2
+ * 		CR: Receives the composition of channels C and R. Its memory is reused.
+ * 		reference: Use the long double reference path
  * 	
- * Returns: CR, the composition of channels C and R.
+ * Returns: NO_ERROR or INVALID_COMPOSITION if the channels are not compatible (CR is not changed).
 */
-Channel composeChannels(Channel &C, Channel &R);
+template<typename T>
+int composeChannels(const FlatMatrix<T> &C, const FlatMatrix<T> &R, FlatMatrix<T> &CR, bool reference = false);
 
 #endif
\ No newline at end of file
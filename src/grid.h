@@ -0,0 +1,85 @@
+#ifndef _grid
+#define _grid
+
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/* Matrix of cells (textboxes text, edit modes, rectangles) sized with the channels
+ * at runtime instead of with the largest channel allowed.
+ *
+ * Cells are stored row-major with a row stride equal to the allocated columns, so
+ * grid[i][j] works as with the fixed arrays it replaces. reserve() keeps the content
+ * of the cells that are still in use and allocates nothing while the requested size
+ * fits in the storage and uses at least half of it, so resizing a channel back and
+ * forth by a few cells does not allocate, while the storage follows the shape of the
+ * channel (a grid used for 3 x m and then for m x 3 does not keep m x m cells). */
+template<typename T>
+class Grid{
+public:
+	Grid() : rows(0), cols(0) {}
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	int rows;	// Allocated rows, they can be more than the rows in use
+	int cols;	// Allocated columns, they can be more than the columns in use
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	T* operator[](int i) { return cells.get() + (long)i*cols; }
+	const T* operator[](int i) const { return cells.get() + (long)i*cols; }
+
+	/* Make room for at least numRows x numCols cells. New cells are set to 'value'.
+	 * If the storage is reallocated it holds exactly numRows x numCols cells, and the cells out of them are dropped.
+	 * Returns true if the storage was reallocated (cells are moved, so pointers to them are not valid anymore). */
+	bool reserve(int numRows, int numCols, const T &value){
+		long used = (long)numRows*numCols;
+		if(numRows <= rows && numCols <= cols && 2*used >= (long)rows*cols)
+			return false;
+
+		unique_ptr<T[]> resized(new T[used]);
+		for(int i = 0; i < numRows; i++)
+			for(int j = 0; j < numCols; j++)
+				resized[(long)i*numCols + j] = (i < rows && j < cols) ? cells[(long)i*cols + j] : value;
+
+		cells.swap(resized);
+		rows = numRows;
+		cols = numCols;
+		return true;
+	}
+
+	/* Set every allocated cell to 'value'. */
+	void fill(const T &value){
+		for(long k = 0; k < (long)rows*cols; k++)
+			cells[k] = value;
+	}
+
+private:
+	unique_ptr<T[]> cells;
+};
+
+/* Rows [firstRow, lastRow) and columns [firstCol, lastCol) of a grid of cells. */
+typedef struct GridRange{
+	int firstRow, lastRow;
+	int firstCol, lastCol;
+} GridRange;
+
+/* Cells of a rows x cols grid of square cells that intersect a view. (originX, originY) is
+ * the corner of the cell (0, 0) and the view is (viewX, viewY, viewWidth, viewHeight), both
+ * in screen coordinates (i.e. with the scroll offset already applied). */
+inline GridRange visibleRange(float viewX, float viewY, float viewWidth, float viewHeight, float originX, float originY, float cellSize, int rows, int cols){
+	GridRange range;
+	range.firstRow = max(0, min(rows, (int)floor((viewY - originY) / cellSize)));
+	range.lastRow = max(0, min(rows, (int)ceil((viewY + viewHeight - originY) / cellSize)));
+	range.firstCol = max(0, min(cols, (int)floor((viewX - originX) / cellSize)));
+	range.lastCol = max(0, min(cols, (int)ceil((viewX + viewWidth - originX) / cellSize)));
+	return range;
+}
+
+#endif
@@ -6,9 +6,12 @@ Gui::Gui(){
     channel = GuiChannel();
     posteriors = GuiPosteriors();
     visualization = GuiVisualization();
+    renderer = &raylibRenderer;
     drawing = false;
     showLabels = true;
     showConvexHull = false;
+    showPriorCloud = false;
+    heatmapMeasure = HEATMAP_NONE;
     readFonts();
 
     for(int i = 0; i < 3; i++)
@@ -44,12 +47,7 @@ bool Gui::checkPriorTextBoxPressed(){
 }
 
 bool Gui::checkChannelTextBoxPressed(){
-    for(int i = 0; i < channel.numSecrets[channel.curChannel]; i++)
-        for(int j = 0; j < channel.numOutputs[channel.curChannel]; j++)
-            if(channel.TextBoxChannelEditMode[i][j] == true)
-                return true;
-
-    return false;
+    return channel.editing();
 }
 
 void Gui::moveAmongPriorTextBoxes(){
@@ -86,98 +84,82 @@ void Gui::moveAmongPriorTextBoxes(){
 void Gui::moveAmongChannelTextBoxes(){
     int nRows = channel.numSecrets[channel.curChannel];
     int nColumns = channel.numOutputs[channel.curChannel];
+    int i = channel.editRow, j = channel.editCol;
 
-    for(int i = 0; i < nRows; i++){
-        for(int j = 0; j < nColumns; j++){
-            if(channel.TextBoxChannelEditMode[i][j] == true){
-                channel.TextBoxChannelEditMode[i][j] = false;
-                if(IsKeyPressed(KEY_TAB)){
-                    if(IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)){
-                        if(j > 0){
-                            channel.TextBoxChannelEditMode[i][j-1] = true;
-                        }else if(i > 0){
-                            channel.TextBoxChannelEditMode[i-1][nColumns-1] = true;
-                        }else{
-                            channel.TextBoxChannelEditMode[nRows-1][nColumns-1] = true;
-                        }
-                    }else{
-                        if(j < nColumns-1){
-                            channel.TextBoxChannelEditMode[i][j+1] = true;
-                        }else if(i < nRows-1){
-                            channel.TextBoxChannelEditMode[i+1][0] = true;
-                        }else{
-                            channel.TextBoxChannelEditMode[0][0] = true;
-                        }
-                    }
-                }else if(IsKeyPressed(KEY_UP) && i > 0){
-                    channel.TextBoxChannelEditMode[i-1][j] = true;
-                }else if(IsKeyPressed(KEY_DOWN) && i < nRows-1){
-                    channel.TextBoxChannelEditMode[i+1][j] = true;   
-                }else if(IsKeyPressed(KEY_LEFT) && j > 0){
-                    channel.TextBoxChannelEditMode[i][j-1] = true;
-                }else if(IsKeyPressed(KEY_RIGHT) && j < nColumns-1){
-                    channel.TextBoxChannelEditMode[i][j+1] = true;
-                }else{
-                    channel.TextBoxChannelEditMode[i][j] = true;
-                }
-                return;
+    if(!channel.editing())
+        return;
+
+    if(IsKeyPressed(KEY_TAB)){
+        if(IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)){
+            if(j > 0){
+                channel.edit(i, j-1);
+            }else if(i > 0){
+                channel.edit(i-1, nColumns-1);
+            }else{
+                channel.edit(nRows-1, nColumns-1);
+            }
+        }else{
+            if(j < nColumns-1){
+                channel.edit(i, j+1);
+            }else if(i < nRows-1){
+                channel.edit(i+1, 0);
+            }else{
+                channel.edit(0, 0);
             }
         }
+    }else if(IsKeyPressed(KEY_UP) && i > 0){
+        channel.edit(i-1, j);
+    }else if(IsKeyPressed(KEY_DOWN) && i < nRows-1){
+        channel.edit(i+1, j);
+    }else if(IsKeyPressed(KEY_LEFT) && j > 0){
+        channel.edit(i, j-1);
+    }else if(IsKeyPressed(KEY_RIGHT) && j < nColumns-1){
+        channel.edit(i, j+1);
     }
 }
 
 void Gui::updatePriorTextBoxes(Distribution &prior_){
-    vector<string> truncPrior = getStrTruncatedDist(prior_, PROB_PRECISION);
-    for(int i = 0; i < prior_.num_el; i++){
-        strcpy(prior.TextBoxPriorText[i], truncPrior[i].c_str());
-    }
+    formatDistribution(prior_.prob.data(), prior_.num_el, 1, PROB_PRECISION, prior.TextBoxPriorText[0], CHAR_BUFFER_SIZE);
 }
 
-void Gui::updateChannelTextBoxes(Channel &channel_, int channelIdx){
-    for(int i = 0; i < channel_.prior.num_el; i++){
-        vector<long double> row = vector<long double>(channel_.num_out);
-        for(int j = 0; j < channel_.num_out; j++){
-            row[j] = channel_.matrix[i][j];
-        }
-        Distribution rowDist = Distribution(row);
-        vector<string> truncDist = getStrTruncatedDist(rowDist, PROB_PRECISION);
-        for(int j = 0; j < channel_.num_out; j++){
-            strcpy(channel.TextBoxChannelText[channelIdx][i][j], truncDist[j].c_str());
-        }
-    }
+void Gui::updateChannelTextBoxes(Matrix &channel_, int channelIdx){
+    channel.reserve(channelIdx, channel_.rows, channel_.cols);
+    TextGrid &text = channel.TextBoxChannelText[channelIdx];
+    for(int i = 0; i < channel_.rows; i++)
+        formatDistribution(channel_.row(i), channel_.cols, 1, PROB_PRECISION, text[i][0].text, sizeof(TextCell));
 }
 
-void Gui::updateHyperTextBoxes(Hyper &hyper, int channel, bool ready){
+bool Gui::updateHyperTextBoxes(Hyper &hyper, int channel, unsigned long version){
+    if(posteriors.text.current(channel, version, PROB_PRECISION))
+        return false;
+    posteriors.text.store(channel, version, PROB_PRECISION);
+
     // If hyper is not ready, fill textboxes with zeros
-    if(!ready){
+    if(version == 0){
         for(int i = 0; i < NUMBER_SECRETS; i++){
             strcpy(posteriors.TextBoxOuterText[i], "0");    
             for(int j = 0; j < NUMBER_SECRETS; j++){
                 strcpy(posteriors.TextBoxInnersText[j][i], "0");
             }
         }
-        return;
+        return true;
     }
 
     // Hyper is ready
+    posteriors.reserve(hyper.num_post);
+
     // Outer
-    vector<string> truncDist = getStrTruncatedDist(hyper.outer, PROB_PRECISION);
-    for(int i = 0; i < hyper.num_post; i++){
-        strcpy(posteriors.TextBoxOuterText[i], truncDist[i].c_str());
-    }
+    formatDistribution(hyper.outer.prob.data(), hyper.num_post, 1, PROB_PRECISION, posteriors.TextBoxOuterText[0].text, sizeof(TextCell));
 
-    // Inners
+    // Inners. The textboxes of a posterior are a column of the grid.
+    long double inner[NUMBER_SECRETS];
+    long columnStride = posteriors.TextBoxInnersText.cols * sizeof(TextCell);
     for(int i = 0; i < hyper.num_post; i++){
-        vector<long double> inner = vector<long double>(NUMBER_SECRETS);
-        for(int j = 0; j < NUMBER_SECRETS; j++){
+        for(int j = 0; j < NUMBER_SECRETS; j++)
             inner[j] = hyper.inners[j][i];
-        }
-        Distribution innerDist = Distribution(inner);
-        vector<string> truncDist = getStrTruncatedDist(innerDist, PROB_PRECISION);
-        for(int j = 0; j < NUMBER_SECRETS; j++){
-            strcpy(posteriors.TextBoxInnersText[j][i], truncDist[j].c_str());
-        }
+        formatDistribution(inner, NUMBER_SECRETS, 1, PROB_PRECISION, posteriors.TextBoxInnersText[0][i].text, columnStride);
     }
+    return true;
 }
 
 void Gui::updateRectanglePriorCircleLabel(Circle &priorCircle){
@@ -189,9 +171,10 @@ void Gui::updateRectanglePriorCircleLabel(Circle &priorCircle){
     };
 }
 
-void Gui::updateRectangleInnersCircleLabel(int channel, Circle innersCircles[MAX_CHANNEL_OUTPUTS]){
+void Gui::updateRectangleInnersCircleLabel(int channel, vector<Circle> &innersCircles){
     // Update circle labels and rectangles
-    for(int i = 0; i < posteriors.numPosteriors[channel]; i++){
+    visualization.recLabelInnersCircles[channel].resize(innersCircles.size());
+    for(int i = 0; i < (int)innersCircles.size(); i++){
         visualization.recLabelInnersCircles[channel][i] = (Rectangle){
             (float) innersCircles[i].center.x - 8,
             (float) innersCircles[i].center.y - 11,
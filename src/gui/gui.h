@@ -6,6 +6,8 @@
 #include "guichannel.h"
 #include "guiposteriors.h"
 #include "guivisualization.h"
+#include "../raylibrenderer.h"
+#include "../heatmap.h"
 #include <fstream>
 #include <cmath>
 
@@ -32,6 +34,8 @@ public:
     GuiPosteriors posteriors;
     GuiVisualization visualization;
 
+    Renderer *renderer; // Shapes and text of the panels and the visualization. raylibRenderer unless it is replaced (i.e. by a RecordingRenderer).
+
     // Fonts
     Font defaultFont;
     Font defaultFontBig; // Same as defaultFont but with size 32
@@ -40,6 +44,8 @@ public:
     bool helpMessagesActive[3]; // Flags used to show help messages
     bool showLabels; // Flag used in visualization to show or not circles labels
     bool showConvexHull; // Flag used in visualization to show or convex hull of inners
+    bool showPriorCloud; // Flag used in visualization to show or not the prior cloud
+    int heatmapMeasure; // Measure shown by the heatmap of the triangle (HEATMAP_NONE, HEATMAP_VULNERABILITY or HEATMAP_LEAKAGE)
 
     char helpMessages[3][CHAR_BUFFER_SIZE*2];
 
@@ -68,16 +74,19 @@ public:
 	void updatePriorTextBoxes(Distribution &prior_);
 
     /* If Update channel textboxes for a given channel. */
-	void updateChannelTextBoxes(Channel &channel_, int channelIdx);
+	void updateChannelTextBoxes(Matrix &channel_, int channelIdx);
     
-    /* If a hyper-distributin has been built, update outer and inners TextBoxes;. */
-	void updateHyperTextBoxes(Hyper &hyper, int channel, bool ready);
+    /* If a hyper-distributin has been built, update outer and inners TextBoxes.
+     * 'version' is the version of the hyper, or 0 if it is not ready and the textboxes are filled with zeros.
+     * The text is only formatted when the channel, the version or the precision changed since the last call.
+     * Returns true if the textboxes were written. */
+	bool updateHyperTextBoxes(Hyper &hyper, int channel, unsigned long version);
 
     /* Update rectangle of prior circle label. */
     void updateRectanglePriorCircleLabel(Circle &priorCircle);
 
     /* Update rectangles of inners circle labels. */
-    void updateRectangleInnersCircleLabel(int channel, Circle innersCircles[MAX_CHANNEL_OUTPUTS]);
+    void updateRectangleInnersCircleLabel(int channel, vector<Circle> &innersCircles);
 
     // Check mouse position and manage help messages
     void checkMouseHover(Vector2 mousePosition);
@@ -4,8 +4,8 @@ GuiChannel::GuiChannel(){
     // Data
     curChannel = CHANNEL_1;
     for(int i = 0; i < NUMBER_CHANNELS; i++){
-        numSecrets[i] = 3;
-        numOutputs[i] = 3;
+        numSecrets[i] = 0;
+        numOutputs[i] = 0;
     }
 
     // Text
@@ -16,12 +16,6 @@ GuiChannel::GuiChannel(){
     strcpy(panelChannelText, "Channel C");
     strcpy(LabelOutputsText, "Outputs");
     strcpy(buttonRandomText, "Generate Random");
-    for(int i = 0; i < MAX_CHANNEL_OUTPUTS; i++){
-        LabelChannelXText[i] = "X" + to_string(i+1);
-        LabelChannelYText[i] = "Y" + to_string(i+1);
-        LabelChannelYPText[i] = "Y'" + to_string(i+1);
-        LabelChannelZText[i] = "Z" + to_string(i+1);
-    }    
 
     // Define anchors
     AnchorChannel = {10, 185};
@@ -30,20 +24,13 @@ GuiChannel::GuiChannel(){
     SpinnerChannelEditMode = false;
     
     for(int i = 0; i < NUMBER_CHANNELS; i++)
-        SpinnerChannelValue[i] = numOutputs[i];
+        SpinnerChannelValue[i] = 3;
     
     ScrollPanelScrollOffset = {0, 0};
     ScrollPanelBoundsOffset = {0, 0};
+    editRow = -1;
+    editCol = -1;
 
-    for(int k = 0; k < NUMBER_CHANNELS; k++){
-        for(int i = 0; i < MAX_CHANNEL_OUTPUTS; i++){
-            for(int j = 0; j < MAX_CHANNEL_OUTPUTS; j++){
-                TextBoxChannelEditMode[i][j] = false;
-                strcpy(TextBoxChannelText[k][i][j], "0");
-            }
-        }
-    }
-    
     // Define control rectangles
     recTitle = (Rectangle){AnchorChannel.x, AnchorChannel.y, 350, 20};
     recContent = (Rectangle){AnchorChannel.x, AnchorChannel.y + 20, 350, 265};
@@ -52,23 +39,82 @@ GuiChannel::GuiChannel(){
     ScrollPanelContent.y = recScrollPanel.height - 20;
     recLabelOutputs = (Rectangle){AnchorChannel.x + 175, AnchorChannel.y + 5, 78, 25};
 
-    for(int i = 0; i < MAX_CHANNEL_OUTPUTS; i++){
-        recLabelX[i] = (Rectangle){AnchorChannel.x + 40, AnchorChannel.y + 100 + i*TEXTBOX_SIZE, 20, TEXTBOX_SIZE};
-        for(int j = 0; j < MAX_CHANNEL_OUTPUTS; j++){
-            recTextBoxChannel[i][j] = (Rectangle){AnchorChannel.x + 65 + j*TEXTBOX_SIZE, AnchorChannel.y + 100 + i*TEXTBOX_SIZE, TEXTBOX_SIZE, TEXTBOX_SIZE};
-        }
-    }
-
-    for(int i = 0; i < MAX_CHANNEL_OUTPUTS; i++){
-        recLabelY[i] = (Rectangle){AnchorChannel.x + 80 + i*TEXTBOX_SIZE, AnchorChannel.y + 80, 20, 20};
-    }
+    // Textboxes, labels and their rectangles
+    for(int i = 0; i < NUMBER_CHANNELS; i++)
+        reserve(i, 3, 3);
     
     recTabs[CHANNEL_1] = (Rectangle){AnchorChannel.x + 0, AnchorChannel.y, 56, 20};
     recTabs[CHANNEL_2] = (Rectangle){AnchorChannel.x + 57, AnchorChannel.y, 56, 20};
     recTabs[CHANNEL_3] = (Rectangle){AnchorChannel.x + 114, AnchorChannel.y, 56, 20};
 
     recButtonRandom = (Rectangle){recTitle.x + recTitle.width - 140, recTitle.y, 140, 20};
-    ScrollPanelContent.x = recTextBoxChannel[0][numOutputs[CHANNEL_1]-1].x + TEXTBOX_SIZE;
+    ScrollPanelContent.x = recTextBoxChannel(0, numOutputs[CHANNEL_1]-1).x + TEXTBOX_SIZE;
+}
+
+void GuiChannel::reserve(int channel, int numSecrets, int numOutputs){
+    TextGrid &text = TextBoxChannelText[channel];
+    text.reserve(numSecrets, numOutputs, TEXT_ZERO);
+
+    // The cells the channel leaves are set to "0", so the ones it grows into later are "0" as well
+    int rows = min(this->numSecrets[channel], text.rows), cols = min(this->numOutputs[channel], text.cols);
+    for(int i = 0; i < rows; i++)
+        for(int j = (i < numSecrets ? numOutputs : 0); j < cols; j++)
+            text[i][j] = TEXT_ZERO;
+
+    this->numSecrets[channel] = numSecrets;
+    this->numOutputs[channel] = numOutputs;
+
+    // A textbox in edit mode that the channel left is not edited anymore
+    if(channel == curChannel && !editing())
+        edit(-1, -1);
+
+    // Rows of R are labeled as outputs of C, so both kinds of labels cover rows and columns
+    int numLabels = max(numSecrets, numOutputs);
+    for(int i = (int)recLabelX.size(); i < numLabels; i++){
+        LabelChannelXText.push_back("X" + to_string(i+1));
+        LabelChannelYText.push_back("Y" + to_string(i+1));
+        LabelChannelYPText.push_back("Y'" + to_string(i+1));
+        LabelChannelZText.push_back("Z" + to_string(i+1));
+        recLabelX.push_back((Rectangle){AnchorChannel.x + 40, AnchorChannel.y + 100 + i*TEXTBOX_SIZE, 20, TEXTBOX_SIZE});
+        recLabelY.push_back((Rectangle){AnchorChannel.x + 80 + i*TEXTBOX_SIZE, AnchorChannel.y + 80, 20, 20});
+    }
+}
+
+Rectangle GuiChannel::recTextBoxChannel(int i, int j){
+    return (Rectangle){AnchorChannel.x + 65 + j*TEXTBOX_SIZE, AnchorChannel.y + 100 + i*TEXTBOX_SIZE, TEXTBOX_SIZE, TEXTBOX_SIZE};
+}
+
+GridRange GuiChannel::visibleTextBoxes(Rectangle view){
+    Rectangle origin = recTextBoxChannel(0, 0);
+    return visibleRange(view.x, view.y, view.width, view.height, origin.x + ScrollPanelScrollOffset.x, origin.y + ScrollPanelScrollOffset.y,
+                        TEXTBOX_SIZE, numSecrets[curChannel], numOutputs[curChannel]);
+}
+
+bool GuiChannel::editing(){
+    return editRow >= 0 && editRow < numSecrets[curChannel] && editCol >= 0 && editCol < numOutputs[curChannel];
+}
+
+void GuiChannel::edit(int i, int j){
+    editRow = i;
+    editCol = j;
+    if(i < 0 || j < 0)
+        return;
+
+    // Keep the textbox inside the view (the scroll bars take 20 pixels), so it keeps being drawn
+    Rectangle rec = recTextBoxChannel(i, j);
+    float minX = recScrollPanel.x - rec.x;
+    float maxX = recScrollPanel.x + recScrollPanel.width - 20 - (rec.x + rec.width);
+    float minY = recScrollPanel.y - rec.y;
+    float maxY = recScrollPanel.y + recScrollPanel.height - 20 - (rec.y + rec.height);
+    ScrollPanelScrollOffset.x = max(min(ScrollPanelScrollOffset.x, maxX), minX);
+    ScrollPanelScrollOffset.y = max(min(ScrollPanelScrollOffset.y, maxY), minY);
+}
+
+void GuiChannel::selectChannel(int channel){
+    // The textbox in edit mode belongs to the previous channel
+    if(channel != curChannel)
+        edit(-1, -1);
+    curChannel = channel;
 }
 
 bool GuiChannel::checkChannelSpinner(int mode){
@@ -80,63 +126,33 @@ bool GuiChannel::checkChannelSpinner(int mode){
 }
 
 void GuiChannel::updateChannelBySpinner(int channel, int mode){
-    if(SpinnerChannelValue[channel] <= 0){
-        SpinnerChannelValue[channel] = 1;
-    }else if(SpinnerChannelValue[channel] > 50){
-        SpinnerChannelValue[channel] = 50;
-    }else if(SpinnerChannelValue[channel] < numOutputs[channel]){
-        int diff = numOutputs[channel] - SpinnerChannelValue[channel];
-        ScrollPanelContent.x = ScrollPanelContent.x - diff*TEXTBOX_SIZE;
-    }else{
-        for(int i = 0; i < numSecrets[channel]; i++){
-            for(int j = numOutputs[channel]; j < SpinnerChannelValue[channel]; j++){
-                TextBoxChannelEditMode[i][j] = false;
-                strcpy(TextBoxChannelText[channel][i][j], "0");
-            }
-        }
-
-        ScrollPanelContent.x = ScrollPanelContent.x + (SpinnerChannelValue[channel]-numOutputs[channel])*TEXTBOX_SIZE;
-    }
-
-    numOutputs[channel] = SpinnerChannelValue[channel];
+    SpinnerChannelValue[channel] = min(max(SpinnerChannelValue[channel], 1), MAX_CHANNEL_OUTPUTS);
+    ScrollPanelContent.x = ScrollPanelContent.x + (SpinnerChannelValue[channel]-numOutputs[channel])*TEXTBOX_SIZE;
+    reserve(channel, numSecrets[channel], SpinnerChannelValue[channel]);
 
     if(mode == MODE_REF){
         if(channel == CHANNEL_1){
-            if(numSecrets[CHANNEL_2] < numOutputs[CHANNEL_1]){
-                for(int j = 0; j < numOutputs[CHANNEL_2]; j++){
-                    for(int i = numSecrets[CHANNEL_2]; i < numOutputs[CHANNEL_1]; i++){
-                        TextBoxChannelEditMode[i][j] = false;
-                        strcpy(TextBoxChannelText[CHANNEL_2][i][j], "0");
-                    }
-                }
-            }
-            numSecrets[CHANNEL_2] = numOutputs[CHANNEL_1];
+            reserve(CHANNEL_2, numOutputs[CHANNEL_1], numOutputs[CHANNEL_2]);
         }else{
-            if(numOutputs[CHANNEL_3] < numOutputs[CHANNEL_2]){
-                for(int i = 0; i < numSecrets[CHANNEL_3]; i++){
-                    for(int j = numOutputs[CHANNEL_3]; j < numOutputs[CHANNEL_2]; j++){
-                        TextBoxChannelEditMode[i][j] = false;
-                        strcpy(TextBoxChannelText[CHANNEL_3][i][j], "0");
-                    }
-                }
-            }
-            SpinnerChannelValue[CHANNEL_3] = numOutputs[CHANNEL_2];
-            numOutputs[CHANNEL_3] = numOutputs[CHANNEL_2];
+            reserve(CHANNEL_3, numSecrets[CHANNEL_3], numOutputs[CHANNEL_2]);
+            SpinnerChannelValue[CHANNEL_3] = numOutputs[CHANNEL_3];
         }
     }
 }
 
-void GuiChannel::updateChannelTextBoxes(vector<vector<long double>> &channel){
-    for(int i = 0; i < numSecrets[curChannel]; i++){
-        for(int j = 0; j < numOutputs[curChannel]; j++){
-            sprintf(TextBoxChannelText[curChannel][i][j], "%.3Lf", channel[i][j]);
-        }
-    }
+void GuiChannel::updateChannelTextBoxes(Matrix &channel){
+    reserve(curChannel, numSecrets[curChannel], numOutputs[curChannel]);
+
+    // Rows are formatted as distributions, so the text of each row still sums to 1
+    TextGrid &text = TextBoxChannelText[curChannel];
+    for(int i = 0; i < numSecrets[curChannel]; i++)
+        formatDistribution(channel.row(i), numOutputs[curChannel], 1, PROB_PRECISION, text[i][0].text, sizeof(TextCell));
 }
 
 void GuiChannel::checkModeAndSizes(int mode){
     if(mode == MODE_TWO){
-        numSecrets[CHANNEL_2] = 3;
+        // Channel R may have been left with the rows of the outputs of C by the refinement mode
+        reserve(CHANNEL_2, NUMBER_SECRETS, numOutputs[CHANNEL_2]);
     }else if(mode == MODE_REF){
         updateChannelBySpinner(CHANNEL_1, mode);
         updateChannelBySpinner(CHANNEL_2, mode);
@@ -145,7 +161,7 @@ void GuiChannel::checkModeAndSizes(int mode){
 
 void GuiChannel::setScrollContent(){
     ScrollPanelContent.y = recScrollPanel.height - 20 + (max(0,numSecrets[curChannel]-3))*TEXTBOX_SIZE; // Secrets
-    ScrollPanelContent.x = recTextBoxChannel[0][numOutputs[curChannel]-1].x - 10 + TEXTBOX_SIZE; // Outputs
+    ScrollPanelContent.x = recTextBoxChannel(0, numOutputs[curChannel]-1).x - 10 + TEXTBOX_SIZE; // Outputs
 }
 
 void GuiChannel::resetChannel(int channel){
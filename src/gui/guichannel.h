@@ -27,10 +27,10 @@ public:
     char panelChannelText[CHAR_BUFFER_SIZE];
     char LabelOutputsText[CHAR_BUFFER_SIZE];
     char buttonRandomText[CHAR_BUFFER_SIZE];
-    string LabelChannelXText[MAX_CHANNEL_OUTPUTS];
-    string LabelChannelYText[MAX_CHANNEL_OUTPUTS];
-    string LabelChannelYPText[MAX_CHANNEL_OUTPUTS];
-    string LabelChannelZText[MAX_CHANNEL_OUTPUTS];
+    vector<string> LabelChannelXText;
+    vector<string> LabelChannelYText;
+    vector<string> LabelChannelYPText;
+    vector<string> LabelChannelZText;
     char LabelChannelTabs[NUMBER_CHANNELS][CHAR_BUFFER_SIZE];
 
     // Define anchors
@@ -42,8 +42,8 @@ public:
     Vector2 ScrollPanelScrollOffset;
     Vector2 ScrollPanelBoundsOffset;
     Vector2 ScrollPanelContent;
-    bool TextBoxChannelEditMode[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS];
-    char TextBoxChannelText[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE];
+    int editRow, editCol;           // Textbox in edit mode, -1 if none. Only one textbox is edited at a time
+    TextGrid TextBoxChannelText[NUMBER_CHANNELS];
 
     // Define control rectangles
     Rectangle recTitle;
@@ -52,12 +52,9 @@ public:
     Rectangle recScrollPanel;
     Rectangle recLabelOutputs;
     Rectangle recButtonRandom;
-    Rectangle recLabelX[MAX_CHANNEL_OUTPUTS];
-    Rectangle recLabelY[MAX_CHANNEL_OUTPUTS];
+    vector<Rectangle> recLabelX;
+    vector<Rectangle> recLabelY;
     Rectangle recTabs[NUMBER_CHANNELS];
-    
-    // Important: The matrix is indexed by columns x rows
-    Rectangle recTextBoxChannel[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS];
 
     //------------------------------------------------------------------------------------
     // Methods
@@ -82,16 +79,33 @@ public:
     void updateChannelBySpinner(int channel, int mode);
     
     // Update channel textboxes text when the random button is pressed according to current active channel 
-    void updateChannelTextBoxes(vector<vector<long double>> &channel);
-
-    // Copy the values of a channel matrix to another one
-    static void copyChannelText(char origin[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE], char dest[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE], int numSecrets, int numOutputs){
-        for(int i = 0; i < numSecrets; i++){
-            for(int j = 0; j < numOutputs; j++){
-                strcpy(dest[i][j], origin[i][j]);
-            }
-        }
-    }
+    void updateChannelTextBoxes(Matrix &channel);
+
+    /* Set the size of a channel to numSecrets x numOutputs textboxes. It is the only place
+       where numSecrets and numOutputs change, so the textboxes always cover them. The labels,
+       shared by all channels, grow with the largest one. New textboxes are "0", and so are the
+       ones out of the channel that the grid keeps, unless their text was written out of here
+       before the call (i.e. by GuiMenu::readQIFFile, which reserves the grid itself).
+       If the textbox in edit mode is out of the new size of the current channel, it is left. */
+    void reserve(int channel, int numSecrets, int numOutputs);
+
+    /* Rectangle of the textbox in row i and column j, without the scroll offset.
+       Textboxes are laid out in a regular grid, so their rectangles are not stored. */
+    Rectangle recTextBoxChannel(int i, int j);
+
+    /* Rows and columns of the current channel that intersect the scroll panel view.
+       Only these textboxes are drawn and hit-tested, so the cost of a frame depends on
+       the size of the view and not on the size of the channel. */
+    GridRange visibleTextBoxes(Rectangle view);
+
+    // Returns true if a textbox of the current channel is in edit mode
+    bool editing();
+
+    // Set the textbox in edit mode (-1, -1 for none) and scroll the panel to show it
+    void edit(int i, int j);
+
+    // Set the current channel. The textbox in edit mode is left if the channel changes.
+    void selectChannel(int channel);
 
     // Check if the current mode and channels sizes are compatible. If not, fix it.
     void checkModeAndSizes(int mode);
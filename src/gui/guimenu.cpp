@@ -16,7 +16,7 @@ GuiMenu::GuiMenu(int windowWidth, int windowHeight){
     windowGettingStartedActive = false;
 
     // Text
-    strcpy(buttonFileText, "File;Open file;Save;Save as...;Exit");
+    strcpy(buttonFileText, "File;Open file;Open prior cloud;Save;Save as...;Exit");
     strcpy(buttonModeText, "Mode;#112#Single channel;#000#Two channels;#000#Refinement");
     strcpy(buttonExamplesText, "Examples;Load channel that leaks everything;Load channel that leaks nothing");
     strcpy(buttonGuideText, "Guide");
@@ -160,35 +160,19 @@ GuiMenu::GuiMenu(int windowWidth, int windowHeight){
 
 int GuiMenu::readQIFFile(
     char prior[NUMBER_SECRETS][CHAR_BUFFER_SIZE],
-    char channel[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE],
+    TextGrid channel[NUMBER_CHANNELS],
     int numSecrets[NUMBER_CHANNELS],
     int numOutputs[NUMBER_CHANNELS]
     ){
 
-    /* File formats:
-    
-    Mode single channel:     |  Mode two channels:       |  Mode refinement:
-    -----BEGIN OF FILE-----  |  -----BEGIN OF FILE-----  |  -----BEGIN OF FILE-----
-    mode 1                   |  mode 2                   |  mode 3
-    prior 3                  |  prior 3                  |  prior 3
-    p1 p2 p3                 |  p1 p2 p3                 |  p1 p2 p3
-    channel1 3 m             |  channel1 3 m             |  channel1 3 m
-    p11 p12 ... p1m          |  p11 p12 ... p1m          |  p11 p12 ... p1m
-    p21 p22 ... p2m          |  p21 p22 ... p2m          |  p21 p22 ... p2m
-    p31 p32 ... p3m          |  p31 p32 ... p3m          |  p31 p32 ... p3m
-    -----END OF FILE-----    |  channel2 3 m'            |  channel2 m m'
-                             |  p11 p12 ... p1m'         |  p11 p12 ... p1m'
-                             |  p21 p22 ... p2m'         |  p21 p22 ... p2m'
-                             |  p31 p32 ... p3m'         |  ...
-                             |  -----END OF FILE-----    |  pm1 pm2 ... pmm'
-                             |                           |  -----END OF FILE-----
+    /* The file formats are described in qiffile.h and session.h.
 
     If there is an error with file, returns the error flag.
     If there is no error, return the mode flag contained in file.
     */
 
 #if !defined(PLATFORM_WEB)
-    FILE *file = popen("zenity --file-selection --title=Open --file-filter=*.qifg", "r");
+    FILE *file = popen("zenity --file-selection --title=Open --file-filter='*.qifg *.qifgb'", "r");
     fgets(fileName, 2048, file);
     fclose(file);
 
@@ -197,89 +181,34 @@ int GuiMenu::readQIFFile(
     newFileName = newFileName.substr(0, newFileName.find_last_of("\n"));
     strcpy(fileName, newFileName.c_str());
 
-    ifstream infile;
-    string buffer;
-    int mode, bufferInt;
-    int newNumberSecrets[NUMBER_CHANNELS];
-    int newNumberOutputs[NUMBER_CHANNELS];
-    char newPrior[NUMBER_SECRETS][CHAR_BUFFER_SIZE];
-    char newChannels[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE];
-    try{
-        infile.open(fileName); 
-        
-        // Find mode
-        infile >> buffer;
-        if(buffer != "mode") throw exception();
-        infile >> mode;
-        if(mode != MODE_SINGLE && mode != MODE_TWO && mode != MODE_REF) throw exception();
-
-        // Prior
-        infile >> buffer;
-        if(buffer != "prior") throw exception();
-        infile >> bufferInt;
-        if(bufferInt != NUMBER_SECRETS) throw exception();
-
-        for(int i = 0; i < bufferInt; i++){
-            infile >> buffer;
-            strcpy(newPrior[i], buffer.c_str());
-        }
-
-        // Channel 1
-        infile >> buffer;
-        if(buffer != "channel1") throw exception();
-        infile >> newNumberSecrets[CHANNEL_1];
-        if(newNumberSecrets[CHANNEL_1] != NUMBER_SECRETS) throw exception();
-        infile >> newNumberOutputs[CHANNEL_1];
-        if(newNumberOutputs[CHANNEL_1] < 0 || newNumberOutputs[CHANNEL_1] > 50) throw exception();
-
-        for(int i = 0; i < newNumberSecrets[CHANNEL_1]; i++){
-            for(int j = 0; j < newNumberOutputs[CHANNEL_1]; j++){
-                infile >> buffer;
-                strcpy(newChannels[CHANNEL_1][i][j], buffer.c_str());
-            }
-        }
-
-        // Channel 2
-        if(mode == MODE_TWO || mode == MODE_REF){
-            infile >> buffer;
-            if(buffer != "channel2") throw exception();
-            infile >> newNumberSecrets[CHANNEL_2];
-            if(mode == MODE_TWO && newNumberSecrets[CHANNEL_2] != NUMBER_SECRETS) throw exception();
-            if(mode == MODE_REF && newNumberSecrets[CHANNEL_2] != newNumberOutputs[CHANNEL_1]) throw exception();
-            infile >> newNumberOutputs[CHANNEL_2];
-            if(newNumberOutputs[CHANNEL_2] < 0 || newNumberOutputs[CHANNEL_2] > 50) throw exception();
-
-            for(int i = 0; i < newNumberSecrets[CHANNEL_2]; i++){
-                for(int j = 0; j < newNumberOutputs[CHANNEL_2]; j++){
-                    infile >> buffer;
-                    strcpy(newChannels[CHANNEL_2][i][j], buffer.c_str());
-                }
-            }
+    if(isSessionFile()){
+        int mode = session.load(string(fileName));
+        if(mode == INVALID_QIF_FILE)
+            return INVALID_QIF_FILE;
+
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            strcpy(prior[i], session.prior[i].c_str());
+
+        int numChannels = (mode == MODE_TWO || mode == MODE_REF) ? 2 : 1;
+        for(int c = 0; c < numChannels; c++){
+            numSecrets[c] = session.numSecrets[c];
+            numOutputs[c] = session.numOutputs[c];
+            channel[c].reserve(numSecrets[c], numOutputs[c], TEXT_ZERO);
+            for(int i = 0; i < numSecrets[c]; i++)
+                for(int j = 0; j < numOutputs[c]; j++)
+                    strcpy(channel[c][i][j], session.channel[c][i*numOutputs[c] + j].c_str());
         }
 
-        // If no exception was thrown until here, there was no error with the file
-        infile.close();
+        return mode;
+    }
 
-        // Copy prior values
-        GuiPrior::copyPrior(newPrior, prior);
+    int mode = qifFile.read(string(fileName));
+    if(mode == INVALID_QIF_FILE)
+        return INVALID_QIF_FILE;
 
-        // Copy channel 1 values
-        numSecrets[CHANNEL_1] = newNumberSecrets[CHANNEL_1];
-        numOutputs[CHANNEL_1] = newNumberOutputs[CHANNEL_1];
-        GuiChannel::copyChannelText(newChannels[CHANNEL_1], channel[CHANNEL_1], numSecrets[CHANNEL_1], numOutputs[CHANNEL_1]);
+    qifFile.copyText(prior, channel, numSecrets, numOutputs);
 
-        // Copy channel 2 values
-        if(mode == MODE_TWO || mode == MODE_REF){
-            numSecrets[CHANNEL_2] = newNumberSecrets[CHANNEL_2];
-            numOutputs[CHANNEL_2] = newNumberOutputs[CHANNEL_2];
-            GuiChannel::copyChannelText(newChannels[CHANNEL_2], channel[CHANNEL_2], numSecrets[CHANNEL_2], numOutputs[CHANNEL_2]);
-        }
-        
-        return mode;
-    }catch(const exception& e){
-        infile.close();
-        return INVALID_QIF_FILE;
-    }
+    return mode;
 #else
     return MODE_SINGLE;
 #endif
@@ -287,7 +216,7 @@ int GuiMenu::readQIFFile(
 
 void GuiMenu::saveQIFFile(
     char prior[NUMBER_SECRETS][CHAR_BUFFER_SIZE],
-    char channel[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE],
+    TextGrid channel[NUMBER_CHANNELS],
     int numSecrets[NUMBER_CHANNELS],
     int numOutputs[NUMBER_CHANNELS],
     int mode,
@@ -325,19 +254,20 @@ void GuiMenu::saveQIFFile(
             newFileName = newFileName.substr(0, newFileName.find_last_of("\n"));
             strcpy(fileName, newFileName.c_str());
 
-            // Fix file extension if it is not .qifg
+            // Fix file extension if it is not .qifg or .qifgb
             string fn = string(fileName);
             if(fn.find_last_of(".") == string::npos){
                 string newFileName = fn + ".qifg";
                 strcpy(fileName, newFileName.c_str());
-            }else if(fn.substr(fn.find_last_of(".") + 1) != "qifg"){
+            }else if(fn.substr(fn.find_last_of(".") + 1) != "qifg" && fn.substr(fn.find_last_of(".") + 1) != "qifgb"){
                 string newFileName = fn.substr(0, fn.find_last_of(".")) + ".qifg";
                 strcpy(fileName, newFileName.c_str());
             }
         }
     }
 
-    if(strcmp(fileName, "\0")){
+    // Sessions are written by the caller, which owns the computed objects
+    if(strcmp(fileName, "\0") && !isSessionFile()){
         // Channel 1
         string output = "";
         output = output + "mode " + to_string(mode) + "\n";
@@ -346,10 +276,10 @@ void GuiMenu::saveQIFFile(
         for(int i = 0; i < numSecrets[CHANNEL_1]; i++){
             int j = 0;
             while(j < numOutputs[CHANNEL_1]-1){
-                output = output + channel[CHANNEL_1][i][j] + " ";
+                output = output + channel[CHANNEL_1][i][j].text + " ";
                 j++;
             }
-            output = output + channel[CHANNEL_1][i][j] + "\n";
+            output = output + channel[CHANNEL_1][i][j].text + "\n";
         }
 
         if(mode == MODE_TWO || mode == MODE_REF){
@@ -358,10 +288,10 @@ void GuiMenu::saveQIFFile(
             for(int i = 0; i < numSecrets[CHANNEL_2]; i++){
                 int j = 0;
                 while(j < numOutputs[CHANNEL_2]-1){
-                    output = output + channel[CHANNEL_2][i][j] + " ";
+                    output = output + channel[CHANNEL_2][i][j].text + " ";
                     j++;
                 }
-                output = output + channel[CHANNEL_2][i][j] + "\n";
+                output = output + channel[CHANNEL_2][i][j].text + "\n";
             }
         }
 
@@ -373,6 +303,35 @@ void GuiMenu::saveQIFFile(
 #endif
 }
 
+bool GuiMenu::isSessionFile(){
+    string fn = string(fileName);
+    return fn.size() > 6 && fn.compare(fn.size() - 6, 6, ".qifgb") == 0;
+}
+
+int GuiMenu::readPriorCloudFile(PriorCloud &cloud){
+#if !defined(PLATFORM_WEB)
+    char cloudFileName[2048] = "";
+    FILE *file = popen("zenity --file-selection --title=\"Open prior cloud\" --file-filter='*.csv *.txt'", "r");
+    fgets(cloudFileName, sizeof(cloudFileName), file);
+    pclose(file);
+
+    // Remove \n from the end
+    cloudFileName[strcspn(cloudFileName, "\n")] = '\0';
+    if(strcmp(cloudFileName, "") == 0)
+        return NO_ERROR;
+
+    return cloud.read(cloudFileName);
+#else
+    return NO_ERROR;
+#endif
+}
+
+string GuiMenu::fileErrorString(){
+    if(isSessionFile())
+        return string(session.error);
+    return qifFile.errorString();
+}
+
 void GuiMenu::loadGSImages(){
     for(int i = 0; i < 7; i++){
         if(!strcmp(imagesSrc[i], ""))
@@ -10,6 +10,8 @@
 #include <assert.h>
 #include "../../libs/raylib/src/raylib.h"
 #include "../data.h"
+#include "../qiffile.h"
+#include "../session.h"
 #include "guiprior.h"
 #include "guichannel.h"
 
@@ -25,9 +27,10 @@ using namespace std;
 
 #define BUTTON_FILE_OPTION_FILE 0
 #define BUTTON_FILE_OPTION_OPEN 1
-#define BUTTON_FILE_OPTION_SAVE 2
-#define BUTTON_FILE_OPTION_SAVEAS 3
-#define BUTTON_FILE_OPTION_EXIT 4
+#define BUTTON_FILE_OPTION_OPEN_CLOUD 2   // CSV file of priors shown as a prior cloud
+#define BUTTON_FILE_OPTION_SAVE 3
+#define BUTTON_FILE_OPTION_SAVEAS 4
+#define BUTTON_FILE_OPTION_EXIT 5
 
 #define BUTTON_MODE_OPTION_MODE 0
 #define BUTTON_MODE_OPTION_SINGLE 1
@@ -70,6 +73,8 @@ public:
     char buttonExamplesText[CHAR_BUFFER_SIZE];
     char buttonGuideText[CHAR_BUFFER_SIZE];
     char* fileName;     // Used with file button to open/save files
+    QIFFile qifFile;    // Last file read. Its memory is reused and it describes the error if the file is invalid.
+    Session session;    // Last session (.qifgb) read or written
 
     // Define controls rectangles
     Rectangle recButtons[4];
@@ -102,19 +107,29 @@ public:
     // Parameters are output
     int readQIFFile(
         char prior[NUMBER_SECRETS][CHAR_BUFFER_SIZE],
-        char channel[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE],
+        TextGrid channel[NUMBER_CHANNELS],
         int numSecrets[NUMBER_CHANNELS],
         int numOutputs[NUMBER_CHANNELS]
     );
 
     void saveQIFFile(
         char prior[NUMBER_SECRETS][CHAR_BUFFER_SIZE],
-        char channel[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE],
+        TextGrid channel[NUMBER_CHANNELS],
         int numSecrets[NUMBER_CHANNELS],
         int numOutputs[NUMBER_CHANNELS],
         int mode,
         bool createNewFile);
 
+    /* Select a CSV file of priors and read it into the cloud (see priorcloud.h).
+     * Returns NO_ERROR, also if no file was selected, or INVALID_PRIOR_CLOUD_FILE. */
+    int readPriorCloudFile(PriorCloud &cloud);
+
+    // Returns true if fileName is a binary session (.qifgb) instead of a text file (.qifg)
+    bool isSessionFile();
+
+    // Description of the error of the last file read
+    string fileErrorString();
+
     void loadGSImages();
 };
 
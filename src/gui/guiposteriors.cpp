@@ -12,11 +12,6 @@ GuiPosteriors::GuiPosteriors(){
     for(int i = 0; i < NUMBER_SECRETS; i++){
         LabelPosteriorsXText[i] = "X" + to_string(i+1);
     }
-    for(int i = 0; i < MAX_CHANNEL_OUTPUTS; i++){
-        LabelPosteriorsText[CHANNEL_1][i] = "\u03B4" + to_string(i+1);
-        LabelPosteriorsText[CHANNEL_2][i] = "\u03B4\'" + to_string(i+1);
-        LabelPosteriorsText[CHANNEL_3][i] = "\u03B4\'" + to_string(i+1);
-    }
 
     // Define anchors
     AnchorPosterior = {10, 480};
@@ -25,18 +20,6 @@ GuiPosteriors::GuiPosteriors(){
     ScrollPanelPosteriorsScrollOffset = {0, 0};
     ScrollPanelPosteriorsBoundsOffset = {0, 0};
 
-    for(int i = 0; i < MAX_CHANNEL_OUTPUTS; i++){
-        TextBoxOuterEditMode[i] = false;
-        strcpy(TextBoxOuterText[i], "0");
-    }
-
-    for(int i = 0; i < NUMBER_SECRETS; i++){
-        for(int j = 0; j < MAX_CHANNEL_OUTPUTS; j++){
-            TextBoxInnersEditMode[i][j] = false;
-            strcpy(TextBoxInnersText[i][j], "0");
-        }
-    }
-
     // Define controls rectangles
     recTitle = (Rectangle){AnchorPosterior.x, AnchorPosterior.y, 350, 20};
     recContent = (Rectangle){AnchorPosterior.x, AnchorPosterior.y + 20, 350, 285};
@@ -48,22 +31,16 @@ GuiPosteriors::GuiPosteriors(){
         recLabelX[i] = (Rectangle){AnchorPosterior.x + 40, AnchorPosterior.y + 125 + i*TEXTBOX_SIZE, 20, TEXTBOX_SIZE};
     }
     
-    for(int i = 0; i < MAX_CHANNEL_OUTPUTS; i++){
-        recLabelPosteriors[i] = (Rectangle){AnchorPosterior.x + 75 + i*TEXTBOX_SIZE, AnchorPosterior.y + 45, 20, 20};
-        recTextBoxOuter[i] = (Rectangle){AnchorPosterior.x + 65 + i*TEXTBOX_SIZE, AnchorPosterior.y + 65, TEXTBOX_SIZE, TEXTBOX_SIZE};
-    }
+    // Textboxes, labels and their rectangles
+    reserve(NUMBER_SECRETS);
+    text.invalidate();
 
-    for(int i = 0; i < NUMBER_SECRETS; i++){
-        for(int j = 0; j < MAX_CHANNEL_OUTPUTS; j++){
-            recTextBoxInners[i][j] = (Rectangle){AnchorPosterior.x + 65 + j*TEXTBOX_SIZE, AnchorPosterior.y + 125 + i*TEXTBOX_SIZE, TEXTBOX_SIZE, TEXTBOX_SIZE};
-        }
-    }
-
-    ScrollPanelPosteriorsContent.x = recTextBoxInners[0][2].x + TEXTBOX_SIZE;
+    ScrollPanelPosteriorsContent.x = recTextBoxInners(0, 2).x + TEXTBOX_SIZE;
 }
 
 void GuiPosteriors::resetPosterior(int channel){
     numPosteriors[channel] = NUMBER_SECRETS;
+    text.invalidate();
 
     for(int i = 0; i < NUMBER_SECRETS; i++){
         strcpy(TextBoxOuterText[i], "0");
@@ -73,6 +50,44 @@ void GuiPosteriors::resetPosterior(int channel){
     }
 }
 
+void GuiPosteriors::setNumPosteriors(int channel, int num){
+    reserve(num);
+    numPosteriors[channel] = num;
+}
+
+void GuiPosteriors::reserve(int num){
+    int reserved = (int)TextBoxOuterText.size();
+    if(num <= reserved)
+        return;
+
+    TextBoxInnersText.reserve(NUMBER_SECRETS, num, TEXT_ZERO);
+    TextBoxOuterText.resize(num, TEXT_ZERO);
+
+    for(int i = reserved; i < num; i++){
+        LabelPosteriorsText[CHANNEL_1].push_back("\u03B4" + to_string(i+1));
+        LabelPosteriorsText[CHANNEL_2].push_back("\u03B4\'" + to_string(i+1));
+        LabelPosteriorsText[CHANNEL_3].push_back("\u03B4\'" + to_string(i+1));
+    }
+}
+
+Rectangle GuiPosteriors::recLabelPosteriors(int j){
+    return (Rectangle){AnchorPosterior.x + 75 + j*TEXTBOX_SIZE, AnchorPosterior.y + 45, 20, 20};
+}
+
+Rectangle GuiPosteriors::recTextBoxOuter(int j){
+    return (Rectangle){AnchorPosterior.x + 65 + j*TEXTBOX_SIZE, AnchorPosterior.y + 65, TEXTBOX_SIZE, TEXTBOX_SIZE};
+}
+
+Rectangle GuiPosteriors::recTextBoxInners(int i, int j){
+    return (Rectangle){AnchorPosterior.x + 65 + j*TEXTBOX_SIZE, AnchorPosterior.y + 125 + i*TEXTBOX_SIZE, TEXTBOX_SIZE, TEXTBOX_SIZE};
+}
+
+GridRange GuiPosteriors::visibleTextBoxes(Rectangle view, int channel){
+    Rectangle origin = recTextBoxInners(0, 0);
+    return visibleRange(view.x, view.y, view.width, view.height, origin.x + ScrollPanelPosteriorsScrollOffset.x, origin.y + ScrollPanelPosteriorsScrollOffset.y,
+                        TEXTBOX_SIZE, NUMBER_SECRETS, numPosteriors[channel]);
+}
+
 void GuiPosteriors::setScrollContent(int channel){
-    ScrollPanelPosteriorsContent.x = recTextBoxInners[0][numPosteriors[channel]-1].x - 10 + TEXTBOX_SIZE;
+    ScrollPanelPosteriorsContent.x = recTextBoxInners(0, numPosteriors[channel]-1).x - 10 + TEXTBOX_SIZE;
 }
\ No newline at end of file
@@ -24,7 +24,7 @@ public:
     // Const text
     char GroupBoxPosteriorsText[CHAR_BUFFER_SIZE];
     char LabelOuterText[CHAR_BUFFER_SIZE];
-    string LabelPosteriorsText[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS];
+    vector<string> LabelPosteriorsText[NUMBER_CHANNELS];
     string LabelPosteriorsXText[NUMBER_SECRETS];
 
     // Define anchors
@@ -34,21 +34,16 @@ public:
     Vector2 ScrollPanelPosteriorsScrollOffset;
     Vector2 ScrollPanelPosteriorsBoundsOffset;
     Vector2 ScrollPanelPosteriorsContent;
-    bool TextBoxOuterEditMode[MAX_CHANNEL_OUTPUTS];
-    char TextBoxOuterText[MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE];
-
-    bool TextBoxInnersEditMode[NUMBER_SECRETS][MAX_CHANNEL_OUTPUTS];
-    char TextBoxInnersText[NUMBER_SECRETS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE];
+    vector<TextCell> TextBoxOuterText;
+    TextGrid TextBoxInnersText;
+    TextCache text;     // Channel and hyper version the outer and inners textboxes were written from
 
     // Define controls rectangles
     Rectangle recTitle;
     Rectangle recContent;
     Rectangle recScrollPanel;
     Rectangle recLabelOuter;
-    Rectangle recLabelPosteriors[MAX_CHANNEL_OUTPUTS];
-    Rectangle recTextBoxOuter[MAX_CHANNEL_OUTPUTS];
     Rectangle recLabelX[NUMBER_SECRETS];
-    Rectangle recTextBoxInners[NUMBER_SECRETS][MAX_CHANNEL_OUTPUTS];
 
     //------------------------------------------------------------------------------------
     // Methods
@@ -57,6 +52,22 @@ public:
     // Reset the number of posterior to 3 and fill with zeros
     void resetPosterior(int channel);
 
+    // Set the number of posteriors of a channel, making room for their textboxes and labels
+    void setNumPosteriors(int channel, int num);
+
+    // Make room for the textboxes and labels of num posteriors. New textboxes are "0".
+    void reserve(int num);
+
+    /* Rectangles of the label and the textboxes of posterior j, without the scroll offset.
+       Posteriors are laid out in columns of the same width, so their rectangles are not stored. */
+    Rectangle recLabelPosteriors(int j);
+    Rectangle recTextBoxOuter(int j);
+    Rectangle recTextBoxInners(int i, int j);
+
+    /* Secrets (rows) and posteriors (columns) of a channel that intersect the scroll panel view.
+       Only these textboxes are drawn. */
+    GridRange visibleTextBoxes(Rectangle view, int channel);
+
     // Set right scroll bounds for a given channel
     void setScrollContent(int channel);
 };
@@ -20,6 +20,17 @@ GuiVisualization::GuiVisualization(){
     recPanelVisualization = (Rectangle){AnchorVisualization.x + 10, AnchorVisualization.y + 82, 710, 658};
     recCheckboxShowLabels = (Rectangle){recPanelVisualization.x + 10, recPanelVisualization.y + 10, 20, 20};
     recCheckboxShowConvexHull = (Rectangle){recCheckboxShowLabels.x, recCheckboxShowLabels.y + 30, 20, 20};
+    recCheckboxShowPriorCloud = (Rectangle){recCheckboxShowLabels.x, recCheckboxShowConvexHull.y + 30, 20, 20};
+    recCheckboxShowVulnerability = (Rectangle){recCheckboxShowLabels.x, recCheckboxShowPriorCloud.y + 30, 20, 20};
+    recCheckboxShowLeakage = (Rectangle){recCheckboxShowLabels.x, recCheckboxShowVulnerability.y + 30, 20, 20};
+    recLabelHeatmap = (Rectangle){recCheckboxShowLabels.x, recPanelVisualization.y + recPanelVisualization.height - 30, 300, 20};
+
+    cloudTexture = (Texture2D){ 0 };
+    cloudTextureGeneration = 0;
+    heatmapTexture = (Texture2D){ 0 };
+    heatmapTextureGeneration = 0;
+    heatmapTextureLevel = -1;
+    strcpy(LabelHeatmapText, "");
 
     float trianglePaddingX = 40;        // PanelVisualization padding in x axis
     float triangleSide = recPanelVisualization.width - 2*trianglePaddingX;
@@ -33,6 +44,9 @@ GuiVisualization::GuiVisualization(){
     strcpy(LabelPriorCircleText, "\u03C0"); // pi symbol &#x3c0;   \u3c0 
     strcpy(LabelCheckboxShowLabel, "Show labels");
     strcpy(LabelCheckboxShowConvexHull, "Show convex hull");
+    strcpy(LabelCheckboxShowPriorCloud, "Show prior cloud");
+    strcpy(LabelCheckboxShowVulnerability, "Show posterior vulnerability");
+    strcpy(LabelCheckboxShowLeakage, "Show multiplicative leakage");
 
     for(int i = 0; i < 3; i++){
         LabelTriangleText[i] = "X" + to_string(i+1);
@@ -41,3 +55,64 @@ GuiVisualization::GuiVisualization(){
     recLabelTriangle[1] = (Rectangle){trianglePoints[1].x - 35, trianglePoints[1].y -  2, 40, 40};        
     recLabelTriangle[2] = (Rectangle){trianglePoints[2].x +  5, trianglePoints[2].y -  2, 40, 40};
 }
+
+void GuiVisualization::drawTriangle(Renderer &renderer, const HeatmapImage &heatmap, Font font, Font fontBig){
+    renderer.triangle(trianglePoints[0], trianglePoints[1], trianglePoints[2], BG_BASE_COLOR_LIGHT2);
+    if(heatmap.level >= 0 && heatmapTexture.id != 0){
+        renderer.texture(heatmapTexture, (Vector2){heatmap.area.x, heatmap.area.y}, heatmap.cell, WHITE);
+        renderer.text(font, LabelHeatmapText, (Vector2){recLabelHeatmap.x, recLabelHeatmap.y}, 20, 1.0, BLACK);
+    }
+    renderer.triangleLines(trianglePoints[0], trianglePoints[1], trianglePoints[2], BLACK);
+    for(int i = 0; i < NUMBER_SECRETS; i++){
+        renderer.text(fontBig, &(LabelTriangleText[i][0]), (Vector2){recLabelTriangle[i].x, recLabelTriangle[i].y}, 32, 0, BLACK);
+    }
+}
+
+void GuiVisualization::drawPriorCloud(Renderer &renderer, const PriorCloudImage &cloud){
+    if(cloud.generation == 0 || cloudTexture.id == 0)
+        return;
+    renderer.texture(cloudTexture, (Vector2){cloud.area.x, cloud.area.y}, PRIOR_CLOUD_CELL, WHITE);
+}
+
+void GuiVisualization::drawCirclePrior(Renderer &renderer, const Circle &prior, bool showLabels, Font fontBig){
+    Vector2 center = {(float)prior.center.x, (float)prior.center.y};
+    renderer.circle(center, prior.radius, PRIOR_COLOR);
+    renderer.circleLines(center, prior.radius, PRIOR_COLOR_LINES);
+    if(showLabels) renderer.text(fontBig, LabelPriorCircleText, (Vector2) {recLabelPriorCircle.x, recLabelPriorCircle.y}, fontBig.baseSize, 1.0, BLACK);
+}
+
+void GuiVisualization::drawCirclesInners(Renderer &renderer, int channel, const vector<Circle> &circles, int numPosteriors, unsigned long version,
+                                         const vector<pt> *hull, const Distribution &outer, const vector<string> *labels, Font fontBig){
+    Color colorFill, colorLines, colorHull;
+    if(channel == CHANNEL_1){
+        colorFill = INNERS1_COLOR;
+        colorLines = INNERS1_COLOR_LINES;
+        colorHull = CH1_COLOR;
+    }else{
+        colorFill = INNERS2_COLOR;
+        colorLines = INNERS2_COLOR_LINES;
+        colorHull = CH2_COLOR;
+    }
+
+    // Circles and hull are tessellated again only when they move
+    CircleBatch &batch = innersBatch[channel];
+    if(batch.needsBuild(version, hull != NULL))
+        batch.build(circles, numPosteriors, hull, version);
+    batch.draw(renderer, colorFill, colorLines, colorHull, hull != NULL);
+
+    if(labels != NULL){
+        // Decide to write label inside or outside the circle
+        float threshold;
+        if(channel == CHANNEL_1)
+            threshold = 0.13f;
+        else
+            threshold = 0.20f;
+
+        for(int i = 0; i < numPosteriors; i++){
+            if(outer.prob[i] < threshold)
+                renderer.text(fontBig, &((*labels)[i][0]), (Vector2) {recLabelInnersCircles[channel][i].x-25, recLabelInnersCircles[channel][i].y-25}, 26, 1.0, BLACK);
+            else
+                renderer.text(fontBig, &((*labels)[i][0]), (Vector2) {recLabelInnersCircles[channel][i].x-5, recLabelInnersCircles[channel][i].y-5}, 26, 1.0, BLACK);
+        }
+    }
+}
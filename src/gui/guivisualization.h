@@ -3,6 +3,10 @@
 
 #include "../../libs/raylib/src/raylib.h"
 #include "../graphics.h"
+#include "../circlebatch.h"
+#include "../renderer.h"
+#include "../heatmap.h"
+#include "../priorcloud.h"
 #include <string.h>
 #include <string>
 #include <vector>
@@ -41,10 +45,25 @@ public:
     Rectangle recTextBoxStatus;
     Rectangle recPanelVisualization;
     Rectangle recLabelPriorCircle;
-    Rectangle recLabelInnersCircles[NUMBER_CHANNELS][MAX_CHANNEL_OUTPUTS];
+    vector<Rectangle> recLabelInnersCircles[NUMBER_CHANNELS];
+    CircleBatch innersBatch[NUMBER_CHANNELS];	// Vertices of the inners circles and hull of each channel
     Rectangle recLabelTriangle[3];
     Rectangle recCheckboxShowLabels;
     Rectangle recCheckboxShowConvexHull;
+    Rectangle recCheckboxShowPriorCloud;
+    Rectangle recCheckboxShowVulnerability;
+    Rectangle recCheckboxShowLeakage;
+    Rectangle recLabelHeatmap;
+
+    // Density image of the prior cloud, uploaded only when the worker finishes a new one
+    Texture2D cloudTexture;
+    unsigned long cloudTextureGeneration;
+
+    // Current level of the heatmap, uploaded only when the worker finishes a new one
+    Texture2D heatmapTexture;
+    unsigned long heatmapTextureGeneration;
+    int heatmapTextureLevel;
+    char LabelHeatmapText[CHAR_BUFFER_SIZE];    // Measure and range of the values of the heatmap
 
     /* Triangle vertices
      *       v0
@@ -56,6 +75,29 @@ public:
     string LabelTriangleText[3];
     char LabelCheckboxShowLabel[CHAR_BUFFER_SIZE];
     char LabelCheckboxShowConvexHull[CHAR_BUFFER_SIZE];
+    char LabelCheckboxShowPriorCloud[CHAR_BUFFER_SIZE];
+    char LabelCheckboxShowVulnerability[CHAR_BUFFER_SIZE];
+    char LabelCheckboxShowLeakage[CHAR_BUFFER_SIZE];
+
+    //------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+    /* Drawing of the visualization that does not use raygui, shared by qif-graphics and bench-render.
+       The heatmap and the cloud are drawn from heatmapTexture and cloudTexture, which the app uploads. */
+
+    // Triangle, with the heatmap (if it has a level) between its background and its edges, and the labels of its vertices
+    void drawTriangle(Renderer &renderer, const HeatmapImage &heatmap, Font font, Font fontBig);
+
+    // Density image of the prior cloud, if there is one
+    void drawPriorCloud(Renderer &renderer, const PriorCloudImage &cloud);
+
+    void drawCirclePrior(Renderer &renderer, const Circle &prior, bool showLabels, Font fontBig);
+
+    /* Inners circles of a channel, from the CircleBatch of the channel, which is built again only when 'version'
+       changes. 'hull' (in hull order) is NULL if the hull is not shown, and 'labels' is NULL if the labels are not shown. */
+    void drawCirclesInners(Renderer &renderer, int channel, const vector<Circle> &circles, int numPosteriors, unsigned long version,
+                           const vector<pt> *hull, const Distribution &outer, const vector<string> *labels, Font fontBig);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "heatmap.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// Offsets (in texels) of the points of a texel tested to know how much of it is inside the triangle
+static const float coverageSamples[4][2] = {{0.25f, 0.25f}, {0.75f, 0.25f}, {0.25f, 0.75f}, {0.75f, 0.75f}};
+
+// Distribution of a pixel of the triangle, as bary2Dist gives it. Returns true if it is inside the triangle.
+static bool pixel2Dist(float x, float y, const Vector2 trianglePoints[3], float prob[NUMBER_SECRETS]){
+    float bx = (x - trianglePoints[1].x) / (trianglePoints[2].x - trianglePoints[1].x);
+    float by = (trianglePoints[1].y - y) / (trianglePoints[1].y - trianglePoints[0].y);
+    prob[0] = by;
+    prob[1] = 1 - bx - by/2;
+    prob[2] = bx - by/2;
+    return prob[0] >= 0 && prob[1] >= 0 && prob[2] >= 0;
+}
+
+static Color lerpColor(Color a, Color b, float t){
+    return (Color){
+        (unsigned char)(a.r + (b.r - a.r)*t),
+        (unsigned char)(a.g + (b.g - a.g)*t),
+        (unsigned char)(a.b + (b.b - a.b)*t),
+        (unsigned char)(a.a + (b.a - a.a)*t)
+    };
+}
+
+void HeatmapTask::startLevel(const HeatmapJob &job, HeatmapImage &image){
+    image.channel = job.channel;
+    image.source = job.source;
+    image.measure = job.measure;
+    image.level = level;
+
+    const Vector2 *t = job.trianglePoints;
+    image.cell = (float)(HEATMAP_FINEST_CELL << (HEATMAP_LEVELS - 1 - level));
+    image.area = (Rectangle){t[1].x, t[0].y, t[2].x - t[1].x, t[1].y - t[0].y};
+    image.width = (int)ceilf(image.area.width / image.cell);
+    image.height = (int)ceilf(image.area.height / image.cell);
+
+    long texels = (long)image.width*image.height;
+    image.values.resize(texels);
+    image.coverage.resize(texels);
+    image.pixels.resize(texels);
+    rowMin.resize(image.height);
+    rowMax.resize(image.height);
+}
+
+void HeatmapTask::computeRow(const HeatmapJob &job, HeatmapImage &image, int row){
+    int groups = map.numPosteriors;
+    const Real *c[NUMBER_SECRETS];
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        c[i] = map.coefficients.data() + (long)i*groups;
+
+    float *values = image.values.data() + (long)row*image.width;
+    float *coverage = image.coverage.data() + (long)row*image.width;
+    float low = FLT_MAX, high = -FLT_MAX;
+
+    for(int col = 0; col < image.width; col++){
+        float prob[NUMBER_SECRETS];
+        int inside = 0;
+        for(int s = 0; s < 4; s++){
+            float x = image.area.x + (col + coverageSamples[s][0]) * image.cell;
+            float y = image.area.y + (row + coverageSamples[s][1]) * image.cell;
+            inside += pixel2Dist(x, y, job.trianglePoints, prob);
+        }
+        coverage[col] = inside / 4.0f;
+
+        // The center of a texel crossed by an edge can be out of the triangle, its closest prior is used
+        pixel2Dist(image.area.x + (col + 0.5f) * image.cell, image.area.y + (row + 0.5f) * image.cell, job.trianglePoints, prob);
+        Real p[NUMBER_SECRETS], sum = 0;
+        for(int i = 0; i < NUMBER_SECRETS; i++){
+            p[i] = max(prob[i], 0.0f);
+            sum += p[i];
+        }
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            p[i] /= sum;
+
+        Real posterior = 0;
+        for(int g = 0; g < groups; g++)
+            posterior += max(max(p[0] * c[0][g], p[1] * c[1][g]), p[2] * c[2][g]);
+
+        float value = (float)posterior;
+        if(job.measure == HEATMAP_LEAKAGE)
+            value = (float)(posterior / max(max(p[0], p[1]), p[2]));
+        values[col] = value;
+
+        if(inside > 0){
+            low = min(low, value);
+            high = max(high, value);
+        }
+    }
+
+    rowMin[row] = low;
+    rowMax[row] = high;
+}
+
+void HeatmapTask::finishLevel(HeatmapImage &image){
+    image.minValue = FLT_MAX;
+    image.maxValue = -FLT_MAX;
+    for(int row = 0; row < image.height; row++){
+        image.minValue = min(image.minValue, rowMin[row]);
+        image.maxValue = max(image.maxValue, rowMax[row]);
+    }
+
+    float range = image.maxValue - image.minValue;
+    long texels = (long)image.width*image.height;
+    for(long k = 0; k < texels; k++){
+        float t = range > 0 ? (image.values[k] - image.minValue) / range : 0;
+        t = min(max(t, 0.0f), 1.0f);
+        Color color = t < 0.5f ? lerpColor(HEATMAP_COLOR_LOW, HEATMAP_COLOR_MID, 2*t) : lerpColor(HEATMAP_COLOR_MID, HEATMAP_COLOR_HIGH, 2*t - 1);
+        color.a = (unsigned char)(color.a * image.coverage[k]);
+        image.pixels[k] = color;
+    }
+}
+
+void HeatmapTask::start(HeatmapJob &job, HeatmapImage &image){
+    map.build(job.matrix);
+    level = 0;
+    row = 0;
+}
+
+int HeatmapTask::step(HeatmapJob &job, HeatmapImage &image){
+    if(row == 0)
+        startLevel(job, image);
+
+    // A band of rows per step, so a newer job does not wait for a whole level
+    ThreadPool &pool = ThreadPool::shared();
+    int rows = min(image.height - row, HEATMAP_STEP_ROWS * pool.size());
+    pool.parallelFor(rows, [&](int k, int worker){
+        computeRow(job, image, row + k);
+    });
+    row += rows;
+    if(row < image.height)
+        return TASK_CONTINUE;
+
+    finishLevel(image);
+    row = 0;
+    return ++level < HEATMAP_LEVELS ? TASK_PUBLISH : TASK_DONE;
+}
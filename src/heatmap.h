@@ -0,0 +1,92 @@
+#ifndef _heatmap
+#define _heatmap
+
+#include "graphics.h"
+#include "posteriormap.h"
+#include "threadpool.h"
+#include "latestjobworker.h"
+
+using namespace std;
+
+// Measures shown by the heatmap
+#define HEATMAP_NONE 0
+#define HEATMAP_VULNERABILITY 1		// Posterior Bayes vulnerability
+#define HEATMAP_LEAKAGE 2			// Multiplicative Bayes leakage (posterior over prior vulnerability)
+
+// Resolutions computed for a job, from a texel of HEATMAP_FINEST_CELL << (HEATMAP_LEVELS-1) pixels to one of HEATMAP_FINEST_CELL
+#define HEATMAP_LEVELS 4
+#define HEATMAP_FINEST_CELL 2
+
+// Time (in milliseconds) a frame can spend in the heatmap when there are no threads
+#define HEATMAP_SLICE_MS 4
+
+// Rows of a level computed by each worker of the pool in a step
+#define HEATMAP_STEP_ROWS 4
+
+// Colors of the lowest, middle and highest values. The alpha is the one of a texel inside the triangle.
+#define HEATMAP_COLOR_LOW CLITERAL(Color){68, 1, 84, 130}
+#define HEATMAP_COLOR_MID CLITERAL(Color){33, 145, 140, 130}
+#define HEATMAP_COLOR_HIGH CLITERAL(Color){253, 231, 37, 130}
+
+/* Snapshot of the inputs of a heatmap. */
+typedef struct HeatmapJob{
+	unsigned long generation;	// Set by submit()
+	int channel;				// Channel the matrix is taken from
+	unsigned long source;		// Version of the matrix of the channel (Data::matrixVersion), given back in the images
+	int measure;				// HEATMAP_VULNERABILITY or HEATMAP_LEAKAGE
+	Matrix matrix;				// NUMBER_SECRETS x m channel
+	Vector2 trianglePoints[3];
+} HeatmapJob;
+
+/* A level of a heatmap: the measure at the center of each texel of the bounding box of the triangle. */
+typedef struct HeatmapImage{
+	unsigned long generation;	// Generation of the job
+	int channel;
+	unsigned long source;
+	int measure;
+	int level;					// 0 is the coarsest, HEATMAP_LEVELS-1 the finest. -1 if there is no image.
+	Rectangle area;				// Pixels of the visualization covered by the image (from its top left corner)
+	float cell;					// Pixels covered by a texel
+	int width;					// Size of the image, in texels
+	int height;
+	vector<float> values;		// width x height, row-major
+	vector<float> coverage;		// Fraction of each texel inside the triangle
+	vector<Color> pixels;		// Values colored between minValue and maxValue
+	float minValue;				// Range of the values of the texels inside the triangle
+	float maxValue;
+} HeatmapImage;
+
+/* Computes the heatmap of a channel over the whole triangle out of the frame, with a LatestJobWorker.
+ *
+ * The measure does not depend on the prior being shown, only on the channel, so a
+ * heatmap is computed once per version of the channel and moving the prior costs
+ * nothing. It is computed at HEATMAP_LEVELS resolutions, the coarsest first, and
+ * each level is published as soon as it is finished, so the heatmap appears at
+ * once and is refined while the interface keeps running. Each step computes a band
+ * of rows of a level with the workers of ThreadPool::shared(), so a newer job
+ * stops this one at the end of a band.
+ *
+ * The posterior vulnerability of a prior p is sum_g max_i p_i C_ig over the groups of
+ * proportional columns of the channel (see PosteriorMap), because proportional columns
+ * have their maximum at the same secret. Texels crossed by the edges of the triangle
+ * take the value of the closest prior and are faded by the fraction they cover. */
+class HeatmapTask{
+public:
+	void start(HeatmapJob &job, HeatmapImage &image);
+	int step(HeatmapJob &job, HeatmapImage &image);
+
+private:
+	PosteriorMap map;			// Groups of columns of the channel of the job
+	int level;					// Level being computed
+	int row;					// Next row of the level
+	vector<float> rowMin;		// Range of the values of each row of the level
+	vector<float> rowMax;
+
+	void startLevel(const HeatmapJob &job, HeatmapImage &image);
+	void computeRow(const HeatmapJob &job, HeatmapImage &image, int row);
+	void finishLevel(HeatmapImage &image);
+};
+
+typedef LatestJobWorker<HeatmapJob, HeatmapImage, HeatmapTask, HEATMAP_SLICE_MS> HeatmapWorker;
+
+#endif
@@ -0,0 +1,108 @@
+#include "hypercache.h"
+
+HyperCache::HyperCache(){
+    numSecrets = 0;
+    numGroups = 0;
+    built = false;
+    hasPrior = false;
+}
+
+void HyperCache::build(const Matrix &channel){
+    numSecrets = channel.rows;
+    numGroups = 0;
+
+    // Normalized representative of each group, used to compare columns
+    vector<long double> representatives;
+    vector<int> columnGroup(channel.cols, -1);
+
+    for(int j = 0; j < channel.cols; j++){
+        long double sum = 0;
+        for(int i = 0; i < numSecrets; i++)
+            sum += channel(i, j);
+
+        // A zero column never generates a posterior
+        if(sum <= 0) continue;
+
+        int g;
+        for(g = 0; g < numGroups; g++){
+            bool equal = true;
+            for(int i = 0; i < numSecrets && equal; i++)
+                equal = fabsl(representatives[g*numSecrets+i] - channel(i, j)/sum) <= COLUMN_EPSILON;
+            if(equal) break;
+        }
+
+        if(g == numGroups){
+            for(int i = 0; i < numSecrets; i++)
+                representatives.push_back(channel(i, j)/sum);
+            numGroups++;
+        }
+        columnGroup[j] = g;
+    }
+
+    // Sum the columns of each group. Posteriors keep the order of the first column of each group.
+    groups.assign(numSecrets*numGroups, 0);
+    for(int j = 0; j < channel.cols; j++){
+        if(columnGroup[j] < 0) continue;
+        for(int i = 0; i < numSecrets; i++)
+            groups[i*numGroups + columnGroup[j]] += channel(i, j);
+    }
+
+    built = true;
+    hasPrior = false;
+}
+
+void HyperCache::invalidate(){
+    built = false;
+    hasPrior = false;
+}
+
+bool HyperCache::update(Point bary, Distribution &prior, Hyper &hyper){
+    if(hasPrior && bary.x == lastPrior.x && bary.y == lastPrior.y)
+        return false;
+
+    lastPrior = bary;
+    hasPrior = true;
+
+    // Posteriors can only be merged or removed in a different way when some secret has probability 0
+    bool fullSupport = built && prior.num_el == numSecrets;
+    for(int i = 0; i < prior.num_el && fullSupport; i++)
+        fullSupport = prior.prob[i] > 0;
+
+    if(!fullSupport || numGroups == 0){
+        hyper.rebuildHyper(prior);
+        return true;
+    }
+
+    // Storage only changes if the previous hyper had a different number of posteriors
+    if(hyper.num_post != numGroups || (int)hyper.outer.prob.size() != numGroups || (int)hyper.inners.size() != numSecrets){
+        hyper.num_post = numGroups;
+        hyper.outer.num_el = numGroups;
+        hyper.outer.prob.resize(numGroups);
+        hyper.inners.resize(numSecrets);
+        for(int i = 0; i < numSecrets; i++)
+            hyper.inners[i].resize(numGroups);
+    }
+
+    // The prior is copied in place, so dragging does not allocate
+    if(hyper.prior.num_el != prior.num_el || hyper.channel.prior.num_el != prior.num_el){
+        hyper.prior = prior;
+        hyper.channel.prior = prior;
+    }else{
+        for(int i = 0; i < prior.num_el; i++){
+            hyper.prior.prob[i] = prior.prob[i];
+            hyper.channel.prior.prob[i] = prior.prob[i];
+        }
+    }
+
+    for(int g = 0; g < numGroups; g++){
+        long double outer = 0;
+        for(int i = 0; i < numSecrets; i++)
+            outer += prior.prob[i] * groups[i*numGroups + g];
+
+        hyper.outer.prob[g] = outer;
+        for(int i = 0; i < numSecrets; i++)
+            hyper.inners[i][g] = prior.prob[i] * groups[i*numGroups + g] / outer;
+    }
+
+    return true;
+}
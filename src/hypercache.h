@@ -0,0 +1,56 @@
+#ifndef _hypercache
+#define _hypercache
+
+#include "graphics.h"
+
+// Two normalized columns closer than this are considered the same posterior
+#define COLUMN_EPSILON 1e-12
+
+/* Cached column structure of a channel used to update a hyper-distribution while
+ * the prior is being dragged.
+ *
+ * For a prior with full support, two columns that are proportional always give the
+ * same posterior, and a zero column never gives one. Both facts do not depend on the
+ * prior, so proportional columns are merged once in build() and update() only has to
+ * compute the outer and the inners of each group in the storage that the hyper
+ * already owns. */
+class HyperCache{
+public:
+	HyperCache();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	int numSecrets;
+	int numGroups;				// Number of distinct posteriors for a full support prior
+	vector<long double> groups;	// numSecrets x numGroups, row-major. Sum of the columns of each group.
+	bool built;					// Flag that indicates wheter build() has been called for the current channel
+	bool hasPrior;				// Flag that indicates wheter lastPrior holds a valid value
+	Point lastPrior;			// Barycentric coordinate of the prior used in the last update
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Group the columns of a channel matrix. It must be called every time the channel changes. */
+	void build(const Matrix &channel);
+
+	/* Forget the cached structure. update() falls back to Hyper::rebuildHyper until build() is called again. */
+	void invalidate();
+
+	/* Recompute outer and inners of a hyper-distribution for a new prior, and set the new prior in
+	 * hyper.prior and hyper.channel.prior, as Hyper::rebuildHyper does. The joint matrix and the labels
+	 * of the hyper are not computed (nothing in qif-graphics reads them).
+	 * Parameters:
+	 *		bary:  Barycentric coordinate of the new prior
+	 *		prior: The new prior distribution
+	 *		hyper: Hyper-distribution built from the same channel given to build()
+	 *
+	 * Return: false if the prior is the same used in the previous call (nothing is done)
+	 *		   or true if the hyper-distribution was updated.
+	 */
+	bool update(Point bary, Distribution &prior, Hyper &hyper);
+};
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef _latestjobworker
+#define _latestjobworker
+
+#include <chrono>
+#include <utility>
+
+#if !defined(PLATFORM_WEB)
+	#include <thread>
+	#include <mutex>
+	#include <condition_variable>
+	#include <atomic>
+#endif
+
+using namespace std;
+
+// What a step of a task leaves in the result
+#define TASK_CONTINUE 0		// Nothing to take yet, the task has more steps
+#define TASK_PUBLISH 1		// A partial result to take, the task has more steps
+#define TASK_DONE 2			// The final result to take, the task is finished
+
+/* Runs the last submitted job out of the frame.
+ *
+ * The work is done by a Task, which splits a job into steps:
+ *
+ *      void start(Job &job, Result &result)    Called before the first step of a job
+ *      int step(Job &job, Result &result)      Advance the job, returns TASK_CONTINUE, TASK_PUBLISH or TASK_DONE
+ *
+ * Job and Result have an 'unsigned long generation', set by the worker, so a result
+ * tells which job it comes from.
+ *
+ * Only the last submitted job matters: submitting a job cancels the previous one, which
+ * stops at the end of its current step. Results are handed over with two buffers, the
+ * task fills one while the other waits to be taken by poll(), and they are swapped, never
+ * copied. After a result is published the task goes on writing into the other buffer, so
+ * every step that publishes must fill its result again. A result that was not taken yet
+ * is replaced by the next one.
+ *
+ * The web build has no threads, so poll() runs steps in the caller thread until SliceMs
+ * milliseconds have passed, and the job is finished along several frames. */
+template<typename Job, typename Result, typename Task, int SliceMs>
+class LatestJobWorker{
+public:
+	LatestJobWorker();
+	~LatestJobWorker();
+
+	/* Start computing a copy of 'job'. The previous job is cancelled. */
+	void submit(const Job &job);
+
+	/* Cancel the current job, if any. */
+	void cancel();
+
+	/* If the last submitted job published a result, swap it with 'result' and return true.
+	 * On the web it also advances the job. */
+	bool poll(Result &result);
+
+	/* Returns true if poll() has something to do: a result to take or, on the web, a job to advance. */
+	bool hasResult();
+
+private:
+	Task task;
+	Job job;					// Job being computed, owned by the worker
+	Result back;				// Result being written by the task
+
+#if !defined(PLATFORM_WEB)
+	thread worker;
+	mutex lock;
+	condition_variable wakeUp;	// Signals a new job or the destruction of the worker
+	Job next;					// Job submitted and not taken yet by the worker
+	bool hasNext;
+	Result front;				// Last published result, waiting for poll()
+	bool published;				// Flag that indicates wheter front holds a result not taken yet
+	atomic<unsigned long> generation;
+	bool stop;
+
+	void workerLoop();
+#else
+	unsigned long generation;
+	bool started;				// Flag that indicates wheter the task started the job
+	bool running;				// Flag that indicates wheter there is a job not finished
+#endif
+};
+
+#if !defined(PLATFORM_WEB)
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+LatestJobWorker<Job, Result, Task, SliceMs>::LatestJobWorker(){
+	hasNext = false;
+	published = false;
+	generation = 0;
+	stop = false;
+	worker = thread(&LatestJobWorker::workerLoop, this);
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+LatestJobWorker<Job, Result, Task, SliceMs>::~LatestJobWorker(){
+	{
+		unique_lock<mutex> guard(lock);
+		stop = true;
+		generation++;
+	}
+	wakeUp.notify_one();
+	worker.join();
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+void LatestJobWorker<Job, Result, Task, SliceMs>::submit(const Job &job){
+	{
+		unique_lock<mutex> guard(lock);
+		next = job;
+		next.generation = ++generation;
+		hasNext = true;
+	}
+	wakeUp.notify_one();
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+void LatestJobWorker<Job, Result, Task, SliceMs>::cancel(){
+	unique_lock<mutex> guard(lock);
+	generation++;
+	hasNext = false;
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+bool LatestJobWorker<Job, Result, Task, SliceMs>::poll(Result &result){
+	unique_lock<mutex> guard(lock);
+	if(!published || front.generation != generation)
+		return false;
+
+	swap(front, result);
+	published = false;
+	return true;
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+bool LatestJobWorker<Job, Result, Task, SliceMs>::hasResult(){
+	unique_lock<mutex> guard(lock);
+	return published && front.generation == generation;
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+void LatestJobWorker<Job, Result, Task, SliceMs>::workerLoop(){
+	while(true){
+		{
+			unique_lock<mutex> guard(lock);
+			wakeUp.wait(guard, [&]{ return stop || hasNext; });
+			if(stop) return;
+			swap(job, next);
+			hasNext = false;
+		}
+
+		back.generation = job.generation;
+		task.start(job, back);
+
+		// A newer job makes the rest of this one useless
+		int state = TASK_CONTINUE;
+		while(state != TASK_DONE && job.generation == generation){
+			state = task.step(job, back);
+			if(state == TASK_CONTINUE)
+				continue;
+
+			unique_lock<mutex> guard(lock);
+			if(job.generation == generation){
+				swap(back, front);
+				published = true;
+				back.generation = job.generation;
+			}
+		}
+	}
+}
+
+#else
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+LatestJobWorker<Job, Result, Task, SliceMs>::LatestJobWorker(){
+	generation = 0;
+	started = false;
+	running = false;
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+LatestJobWorker<Job, Result, Task, SliceMs>::~LatestJobWorker(){
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+void LatestJobWorker<Job, Result, Task, SliceMs>::submit(const Job &job){
+	this->job = job;
+	this->job.generation = ++generation;
+	started = false;
+	running = true;
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+void LatestJobWorker<Job, Result, Task, SliceMs>::cancel(){
+	generation++;
+	running = false;
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+bool LatestJobWorker<Job, Result, Task, SliceMs>::poll(Result &result){
+	if(!running)
+		return false;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	if(!started){
+		back.generation = job.generation;
+		task.start(job, back);
+		started = true;
+	}
+
+	// At least one step per frame, so a job always finishes
+	int state;
+	do{
+		state = task.step(job, back);
+	}while(state == TASK_CONTINUE && chrono::steady_clock::now() - start < chrono::milliseconds(SliceMs));
+
+	if(state == TASK_CONTINUE)
+		return false;
+
+	swap(back, result);
+	back.generation = job.generation;
+	running = state != TASK_DONE;
+	return true;
+}
+
+template<typename Job, typename Result, typename Task, int SliceMs>
+bool LatestJobWorker<Job, Result, Task, SliceMs>::hasResult(){
+	return running;
+}
+
+#endif
+
+#endif
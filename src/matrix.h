@@ -0,0 +1,106 @@
+#ifndef _matrix
+#define _matrix
+
+#include <vector>
+#include "precision.h"
+
+using namespace std;
+
+/* View of a row or a column of a FlatMatrix. It does not own memory, so it must
+ * not outlive the matrix nor be used after the matrix is resized. */
+template<typename T>
+class MatrixView{
+public:
+	T *ptr;
+	int size;
+	int stride;		// Distance (in elements) between two consecutive values
+
+	MatrixView(T *ptr, int size, int stride) : ptr(ptr), size(size), stride(stride) {}
+
+	T& operator[](int k) const { return ptr[(long)k*stride]; }
+};
+
+/* Dense matrix stored in a single contiguous row-major buffer.
+ *
+ * resize() keeps the buffer when the new size fits in the capacity already
+ * allocated, so a matrix reserved once with the largest size never allocates
+ * again. Rows are contiguous, which is the layout expected by composeKernel. */
+template<typename T>
+class FlatMatrix{
+public:
+	int rows;
+	int cols;
+	vector<T> values;	// rows x cols, row-major
+
+	FlatMatrix() : rows(0), cols(0) {}
+	FlatMatrix(int rows, int cols, T value = 0) : rows(rows), cols(cols), values((long)rows*cols, value) {}
+
+	T& operator()(int i, int j) { return values[(long)i*cols + j]; }
+	const T& operator()(int i, int j) const { return values[(long)i*cols + j]; }
+
+	T* data() { return values.data(); }
+	const T* data() const { return values.data(); }
+
+	T* row(int i) { return values.data() + (long)i*cols; }
+	const T* row(int i) const { return values.data() + (long)i*cols; }
+
+	MatrixView<T> rowView(int i) { return MatrixView<T>(row(i), cols, 1); }
+	MatrixView<T> columnView(int j) { return MatrixView<T>(values.data() + j, rows, cols); }
+
+	// Allocate memory for a rows x cols matrix without changing the current size
+	void reserve(int rows, int cols) { values.reserve((long)rows*cols); }
+
+	// Change the size of the matrix. The content is not preserved and new values are zero.
+	void resize(int rows, int cols){
+		this->rows = rows;
+		this->cols = cols;
+		values.assign((long)rows*cols, 0);
+	}
+
+	void fill(T value){
+		for(unsigned long k = 0; k < values.size(); k++)
+			values[k] = value;
+	}
+
+	bool operator==(const FlatMatrix<T> &other) const {
+		return rows == other.rows && cols == other.cols && values == other.values;
+	}
+
+	bool operator!=(const FlatMatrix<T> &other) const {
+		return !(*this == other);
+	}
+
+	// Returns true if both matrices have the same size and no values differ by more than 'tolerance'
+	bool near(const FlatMatrix<T> &other, T tolerance) const {
+		if(rows != other.rows || cols != other.cols) return false;
+		for(unsigned long k = 0; k < values.size(); k++)
+			if(values[k] - other.values[k] > tolerance || other.values[k] - values[k] > tolerance) return false;
+		return true;
+	}
+
+	// Copy from a matrix of nested vectors (i.e. Channel::matrix)
+	template<typename U>
+	void fromNested(const vector<vector<U>> &m){
+		resize((int)m.size(), m.empty() ? 0 : (int)m[0].size());
+		for(int i = 0; i < rows; i++)
+			for(int j = 0; j < cols; j++)
+				(*this)(i, j) = m[i][j];
+	}
+
+	/* Copy to a matrix of nested vectors, which is the format expected by libqif.
+	   Rows already allocated in 'm' are reused, so it does not allocate if 'm'
+	   already has this size. */
+	template<typename U>
+	void toNested(vector<vector<U>> &m) const {
+		m.resize(rows);
+		for(int i = 0; i < rows; i++){
+			m[i].resize(cols);
+			for(int j = 0; j < cols; j++)
+				m[i][j] = (*this)(i, j);
+		}
+	}
+};
+
+typedef FlatMatrix<Real> Matrix;
+
+#endif
@@ -0,0 +1,113 @@
+#include "numparse.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Powers of 10 that are exact in long double (5^27 fits in its 64-bit mantissa)
+#define NUMPARSE_MAX_POWER 27
+static const long double powers10[NUMPARSE_MAX_POWER+1] = {
+	1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,
+	1e10L, 1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L,
+	1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+};
+
+static inline bool available(const char *p, const char *end){
+	return p != end && *p != '\0';
+}
+
+static inline bool isDigit(char c){
+	return c >= '0' && c <= '9';
+}
+
+NumParseResult parseDecimal(const char *begin, const char *end, long double &value){
+	NumParseResult result = {begin, false};
+	const char *p = begin;
+	uint64_t mantissa = 0;
+	int digits = 0;		// Significant digits in mantissa
+	int exponent = 0;	// value = mantissa * 10^exponent
+	bool any = false;
+
+	// Integer part
+	for(; available(p, end) && isDigit(*p); p++){
+		any = true;
+		if(digits < NUMPARSE_DIGITS){
+			mantissa = 10*mantissa + (*p - '0');
+			if(mantissa != 0) digits++;
+		}else{
+			exponent++;
+		}
+	}
+
+	// Fractional part
+	if(available(p, end) && *p == '.'){
+		p++;
+		for(; available(p, end) && isDigit(*p); p++){
+			any = true;
+			if(digits < NUMPARSE_DIGITS){
+				mantissa = 10*mantissa + (*p - '0');
+				if(mantissa != 0) digits++;
+				exponent--;
+			}
+		}
+	}
+
+	// "." or an empty text
+	if(!any)
+		return result;
+
+	long double number = (long double)mantissa;
+	if(mantissa != 0){
+		// Only numbers with many leading zeros need more than one (rounded) step
+		for(; exponent < -NUMPARSE_MAX_POWER; exponent += NUMPARSE_MAX_POWER)
+			number /= powers10[NUMPARSE_MAX_POWER];
+		for(; exponent > NUMPARSE_MAX_POWER; exponent -= NUMPARSE_MAX_POWER)
+			number *= powers10[NUMPARSE_MAX_POWER];
+		if(exponent < 0) number /= powers10[-exponent];
+		else number *= powers10[exponent];
+	}
+
+	value = number;
+	result.ptr = p;
+	result.valid = true;
+	return result;
+}
+
+NumParseResult parseFraction(const char *begin, const char *end, long double &value){
+	long double numerator, denominator;
+	NumParseResult result = parseDecimal(begin, end, numerator);
+	if(!result.valid)
+		return result;
+
+	if(available(result.ptr, end) && *result.ptr == '/'){
+		NumParseResult second = parseDecimal(result.ptr + 1, end, denominator);
+		if(!second.valid || denominator == 0){
+			second.valid = false;
+			return second;
+		}
+
+		value = numerator / denominator;
+		return second;
+	}
+
+	value = numerator;
+	return result;
+}
+
+bool parseNumber(const char *begin, const char *end, long double &value){
+	long double number;
+	NumParseResult result = parseFraction(begin, end, number);
+	if(!result.valid || result.ptr != end)
+		return false;
+
+	value = number;
+	return true;
+}
+
+bool parseNumber(const char *text, long double &value){
+	long double number;
+	NumParseResult result = parseFraction(text, NULL, number);
+	if(!result.valid || *result.ptr != '\0')
+		return false;
+
+	value = number;
+	return true;
+}
@@ -0,0 +1,35 @@
+#ifndef _numparse
+#define _numparse
+
+/* Parser of the numbers typed in the prior and channel textboxes.
+ *
+ * Accepted text: a decimal number ("0.25", ".25", "1.") or a fraction of two
+ * decimal numbers ("1/4", "0.5/2"). Signs, exponents and blank spaces are not
+ * accepted. Characters are validated and converted in a single pass over the
+ * text, without copies, allocations, exceptions or locale lookups.
+ *
+ * The first NUMPARSE_DIGITS significant digits of a number are converted exactly
+ * to an integer and scaled once by a power of 10, so values typed with up to 19
+ * digits are as precise as strtold. Further digits are ignored.
+ */
+
+#define NUMPARSE_DIGITS 19
+
+typedef struct NumParseResult{
+	const char *ptr;	// First character that was not consumed
+	bool valid;			// Flag that indicates wheter a number was read
+} NumParseResult;
+
+/* Read a decimal number at the beginning of [begin, end). A null character also ends the text,
+ * so end can be NULL for a null-terminated text. 'value' is only changed if the number is valid. */
+NumParseResult parseDecimal(const char *begin, const char *end, long double &value);
+
+/* Same as parseDecimal, but also reads a fraction "a/b". A zero denominator is not valid. */
+NumParseResult parseFraction(const char *begin, const char *end, long double &value);
+
+/* Convert a whole text, given by the range [begin, end) or null-terminated, to a value.
+ * Returns: true if the text is a number or a fraction or false otherwise ('value' is not changed). */
+bool parseNumber(const char *begin, const char *end, long double &value);
+bool parseNumber(const char *text, long double &value);
+
+#endif
@@ -0,0 +1,72 @@
+#include "posteriormap.h"
+#include "hypercache.h"
+
+PosteriorMap::PosteriorMap(){
+    numSecrets = 0;
+    numPosteriors = 0;
+    built = false;
+}
+
+void PosteriorMap::build(const Matrix &channel){
+    // Same groups that HyperCache uses while the prior is dragged
+    HyperCache cache;
+    cache.build(channel);
+
+    numSecrets = cache.numSecrets;
+    numPosteriors = cache.numGroups;
+    coefficients.assign(cache.groups.begin(), cache.groups.end());
+    built = true;
+}
+
+void PosteriorMap::build(Channel &channel){
+    Matrix matrix;
+    matrix.fromNested(channel.matrix);
+    build(matrix);
+}
+
+// Priors [begin, end) of a batch. Every loop runs over contiguous values of consecutive priors.
+static void evaluateChunk(const PosteriorMap &map, const Real *priors, int begin, int end, PosteriorBatch &batch){
+    int count = batch.count;
+
+    for(int g = 0; g < map.numPosteriors; g++){
+        Real *outer = batch.outerOf(g);
+        for(int k = begin; k < end; k++)
+            outer[k] = 0;
+
+        for(int i = 0; i < map.numSecrets; i++){
+            Real c = map.coefficients[i*map.numPosteriors + g];
+            const Real *prior = priors + (long)i*count;
+            for(int k = begin; k < end; k++)
+                outer[k] += prior[k] * c;
+        }
+
+        // If the outer is 0 every term is 0, so dividing by 1 gives inners 0 without a branch
+        for(int i = 0; i < map.numSecrets; i++){
+            Real c = map.coefficients[i*map.numPosteriors + g];
+            const Real *prior = priors + (long)i*count;
+            Real *inner = batch.innerOf(i, g);
+            for(int k = begin; k < end; k++){
+                Real divisor = outer[k] > 0 ? outer[k] : 1;
+                inner[k] = prior[k] * c / divisor;
+            }
+        }
+    }
+}
+
+void PosteriorMap::evaluate(const Real *priors, int count, PosteriorBatch &batch, ThreadPool &pool){
+    batch.count = count;
+    batch.numSecrets = numSecrets;
+    batch.numPosteriors = built ? numPosteriors : 0;
+    batch.outer.resize((long)batch.numPosteriors*count);
+    batch.inners.resize((long)numSecrets*batch.numPosteriors*count);
+
+    if(batch.numPosteriors == 0)
+        return;
+
+    int numChunks = (count + POSTERIOR_MAP_CHUNK - 1) / POSTERIOR_MAP_CHUNK;
+    pool.parallelFor(numChunks, [&](int chunk, int worker){
+        int begin = chunk * POSTERIOR_MAP_CHUNK;
+        int end = min(count, begin + POSTERIOR_MAP_CHUNK);
+        evaluateChunk(*this, priors, begin, end, batch);
+    });
+}
@@ -0,0 +1,71 @@
+#ifndef _posteriormap
+#define _posteriormap
+
+#include "graphics.h"
+#include "threadpool.h"
+
+// Priors evaluated by each task given to the thread pool
+#define POSTERIOR_MAP_CHUNK 1024
+
+/* Outers and inners of a batch of priors, as a structure of arrays: the values of
+ * every prior for the same posterior (and secret) are contiguous. Prior k of the
+ * batch is at position k of every array. */
+typedef struct PosteriorBatch{
+	int count;				// Number of priors
+	int numPosteriors;
+	int numSecrets;
+	vector<Real> outer;		// numPosteriors x count
+	vector<Real> inners;	// numSecrets x numPosteriors x count
+
+	Real* outerOf(int g) { return outer.data() + (long)g*count; }
+	Real* innerOf(int i, int g) { return inners.data() + ((long)i*numPosteriors + g)*count; }
+}PosteriorBatch;
+
+/* Posteriors of a fixed channel as functions of the prior.
+ *
+ * For a prior p, the outer of the posterior of a group g of proportional columns is
+ * sum_i p_i C_ig and its inner is p_i C_ig / outer, where C_ig is the sum of the
+ * columns of the group. The groups do not depend on the prior (see HyperCache),
+ * so they are found once in build(), and evaluate() only does a few multiply-adds
+ * per posterior for each prior of a batch. The batch is split in chunks among the
+ * workers of a pool, and the loops over the priors of a chunk are vectorized.
+ *
+ * Posteriors are the groups of a full support prior and they are never merged for
+ * a particular prior, so every prior of a batch has the same posteriors in the same
+ * order. A posterior with outer 0 (all the secrets of its group have probability 0)
+ * has inners 0, and posteriors that become equal for a prior without full support
+ * are kept apart, while Hyper would merge them. */
+class PosteriorMap{
+public:
+	PosteriorMap();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	int numSecrets;
+	int numPosteriors;
+	vector<Real> coefficients;	// numSecrets x numPosteriors, row-major. Sum of the columns of each group.
+	bool built;					// Flag that indicates wheter build() has been called for the current channel
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Group the columns of a channel matrix. It must be called every time the channel changes. */
+	void build(const Matrix &channel);
+
+	/* Group the columns of the matrix of a libqif channel. Its prior is not used. */
+	void build(Channel &channel);
+
+	/* Compute the outer and the inners of a batch of priors.
+	 * Parameters:
+	 *		priors: numSecrets x count values, row-major: probability of secret i in prior k is priors[i*count + k]
+	 *		count:  Number of priors
+	 *		batch:  Result. Its memory is reused, it only grows when a larger batch is given.
+	 *		pool:   Workers that evaluate the chunks of the batch
+	 */
+	void evaluate(const Real *priors, int count, PosteriorBatch &batch, ThreadPool &pool);
+};
+
+#endif
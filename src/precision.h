@@ -0,0 +1,32 @@
+#ifndef _precision
+#define _precision
+
+#include <cfloat>
+
+// Values accepted by QIF_PRECISION (PRECISION in the Makefile)
+#define PRECISION_FLOAT 1
+#define PRECISION_DOUBLE 2
+#define PRECISION_LONG_DOUBLE 3
+
+#ifndef QIF_PRECISION
+	#define QIF_PRECISION PRECISION_DOUBLE
+#endif
+
+/* Scalar type of the numeric core (points, channel matrices, composition and
+ * mechanisms). long double is 80-bit x87 on x86 and emulated in WebAssembly,
+ * so it is not vectorized; double is precise enough for interactive use.
+ * libqif keeps long double, values are converted when they are handed to it. */
+#if QIF_PRECISION == PRECISION_FLOAT
+	typedef float Real;
+	#define REAL_NAME "float"
+#elif QIF_PRECISION == PRECISION_DOUBLE
+	typedef double Real;
+	#define REAL_NAME "double"
+#elif QIF_PRECISION == PRECISION_LONG_DOUBLE
+	typedef long double Real;
+	#define REAL_NAME "long double"
+#else
+	#error "QIF_PRECISION must be PRECISION_FLOAT, PRECISION_DOUBLE or PRECISION_LONG_DOUBLE"
+#endif
+
+#endif
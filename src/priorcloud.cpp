@@ -0,0 +1,267 @@
+#include "priorcloud.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+PriorCloud::PriorCloud(){
+    count = 0;
+    version = 0;
+    errorLine = 0;
+}
+
+void PriorCloud::sample(int count, Real alpha, unsigned int seed){
+    // Normalized independent Gamma(alpha, 1) variables follow a Dirichlet(alpha, ..., alpha) distribution
+    mt19937 generator(seed);
+    gamma_distribution<double> gamma((double)alpha, 1.0);
+
+    shared_ptr<vector<Real>> sampled = make_shared<vector<Real>>((long)NUMBER_SECRETS*count);
+    for(int k = 0; k < count; k++){
+        double x[NUMBER_SECRETS], sum = 0;
+        for(int i = 0; i < NUMBER_SECRETS; i++){
+            x[i] = gamma(generator);
+            sum += x[i];
+        }
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            (*sampled)[(long)i*count + k] = sum > 0 ? (Real)(x[i]/sum) : (Real)1/NUMBER_SECRETS;
+    }
+
+    this->count = count;
+    priors = sampled;
+    version++;
+}
+
+int PriorCloud::read(const char *fileName){
+    FILE *file = fopen(fileName, "rb");
+    if(file == NULL){
+        errorLine = 0;
+        return INVALID_PRIOR_CLOUD_FILE;
+    }
+
+    vector<char> data;
+    char buffer[4096];
+    long size;
+    while((size = (long)fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + size);
+    fclose(file);
+
+    return parse(data.data(), (long)data.size());
+}
+
+// Remove blank spaces (and the '\r' of Windows line endings) at both ends of [begin, end)
+static void trim(const char *&begin, const char *&end){
+    while(begin < end && isspace((unsigned char)*begin)) begin++;
+    while(end > begin && isspace((unsigned char)end[-1])) end--;
+}
+
+// Read the NUMBER_SECRETS comma separated values of a line. Returns false if it is not a prior.
+static bool parseLine(const char *begin, const char *end, long double prior[NUMBER_SECRETS]){
+    long double sum = 0;
+    for(int i = 0; i < NUMBER_SECRETS; i++){
+        const char *fieldEnd = begin;
+        while(fieldEnd < end && *fieldEnd != ',') fieldEnd++;
+
+        // The last value must end the line
+        if((i < NUMBER_SECRETS-1) != (fieldEnd < end))
+            return false;
+
+        const char *valueBegin = begin, *valueEnd = fieldEnd;
+        trim(valueBegin, valueEnd);
+        if(!parseNumber(valueBegin, valueEnd, prior[i]))
+            return false;
+        sum += prior[i];
+        begin = fieldEnd + 1;
+    }
+
+    // Values are not negative (signs are not accepted), so only the sum has to be checked
+    if(!(sum > 0))
+        return false;
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        prior[i] /= sum;
+    return true;
+}
+
+int PriorCloud::parse(const char *data, long size){
+    // Priors are read in the order of the file and transposed once at the end
+    vector<Real> rows;
+    const char *cur = data, *end = data + size;
+    int line = 0;
+    bool first = true;
+
+    while(cur < end){
+        const char *lineEnd = cur;
+        while(lineEnd < end && *lineEnd != '\n') lineEnd++;
+        line++;
+
+        const char *lineBegin = cur;
+        cur = lineEnd < end ? lineEnd + 1 : end;
+        trim(lineBegin, lineEnd);
+        if(lineBegin == lineEnd)
+            continue;
+
+        long double prior[NUMBER_SECRETS];
+        if(parseLine(lineBegin, lineEnd, prior)){
+            if((long)rows.size() >= (long)NUMBER_SECRETS*PRIOR_CLOUD_MAX){
+                errorLine = line;
+                return INVALID_PRIOR_CLOUD_FILE;
+            }
+            for(int i = 0; i < NUMBER_SECRETS; i++)
+                rows.push_back((Real)prior[i]);
+        }else if(!first){
+            // Only the first line can be a header
+            errorLine = line;
+            return INVALID_PRIOR_CLOUD_FILE;
+        }
+        first = false;
+    }
+
+    if(rows.empty()){
+        errorLine = line;
+        return INVALID_PRIOR_CLOUD_FILE;
+    }
+
+    count = (int)(rows.size() / NUMBER_SECRETS);
+    shared_ptr<vector<Real>> parsed = make_shared<vector<Real>>(rows.size());
+    for(int k = 0; k < count; k++)
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            (*parsed)[(long)i*count + k] = rows[(long)k*NUMBER_SECRETS + i];
+    priors = parsed;
+    version++;
+
+    return NO_ERROR;
+}
+
+PriorCloudTask::PriorCloudTask(){
+    for(int l = 0; l < 2; l++){
+        mapChannels[l] = -1;
+        mapSources[l] = 0;
+    }
+    layer = PRIOR_CLOUD_LAYERS;
+    next = 0;
+    x0 = y0 = sx = sy = 0;
+}
+
+void PriorCloudTask::start(PriorCloudJob &job, PriorCloudImage &image){
+    // Maps are only built again when their channel changes
+    for(int l = 0; l < 2; l++){
+        if(job.channels[l] < 0 || (job.channels[l] == mapChannels[l] && job.sources[l] == mapSources[l]))
+            continue;
+        map[l].build(job.matrix[l]);
+        mapChannels[l] = job.channels[l];
+        mapSources[l] = job.sources[l];
+    }
+
+    // Bounding box of the triangle with a texel of margin, so points on the edges are splatted whole
+    Vector2 *t = job.trianglePoints;
+    float edge = t[2].x - t[1].x;
+    float triangleHeight = t[1].y - t[0].y;
+    image.area = (Rectangle){t[1].x - PRIOR_CLOUD_CELL, t[0].y - PRIOR_CLOUD_CELL, edge + 2*PRIOR_CLOUD_CELL, triangleHeight + 2*PRIOR_CLOUD_CELL};
+    image.width = (int)ceilf(image.area.width / PRIOR_CLOUD_CELL) + 1;
+    image.height = (int)ceilf(image.area.height / PRIOR_CLOUD_CELL) + 1;
+
+    // Position in texels of a distribution, as dist2Bary and bary2Pixel place it
+    x0 = (t[1].x - image.area.x) / PRIOR_CLOUD_CELL;
+    y0 = (t[1].y - image.area.y) / PRIOR_CLOUD_CELL;
+    sx = edge / PRIOR_CLOUD_CELL;
+    sy = triangleHeight / PRIOR_CLOUD_CELL;
+
+    for(int l = 0; l < PRIOR_CLOUD_LAYERS; l++)
+        density[l].assign((long)image.width*image.height, 0);
+    layer = PRIOR_CLOUD_LAYER_PRIORS;
+    next = 0;
+}
+
+void PriorCloudTask::splat(const PriorCloudImage &image, int layer, float x, float y, float weight){
+    // Texel centers are at half units
+    x -= 0.5f;
+    y -= 0.5f;
+    int i = (int)floorf(x), j = (int)floorf(y);
+    int width = image.width;
+    if(i < 0 || j < 0 || i+1 >= width || j+1 >= image.height)
+        return;
+
+    float fx = x - i, fy = y - j;
+    float *d = density[layer].data() + (long)j*width + i;
+    d[0]         += weight * (1-fx) * (1-fy);
+    d[1]         += weight * fx * (1-fy);
+    d[width]     += weight * (1-fx) * fy;
+    d[width + 1] += weight * fx * fy;
+}
+
+int PriorCloudTask::step(PriorCloudJob &job, PriorCloudImage &image){
+    if(layer == PRIOR_CLOUD_LAYERS){
+        colorize(job, image);
+        return TASK_DONE;
+    }
+
+    int count = job.count;
+    const Real *priors = count > 0 ? job.priors->data() : NULL;
+
+    if(layer == PRIOR_CLOUD_LAYER_PRIORS){
+        int end = min(count, next + PRIOR_CLOUD_STEP_PRIORS);
+        const Real *x1 = priors, *x3 = priors + 2*(long)count;
+        for(int k = next; k < end; k++)
+            splat(image, layer, x0 + (float)(x3[k] + x1[k]/2) * sx, y0 - (float)x1[k] * sy, 1);
+        next = end;
+    }else{
+        // Each inner weighs its outer, so every prior adds 1 to each layer
+        int l = layer - 1;
+        PosteriorMap &m = map[l];
+        if(job.channels[l] < 0 || !m.built || m.numSecrets != NUMBER_SECRETS || m.numPosteriors == 0){
+            next = count;
+        }else{
+            int n = max(1, min(count - next, PRIOR_CLOUD_CHUNK_VALUES / (m.numPosteriors * (NUMBER_SECRETS + 1))));
+            chunkPriors.resize((long)NUMBER_SECRETS*n);
+            for(int i = 0; i < NUMBER_SECRETS; i++)
+                copy(priors + (long)i*count + next, priors + (long)i*count + next + n, chunkPriors.begin() + (long)i*n);
+            m.evaluate(chunkPriors.data(), n, chunk, ThreadPool::shared());
+
+            for(int g = 0; g < chunk.numPosteriors; g++){
+                const Real *outer = chunk.outerOf(g), *p1 = chunk.innerOf(0, g), *p3 = chunk.innerOf(2, g);
+                for(int k = 0; k < n; k++){
+                    if(outer[k] <= 0) continue;
+                    splat(image, layer, x0 + (float)(p3[k] + p1[k]/2) * sx, y0 - (float)p1[k] * sy, (float)outer[k]);
+                }
+            }
+            next += n;
+        }
+    }
+
+    if(next >= count){
+        layer++;
+        next = 0;
+    }
+    return TASK_CONTINUE;
+}
+
+void PriorCloudTask::colorize(const PriorCloudJob &job, PriorCloudImage &image){
+    long texels = (long)image.width*image.height;
+
+    // Opacity grows with the log of the density, up to PRIOR_CLOUD_OPACITY in the densest texel of each layer
+    float scale[PRIOR_CLOUD_LAYERS];
+    for(int l = 0; l < PRIOR_CLOUD_LAYERS; l++){
+        float maxDensity = 0;
+        for(long t = 0; t < texels; t++)
+            maxDensity = max(maxDensity, density[l][t]);
+        scale[l] = maxDensity > 0 ? PRIOR_CLOUD_OPACITY / log1pf(maxDensity) : 0;
+    }
+
+    // Layers are composed in order, priors at the bottom. Colors are premultiplied while composing.
+    image.pixels.resize(texels);
+    for(long t = 0; t < texels; t++){
+        float r = 0, g = 0, b = 0, a = 0;
+        for(int l = 0; l < PRIOR_CLOUD_LAYERS; l++){
+            float d = density[l][t];
+            if(d <= 0) continue;
+
+            float alpha = log1pf(d) * scale[l];
+            r = job.colors[l].r * alpha + r * (1 - alpha);
+            g = job.colors[l].g * alpha + g * (1 - alpha);
+            b = job.colors[l].b * alpha + b * (1 - alpha);
+            a = alpha + a * (1 - alpha);
+        }
+
+        if(a > 0) image.pixels[t] = (Color){(unsigned char)(r/a), (unsigned char)(g/a), (unsigned char)(b/a), (unsigned char)(a*255)};
+        else image.pixels[t] = (Color){0, 0, 0, 0};
+    }
+}
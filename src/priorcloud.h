@@ -0,0 +1,127 @@
+#ifndef _priorcloud
+#define _priorcloud
+
+#include "graphics.h"
+#include "posteriormap.h"
+#include "threadpool.h"
+#include "latestjobworker.h"
+#include <memory>
+
+#define PRIOR_CLOUD_SIZE 10000		// Priors sampled when the cloud is shown and no file was opened
+#define PRIOR_CLOUD_MAX 1000000		// Largest number of priors read from a file
+#define PRIOR_CLOUD_ALPHA 1			// Parameter of the Dirichlet distribution of the sampled priors, 1 is uniform in the triangle
+#define PRIOR_CLOUD_CELL 2			// Pixels of the visualization covered by a texel of the density image
+#define PRIOR_CLOUD_OPACITY 0.85f	// Opacity of the densest texel of a layer
+#define PRIOR_CLOUD_CHUNK_VALUES (1 << 18)	// Largest number of outers and inners computed in a step
+#define PRIOR_CLOUD_STEP_PRIORS (1 << 16)	// Priors splatted in a step of the priors layer
+#define PRIOR_CLOUD_SLICE_MS 4		// Time (in milliseconds) a frame can spend in the cloud when there are no threads
+
+// Layers of the density image: the priors and the inners of up to two channels
+#define PRIOR_CLOUD_LAYERS 3
+#define PRIOR_CLOUD_LAYER_PRIORS 0
+
+/* Set of priors shown at once in the visualization.
+ *
+ * The priors are sampled from a Dirichlet distribution or read from a CSV file with
+ * a prior per line:
+ *
+ *      x1,x2,x3        (an optional header line)
+ *      0.2,0.3,0.5
+ *      1/3,1/3,1/3
+ *      2,1,1           (weights are normalized)
+ *
+ * They are drawn, with their inners, by a PriorCloudWorker. The priors are never
+ * changed in place, a new set replaces them, so the jobs of the worker share them
+ * instead of copying them.
+ */
+class PriorCloud{
+public:
+	PriorCloud();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	int count;							// Number of priors
+	shared_ptr<const vector<Real>> priors;	// NUMBER_SECRETS x count, row-major, as PosteriorMap::evaluate expects
+	unsigned long version;				// Changes every time the priors change
+	int errorLine;						// Line of the first error of the last file read, 0 if it could not be opened
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Replace the priors with 'count' priors sampled from a symmetric Dirichlet distribution. */
+	void sample(int count, Real alpha, unsigned int seed);
+
+	/* Replace the priors with the ones of a CSV file.
+	 * Returns: NO_ERROR or INVALID_PRIOR_CLOUD_FILE (the priors are not changed and the line is in 'errorLine'). */
+	int read(const char *fileName);
+
+	/* Same as read(), for a file already in memory. 'data' does not need to be null-terminated. */
+	int parse(const char *data, long size);
+};
+
+/* Snapshot of the inputs of a density image of the cloud. */
+typedef struct PriorCloudJob{
+	unsigned long generation;			// Set by submit()
+	shared_ptr<const vector<Real>> priors;	// Priors of the cloud, NUMBER_SECRETS x count
+	int count;
+	unsigned long priorsVersion;		// Version of the priors of the cloud
+	int channels[2];					// Channels of the inners layers, -1 if not shown
+	unsigned long sources[2];			// Versions of the matrices of those channels (Data::matrixVersion)
+	Matrix matrix[2];					// NUMBER_SECRETS x m matrices of those channels
+	Vector2 trianglePoints[3];
+	Color colors[PRIOR_CLOUD_LAYERS];	// Colors of the priors and of each channel
+} PriorCloudJob;
+
+/* Density image of the bounding box of the triangle. */
+typedef struct PriorCloudImage{
+	unsigned long generation;			// Generation of the job, 0 if there is no image
+	Rectangle area;						// Pixels of the visualization covered by the image
+	int width;							// Size of the image, in texels
+	int height;
+	vector<Color> pixels;				// width x height, row-major
+} PriorCloudImage;
+
+/* Draws the priors of a cloud and their inners into a density image out of the frame, with a LatestJobWorker.
+ *
+ * The hypers of the priors are computed in batches with a PosteriorMap per channel,
+ * on the workers of ThreadPool::shared(), and each map is only built again when the
+ * version of the matrix of its channel changes. Priors and
+ * inners are splatted as points into the image (each inner weighted by its outer),
+ * with a layer per kind of point, and the image is colored with the log of the
+ * density, so dense regions do not saturate. Each step splats a batch of a layer,
+ * limited to PRIOR_CLOUD_CHUNK_VALUES hyper values, so the hypers of all the priors
+ * are never stored at once and a newer job stops this one at the end of a batch.
+ */
+class PriorCloudTask{
+public:
+	PriorCloudTask();
+
+	void start(PriorCloudJob &job, PriorCloudImage &image);
+	int step(PriorCloudJob &job, PriorCloudImage &image);
+
+private:
+	PosteriorMap map[2];		// Maps of the channels of the inners layers
+	int mapChannels[2];			// Channel and version each map was built from, -1 and 0 if none
+	unsigned long mapSources[2];
+
+	vector<float> density[PRIOR_CLOUD_LAYERS];
+	int layer;					// Layer being splatted, PRIOR_CLOUD_LAYERS once all of them are
+	int next;					// Next prior of the layer
+	float x0, y0, sx, sy;		// Position in texels of the distribution (0, 0, 0) and size of the triangle
+
+	vector<Real> chunkPriors;	// Priors of the batch being evaluated, NUMBER_SECRETS x batch size
+	PosteriorBatch chunk;		// Hypers of the batch being evaluated
+
+	/* Add a point with a given weight to a layer, spread among the 4 texels closest to it. */
+	void splat(const PriorCloudImage &image, int layer, float x, float y, float weight);
+
+	/* Color the layers into the pixels of the image. */
+	void colorize(const PriorCloudJob &job, PriorCloudImage &image);
+};
+
+typedef LatestJobWorker<PriorCloudJob, PriorCloudImage, PriorCloudTask, PRIOR_CLOUD_SLICE_MS> PriorCloudWorker;
+
+#endif
@@ -0,0 +1,125 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+const char *profileStageNames[PROFILE_STAGES] = {
+    "frame", "menu", "input", "prior_node", "channel_nodes", "hyper_nodes", "update_hyper", "inner_circles",
+    "textboxes_node", "draw_prior", "draw_channel", "draw_posteriors", "draw_visualization", "draw_menu"
+};
+
+Profiler profiler;
+
+void ProfileRing::push(float sample){
+    unsigned long n = count.load(memory_order_relaxed);
+    samples[n % PROFILER_HISTORY] = sample;
+    count.store(n + 1, memory_order_release);
+}
+
+int ProfileRing::read(float out[PROFILER_HISTORY]) const{
+    unsigned long n = count.load(memory_order_acquire);
+    int size = (int)min(n, (unsigned long)PROFILER_HISTORY);
+    for(int i = 0; i < size; i++)
+        out[i] = samples[(n - size + i) % PROFILER_HISTORY];
+    return size;
+}
+
+Profiler::Profiler(){
+    showOverlay = false;
+    for(int i = 0; i < PROFILE_STAGES; i++){
+        rings[i].count.store(0);
+        frameTime[i] = 0;
+    }
+}
+
+void Profiler::beginFrame(){
+    for(int i = 0; i < PROFILE_STAGES; i++)
+        frameTime[i] = 0;
+    start(PROFILE_FRAME);
+}
+
+void Profiler::endFrame(){
+    stop(PROFILE_FRAME);
+    for(int i = 0; i < PROFILE_STAGES; i++)
+        rings[i].push((float)frameTime[i]);
+}
+
+void Profiler::start(int stage){
+    started[stage] = chrono::steady_clock::now();
+}
+
+void Profiler::stop(int stage){
+    frameTime[stage] += chrono::duration<double, milli>(chrono::steady_clock::now() - started[stage]).count();
+}
+
+void Profiler::draw(Font font, Rectangle rec){
+    if(!showOverlay)
+        return;
+
+    static float history[PROFILER_HISTORY];
+    static const char *columns[4] = {"last", "p50", "p95", "p99"};
+    char number[32];
+    float lineHeight = (float)font.baseSize;
+    float columnWidth = (rec.width - 170) / 4;
+
+    // The font is not monospaced, so every column is drawn at its own position
+    DrawRectangleRec(rec, Fade(BLACK, 0.75f));
+    DrawTextEx(font, "stage (ms)", (Vector2){rec.x + 5, rec.y + 5}, lineHeight, 0, WHITE);
+    for(int k = 0; k < 4; k++)
+        DrawTextEx(font, columns[k], (Vector2){rec.x + 170 + k*columnWidth, rec.y + 5}, lineHeight, 0, WHITE);
+
+    for(int s = 0; s < PROFILE_STAGES; s++){
+        int n = rings[s].read(history);
+        float values[4] = {0, 0, 0, 0};
+        if(n > 0){
+            values[0] = history[n-1];
+            sort(history, history + n);
+            values[1] = history[(n-1)*50/100];
+            values[2] = history[(n-1)*95/100];
+            values[3] = history[(n-1)*99/100];
+        }
+
+        float y = rec.y + 5 + (s+1)*lineHeight;
+        Color color = (s == PROFILE_FRAME) ? YELLOW : WHITE;
+        DrawTextEx(font, profileStageNames[s], (Vector2){rec.x + 5, y}, lineHeight, 0, color);
+        for(int k = 0; k < 4; k++){
+            snprintf(number, sizeof(number), "%.3f", values[k]);
+            DrawTextEx(font, number, (Vector2){rec.x + 170 + k*columnWidth, y}, lineHeight, 0, color);
+        }
+    }
+}
+
+bool Profiler::saveCSV(const char *fileName){
+    FILE *file = fopen(fileName, "w");
+    if(file == NULL)
+        return false;
+
+    static float history[PROFILE_STAGES][PROFILER_HISTORY];
+    int n = PROFILER_HISTORY;
+    for(int s = 0; s < PROFILE_STAGES; s++)
+        n = min(n, rings[s].read(history[s]));
+
+    fprintf(file, "frame");
+    for(int s = 0; s < PROFILE_STAGES; s++)
+        fprintf(file, ",%s_ms", profileStageNames[s]);
+    fprintf(file, "\n");
+
+    // Stages are pushed together, so the last n samples of every ring are the same frames
+    unsigned long first = rings[PROFILE_FRAME].count.load() - n;
+    for(int i = 0; i < n; i++){
+        fprintf(file, "%lu", first + i);
+        for(int s = 0; s < PROFILE_STAGES; s++)
+            fprintf(file, ",%.4f", history[s][i]);
+        fprintf(file, "\n");
+    }
+
+    return fclose(file) == 0;
+}
+
+ProfileScope::ProfileScope(int stage){
+    this->stage = stage;
+    profiler.start(stage);
+}
+
+ProfileScope::~ProfileScope(){
+    profiler.stop(stage);
+}
@@ -0,0 +1,101 @@
+#ifndef _profiler
+#define _profiler
+
+#include "../libs/raylib/src/raylib.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+// Frames kept in the history of each stage
+#define PROFILER_HISTORY 512
+
+// Stages of a frame
+#define PROFILE_FRAME 0				// Update and draw, without the wait for the next frame
+#define PROFILE_MENU 1				// File, mode and examples buttons
+#define PROFILE_INPUT 2				// Prior and channel textboxes and spinner
+#define PROFILE_PRIOR_NODE 3		// Parse the prior
+#define PROFILE_CHANNEL_NODES 4		// Parse and build the channels
+#define PROFILE_HYPER_NODES 5		// Take and submit compositions and hypers
+#define PROFILE_UPDATE_HYPER 6		// Hypers updated while the prior is dragged
+#define PROFILE_INNER_CIRCLES 7
+#define PROFILE_TEXTBOXES_NODE 8	// Posteriors textboxes
+#define PROFILE_DRAW_PRIOR 9
+#define PROFILE_DRAW_CHANNEL 10
+#define PROFILE_DRAW_POSTERIORS 11
+#define PROFILE_DRAW_VISUALIZATION 12
+#define PROFILE_DRAW_MENU 13
+#define PROFILE_STAGES 14
+
+/* Times (in milliseconds) of the last PROFILER_HISTORY frames of a stage.
+ * There is a single writer. The number of samples is published after the sample
+ * is written, so a reader in another thread never sees a sample being written. */
+typedef struct ProfileRing{
+	float samples[PROFILER_HISTORY];
+	atomic<unsigned long> count;	// Samples written since the start
+
+	void push(float sample);
+
+	/* Copy the samples, oldest first, to 'out'. Returns the number of samples copied. */
+	int read(float out[PROFILER_HISTORY]) const;
+} ProfileRing;
+
+/* Time spent in each stage of the frames.
+ *
+ * A stage may run several times in a frame (i.e. the circles of each channel), so the
+ * time of a stage is added up during the frame and pushed to its ring by endFrame().
+ * Frames that are skipped are not recorded. The overlay shows the last frame and the
+ * 50th, 95th and 99th percentiles of the history, and the history can be saved as CSV. */
+class Profiler{
+public:
+	Profiler();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	bool showOverlay;
+	ProfileRing rings[PROFILE_STAGES];
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Start and end a rendered frame. */
+	void beginFrame();
+	void endFrame();
+
+	/* Start and stop measuring a stage. */
+	void start(int stage);
+	void stop(int stage);
+
+	/* Draw the overlay in the rectangle 'rec', if it is shown. */
+	void draw(Font font, Rectangle rec);
+
+	/* Write the history of every stage to a CSV file, one row per frame.
+	 * Returns false if the file can not be written. */
+	bool saveCSV(const char *fileName);
+
+private:
+	chrono::steady_clock::time_point started[PROFILE_STAGES];
+	double frameTime[PROFILE_STAGES];	// Time of each stage in the current frame (ms)
+};
+
+/* Measure a stage until the end of the scope. */
+class ProfileScope{
+public:
+	ProfileScope(int stage);
+	~ProfileScope();
+
+private:
+	int stage;
+};
+
+// Name of each stage, as shown in the overlay and in the CSV header
+extern const char *profileStageNames[PROFILE_STAGES];
+
+// Profiler of the application
+extern Profiler profiler;
+
+#endif
@@ -22,12 +22,16 @@
 #include "gui/gui.h"
 #include "data.h"
 #include "chull.h"
+#include "session.h"
+#include "framescheduler.h"
+#include "profiler.h"
 
 typedef struct WebLoopVariables{
     Gui gui;
     Data data;
     bool closeWindow;
     int mode;
+    FrameScheduler frames;
 } WebLoopVariables;
 
 #if defined(PLATFORM_WEB)
@@ -43,9 +47,15 @@ void readFonts(Font* defaultFont, Font* defaultFontBig);
 void updateStatusBar(int error, GuiVisualization &visualization);
 void checkButtonsMouseCollision(Gui &gui);
 void checkHelpMessagesActive(Gui &gui, Vector2 mousePosition);
-void checkPriorFlags(Gui &gui, Data &data); // Check compute and ready prior flags
-void checkChannelsFlags(Gui &gui, Data &data); // Check compute and ready channels flags
-void checkHypersFlags(Gui &gui, Data &data); // Check compute and ready hypers flags
+void updateGraph(Gui &gui, Data &data); // Recompute the nodes of the dependency graph affected by the changes of this frame
+void updatePriorNode(Gui &gui, Data &data);
+void updateChannelNode(Gui &gui, Data &data, int channel, int mode); // CHANNEL_1 or CHANNEL_2
+void submitComputeNodes(Gui &gui, Data &data); // Send the composition and the hypers that must be updated to the worker
+void applyComputeResult(Gui &gui, Data &data); // Take the composition and the hypers finished by the worker
+void updatePosteriorsTextBoxes(Gui &gui, Data &data); // Posteriors textboxes of the current channel, formatted only when its hyper changes
+void saveFile(Gui &gui, Data &data, bool createNewFile); // Save the textboxes (.qifg) or the whole session (.qifgb)
+void storeSession(Gui &gui, Data &data, Session &session); // Copy the textboxes and the computed objects to a session
+bool restoreSession(Gui &gui, Data &data, Session &session); // Use the objects of an opened session. Returns false if any of them must be recomputed.
 
 //----------------------------------------------------------------------------------
 // Draw Functions Declaration
@@ -53,12 +63,15 @@ void checkHypersFlags(Gui &gui, Data &data); // Check compute and ready hypers f
 void drawGuiMenu(Gui &gui, Data &data, bool* closeWindow);
 void drawGuiPrior(Gui &gui, Data &data);
 void drawGuiChannel(Gui &gui, Data &data);
+void drawChannelTextBox(Gui &gui, int i, int j);
 void drawGuiPosteriors(Gui &gui, Data &data);
 void drawGuiVisualization(Gui &gui, Data &data);
 void drawGettingStarted(Gui &gui);
 void drawCirclePrior(Gui &gui, Data &data);
 void drawCirclesInners(Gui &gui, Data &data, int channel);
-void drawContentPanel(Rectangle layoutTitle, Rectangle layoutContent, char *title, Color contentColor, Font font);
+void updatePriorCloudTexture(Gui &gui, Data &data); // Upload the last density image of the cloud, GuiVisualization draws it
+void updateHeatmapTexture(Gui &gui, Data &data); // Upload the last level of the heatmap of the current channel, GuiVisualization draws it
+void drawContentPanel(Renderer &renderer, Rectangle layoutTitle, Rectangle layoutContent, char *title, Color contentColor, Font font);
 void drawGSContent(Gui &gui, Rectangle panel, int option, int imgPadding);
 void drawHelpMessage(Gui &gui, Rectangle rec, char message[CHAR_BUFFER_SIZE]);
 void drawTab(Gui &gui, int channel, bool active);        // If the tab is currently active
@@ -88,19 +101,27 @@ int main(){
     vars.gui.posteriors.resetPosterior(CHANNEL_1);
     GuiSetFont(vars.gui.defaultFont); // Set default font
     initStyle();
+    vars.frames.load(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 #if defined(PLATFORM_WEB)
-    emscripten_set_main_loop_arg(updateDrawFrame, &vars, 120, 1);
+    // The browser calls it once per screen refresh, and skipped frames return at once
+    emscripten_set_main_loop_arg(updateDrawFrame, &vars, 0, 1);
 #else
-    SetTargetFPS(60);
+    SetTargetFPS(FRAME_ACTIVE_FPS);
     //--------------------------------------------------------------------------------------
 
     // Main game loop
     while(!vars.closeWindow){    // Detect window close button or ESC key
         updateDrawFrame(&vars);
     }
+
+    // Number of times each object was computed in the session
+    TraceLog(LOG_INFO, "Recomputations:\n%s", vars.data.graph.report().c_str());
+    TraceLog(LOG_INFO, "Frames: %s", vars.frames.report().c_str());
 #endif
 
+    vars.frames.unload();
+
     // De-Initialization
     //--------------------------------------------------------------------------------------
     CloseWindow();        // Close window and OpenGL context
@@ -119,45 +140,63 @@ void updateDrawFrame(void* vars_){
     bool* closeWindow = &(vars->closeWindow);
     int* mode = &(vars->mode);
 
+    // Polled in skipped frames as well, the close button of the window is not seen as input
+    *closeWindow = WindowShouldClose();
+
+    // Nothing is updated nor drawn again while there is no input and nothing moves
+    bool busy = data->animationRunning || data->mouseClickedOnPrior || data->worker.hasResult() || data->heatmap.hasResult() || data->cloudWorker.hasResult() ||
+                gui->checkPriorTextBoxPressed() || gui->checkChannelTextBoxPressed() || gui->channel.SpinnerChannelEditMode;
+    if(!vars->frames.beginFrame(busy)){
+        vars->frames.present();
+        return;
+    }
+    data->now = GetTime();
+    profiler.beginFrame();
+
     //----------------------------------------------------------------------------------
     // Update
     //----------------------------------------------------------------------------------
-    *closeWindow = WindowShouldClose();
     Vector2 mousePosition = GetMousePosition();
 
     if(IsKeyPressed(KEY_Z)){
         TakeScreenshot("pic.png");
     }
+
+    // Profiler overlay and history of the frames times
+    if(IsKeyPressed(KEY_F3)) profiler.showOverlay = !profiler.showOverlay;
+    if(IsKeyPressed(KEY_F4)){
+        if(profiler.saveCSV("profile.csv")) TraceLog(LOG_INFO, "Frames times saved in profile.csv");
+        else TraceLog(LOG_WARNING, "Frames times could not be saved in profile.csv");
+    }
     
     // If getting started window is active, nothing can be changed until the window closes
     if(!gui->menu.windowGettingStartedActive){
 
     // Menu
     //----------------------------------------------------------------------------------
+    profiler.start(PROFILE_MENU);
     checkButtonsMouseCollision(*gui);
     buttonFile(*gui, *data, closeWindow);
     buttonMode(*gui, *data, mode); // It must be called after buttonFile function
     buttonExamples(*gui, *data);
+    profiler.stop(PROFILE_MENU);
     //----------------------------------------------------------------------------------
 
-    data->error = NO_ERROR;
-
     // Prior
     //----------------------------------------------------------------------------------
+    profiler.start(PROFILE_INPUT);
+
     // Check if a TextBox is being pressed
     if(gui->checkPriorTextBoxPressed()){
         gui->drawing = false;
         data->fileSaved = false;
-        data->compute[FLAG_PRIOR] = true;
-        data->ready[FLAG_PRIOR] = false;
+        data->graph.touch(NODE_PRIOR);
         updateStatusBar(NO_ERROR, gui->visualization);
 
         if(IsKeyPressed(KEY_TAB) || IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_RIGHT)){
             gui->moveAmongPriorTextBoxes();
         }
     }
-    
-    checkPriorFlags(*gui, *data);
     //----------------------------------------------------------------------------------
 
     // Channels
@@ -166,12 +205,11 @@ void updateDrawFrame(void* vars_){
     if(gui->channel.checkChannelSpinner(*mode)){
         gui->drawing = false;
         data->fileSaved = false;
-        if(*mode == MODE_REF){
-            data->resetAllExceptComputeChannel1();
-        }else{
-            data->compute[FLAG_CHANNEL_1+gui->channel.curChannel] = true;
-            data->ready[FLAG_CHANNEL_1+gui->channel.curChannel] = false;
-        }
+        data->graph.touch(NODE_CHANNEL_1+gui->channel.curChannel);
+
+        // In refinement mode the rows of R are the outputs of C
+        if(*mode == MODE_REF && gui->channel.curChannel == CHANNEL_1)
+            data->graph.touch(NODE_CHANNEL_2);
         updateStatusBar(NO_ERROR, gui->visualization);
     }
     
@@ -179,12 +217,7 @@ void updateDrawFrame(void* vars_){
     if(gui->checkChannelTextBoxPressed()){
         gui->drawing = false;
         data->fileSaved = false;
-        if(*mode == MODE_REF){
-            data->resetAllExceptComputeChannel1();
-        }else{
-            data->compute[FLAG_CHANNEL_1+gui->channel.curChannel] = true;
-            data->ready[FLAG_CHANNEL_1+gui->channel.curChannel] = false;
-        }
+        data->graph.touch(NODE_CHANNEL_1+gui->channel.curChannel);
 
         updateStatusBar(NO_ERROR, gui->visualization);
 
@@ -193,14 +226,14 @@ void updateDrawFrame(void* vars_){
         }
     }
 
-    checkChannelsFlags(*gui, *data);
     gui->channel.checkModeAndSizes(*mode);
     gui->channel.setScrollContent();
+    profiler.stop(PROFILE_INPUT);
     //----------------------------------------------------------------------------------
 
-    // Hypers
+    // Prior, channels and hypers affected by the changes
     //----------------------------------------------------------------------------------
-    checkHypersFlags(*gui, *data);
+    updateGraph(*gui, *data);
     gui->posteriors.setScrollContent(gui->channel.curChannel);
     //----------------------------------------------------------------------------------
 
@@ -214,12 +247,12 @@ void updateDrawFrame(void* vars_){
         
         if(IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) data->mouseClickedOnPrior = false;
 
-        if(data->mouseClickedOnPrior){
+        // Nothing has to be rebuilt while the mouse holds the prior still
+        if(data->mouseClickedOnPrior && data->updateHyper(gui->visualization.trianglePoints, *mode)){
             data->fileSaved = false;
-            data->updateHyper(gui->visualization.trianglePoints, *mode);
             for(int i = 0; i < NUMBER_CHANNELS; i++)
-                gui->posteriors.numPosteriors[i] = data->hyper[i].num_post;
-            data->animation = UPDATE_CIRCLES_BY_MOUSE;
+                gui->posteriors.setNumPosteriors(i, data->hyper[i].num_post);
+            data->animationRunning = false;
             
             data->buildPriorCircle(gui->visualization.trianglePoints);
             gui->updateRectanglePriorCircleLabel(data->priorCircle);
@@ -234,6 +267,7 @@ void updateDrawFrame(void* vars_){
                 data->buildInnerCircles(gui->visualization.trianglePoints, CHANNEL_3, *mode);
                 gui->updateRectangleInnersCircleLabel(CHANNEL_3, data->innersCircles[CHANNEL_3]);
             }
+            data->graph.update(NODE_CIRCLES, NO_ERROR);
         }
 
         if(data->animationRunning){
@@ -251,7 +285,7 @@ void updateDrawFrame(void* vars_){
     }
     //----------------------------------------------------------------------------------
     
-    gui->updateHyperTextBoxes(data->hyper[gui->channel.curChannel], gui->channel.curChannel, data->ready[FLAG_HYPER_1+gui->channel.curChannel]);
+    updatePosteriorsTextBoxes(*gui, *data);
 
     // Help messages
     //----------------------------------------------------------------------------------
@@ -263,10 +297,23 @@ void updateDrawFrame(void* vars_){
 
     } // end of if(!gui->menu.windowGettingStartedActive)
 
+    // Heatmap of the current channel and prior cloud, computed in the background. Neither depends on the
+    // current prior, so they are not computed again when it moves. Their results are taken also while the
+    // guide is open, so a finished one does not keep the frames busy.
+    //----------------------------------------------------------------------------------
+    {
+        // R is not a channel of the secrets in MODE_REF, its tab shows the heatmap of the composition
+        int channel = gui->channel.curChannel;
+        if(*mode == MODE_REF && channel == CHANNEL_2) channel = CHANNEL_3;
+        data->updateHeatmap(gui->visualization.trianglePoints, channel, gui->drawing ? gui->heatmapMeasure : HEATMAP_NONE);
+    }
+    data->updatePriorCloud(gui->visualization.trianglePoints, *mode, gui->drawing && gui->showPriorCloud);
+    //----------------------------------------------------------------------------------
+
     //----------------------------------------------------------------------------------
     // Draw
     //----------------------------------------------------------------------------------
-    BeginDrawing();
+    vars->frames.beginDrawing();
         ClearBackground(BG_BASE_COLOR_DARK); 
 
         if(gui->menu.windowGettingStartedActive) GuiLock();
@@ -279,7 +326,9 @@ void updateDrawFrame(void* vars_){
         if(gui->menu.windowGettingStartedActive) GuiUnlock();
         drawGettingStarted(*gui);
 
-    EndDrawing();
+        profiler.endFrame();
+        profiler.draw(gui->defaultFont, (Rectangle){SCREEN_WIDTH - 450, 30, 440, (PROFILE_STAGES + 1)*(float)gui->defaultFont.baseSize + 10});
+    vars->frames.endDrawing();
     //-----------------------------------------------------------------------------------
 }
 
@@ -343,6 +392,12 @@ void updateStatusBar(int error, GuiVisualization &visualization){
         case INVALID_CHANNEL_2_R:
 			strcpy(visualization.TextBoxStatusText, "Some row in channel R is not a probability distribution");
 			break;
+        case INVALID_COMPOSITION:
+			strcpy(visualization.TextBoxStatusText, "The number of outputs of C must be equal to the number of rows of R");
+			break;
+        case STATUS_COMPUTING:
+			strcpy(visualization.TextBoxStatusText, "Computing...");
+			break;
 		case NO_ERROR:
 			strcpy(visualization.TextBoxStatusText, "Status");
 	}
@@ -394,133 +449,403 @@ void checkHelpMessagesActive(Gui &gui, Vector2 mousePosition){
     initStyle();
 }
 
-void checkPriorFlags(Gui &gui, Data &data){
-    if(data.compute[FLAG_PRIOR]){
-        if(data.checkPriorText(gui.prior.TextBoxPriorText) == NO_ERROR){
-            if(Distribution::isDistribution(data.prior)){
-                data.priorObj = Distribution(data.prior);
-                data.ready[FLAG_PRIOR] = true;
-            }else{
-                data.error = INVALID_PRIOR;
-                data.ready[FLAG_PRIOR] = false;
-            }
+void updateGraph(Gui &gui, Data &data){
+    int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
+
+    // Results are taken before the inputs change in this frame
+    applyComputeResult(gui, data);
+
+    // Prior and channels are parsed in the frame, so invalid values are reported at once
+    updatePriorNode(gui, data);
+    updateChannelNode(gui, data, CHANNEL_1, mode);
+    updateChannelNode(gui, data, CHANNEL_2, mode);
+    submitComputeNodes(gui, data);
+
+    // Circles are only built by the draw button or by moving the prior, so they are hidden if a hyper changed
+    if(gui.drawing && data.graph.needsUpdate(NODE_CIRCLES))
+        gui.drawing = false;
+
+    data.error = data.graph.firstError();
+
+    // It is set every frame because editing a textbox resets the status bar
+    bool computing = data.graph.computing();
+    if(computing) updateStatusBar(STATUS_COMPUTING, gui.visualization);
+    else if(data.computing) updateStatusBar(NO_ERROR, gui.visualization);
+    data.computing = computing;
+}
+
+void updatePriorNode(Gui &gui, Data &data){
+    ProfileScope scope(PROFILE_PRIOR_NODE);
+    if(!data.graph.needsUpdate(NODE_PRIOR))
+        return;
+
+    long double previous[NUMBER_SECRETS];
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        previous[i] = data.prior[i];
+
+    int error = NO_ERROR;
+    if(data.checkPriorText(gui.prior.TextBoxPriorText) != NO_ERROR)
+        error = INVALID_VALUE_PRIOR;
+    else if(!Distribution::isDistribution(data.prior))
+        error = INVALID_PRIOR;
+
+    bool changed = false;
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        changed = changed || previous[i] != data.prior[i];
+
+    data.graph.update(NODE_PRIOR, error, changed);
+}
+
+void updateChannelNode(Gui &gui, Data &data, int channel, int mode){
+    ProfileScope scope(PROFILE_CHANNEL_NODES);
+    int node = NODE_CHANNEL_1+channel;
+    if(!data.graph.needsUpdate(node))
+        return;
+
+    if(!data.graph.inputsReady(node)){
+        data.graph.invalidate(node);
+        return;
+    }
+
+    // The channel object depends on the prior, so it changes if the prior changed even if the text did not
+    bool changed = data.graph.inputsChanged(node);
+    data.previousChannel = data.channel[channel];
+
+    int error = data.checkChannelText(gui.channel.TextBoxChannelText[channel], channel, gui.channel.numSecrets[channel], gui.channel.numOutputs[channel]);
+    if(error == NO_ERROR){
+        bool refChannel = channel == CHANNEL_2 && mode == MODE_REF;
+        if(refChannel)
+            data.fakePrior = Distribution(gui.channel.numSecrets[CHANNEL_2], "uniform");
+
+        if(data.buildChannel(channel, refChannel ? data.fakePrior : data.priorObj) != NO_ERROR)
+            error = refChannel ? INVALID_CHANNEL_2_R : INVALID_CHANNEL_1 + channel;
+    }
+
+    bool matrixChanged = data.previousChannel != data.channel[channel];
+    if(matrixChanged) data.matrixVersion[channel]++;
+    data.graph.update(node, error, changed || matrixChanged);
+}
+
+void submitComputeNodes(Gui &gui, Data &data){
+    ProfileScope scope(PROFILE_HYPER_NODES);
+    bool needsUpdate = data.graph.needsUpdate(NODE_CHANNEL_3);
+    for(int channel = 0; channel < NUMBER_CHANNELS; channel++)
+        needsUpdate = needsUpdate || data.graph.needsUpdate(NODE_HYPER_1+channel);
+    if(!needsUpdate)
+        return;
+
+    // A job cancels the previous one, so it also takes the nodes that were pending
+    ComputeJob &job = data.job;
+    job.compose = false;
+    if(data.graph.needsUpdate(NODE_CHANNEL_3) || data.graph.pending(NODE_CHANNEL_3)){
+        if(data.graph.inputsReady(NODE_CHANNEL_3)){
+            job.compose = true;
         }else{
-            data.error = INVALID_VALUE_PRIOR;
-            data.ready[FLAG_PRIOR] = false;
+            data.graph.invalidate(NODE_CHANNEL_3);
+            gui.channel.resetChannel(CHANNEL_3);
         }
-        
-        data.compute[FLAG_PRIOR] = false;
+    }
 
-        if(data.error == INVALID_PRIOR || data.error == INVALID_VALUE_PRIOR){
-            for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
-                data.ready[FLAG_HYPER_1+channel] = false;
-                gui.posteriors.resetPosterior(channel);
-                
-                if(data.ready[FLAG_CHANNEL_1+channel]){
-                    data.ready[FLAG_CHANNEL_1+channel] = false;
-                    data.compute[FLAG_CHANNEL_1+channel] = true;
-                }
-            }
+    bool submit = job.compose;
+    for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
+        int node = NODE_HYPER_1+channel;
+        bool composed = channel == CHANNEL_3 && job.compose;
+        job.hyper[channel] = false;
+        if(!composed && !data.graph.needsUpdate(node) && !data.graph.pending(node))
+            continue;
+
+        if(composed || data.graph.inputsReady(node)){
+            job.hyper[channel] = true;
+            submit = true;
+        }else{
+            data.graph.invalidate(node);
+            gui.posteriors.resetPosterior(channel);
         }
-    }else if(!data.ready[FLAG_PRIOR]){
-        data.error = INVALID_PRIOR;
     }
+
+    if(!submit)
+        return;
+
+    // Snapshot of the objects the job reads
+    job.prior = data.priorObj;
+    for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
+        bool used = channel == CHANNEL_3 ? job.hyper[CHANNEL_3] && !job.compose : job.hyper[channel] || job.compose;
+        if(!used) continue;
+        job.channel[channel] = data.channel[channel];
+        job.channelObj[channel] = data.channelObj[channel];
+    }
+    data.worker.submit(job);
+
+    if(job.compose)
+        data.graph.begin(NODE_CHANNEL_3);
+    for(int channel = 0; channel < NUMBER_CHANNELS; channel++)
+        if(job.hyper[channel]) data.graph.begin(NODE_HYPER_1+channel);
 }
 
-void checkChannelsFlags(Gui &gui, Data &data){
-    // If prior is not ready, there is no reason to compute channel
-    if(!data.ready[FLAG_PRIOR])
+void applyComputeResult(Gui &gui, Data &data){
+    ProfileScope scope(PROFILE_HYPER_NODES);
+    ComputeResult &result = data.result;
+    if(!data.worker.poll(result))
         return;
 
-    int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
-    
+    // The buffers are swapped, so the worker reuses the old objects
+    if(result.composed && data.graph.pending(NODE_CHANNEL_3)){
+        if(result.compositionError == NO_ERROR){
+            swap(data.channel[CHANNEL_3], result.composition);
+            if(result.composition != data.channel[CHANNEL_3]) data.matrixVersion[CHANNEL_3]++;
+            swap(data.channelObj[CHANNEL_3], result.compositionObj);
+            gui.updateChannelTextBoxes(data.channel[CHANNEL_3], CHANNEL_3);
+        }else{
+            gui.channel.resetChannel(CHANNEL_3);
+        }
+        data.graph.finish(NODE_CHANNEL_3, result.compositionError);
+    }
+
     for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
-        if(data.compute[FLAG_CHANNEL_1+channel]){
-            if(channel == CHANNEL_3){
-                // Multiply channels C and R
-                data.channelObj[CHANNEL_3] = composeChannels(data.channelObj[CHANNEL_1], data.channelObj[CHANNEL_2]);
-                data.channel[CHANNEL_3] = data.channelObj[CHANNEL_3].matrix;
-                gui.updateChannelTextBoxes(data.channelObj[CHANNEL_3], CHANNEL_3);
-                data.ready[FLAG_CHANNEL_3] = true;
-                data.compute[FLAG_HYPER_3] = true; // Set hyper to be computed
-            }else if(data.checkChannelText(gui.channel.TextBoxChannelText[channel], channel, gui.channel.numSecrets[channel], gui.channel.numOutputs[channel]) == NO_ERROR){    
-                if(Channel::isChannel(data.channel[channel])){
-                    if(channel == CHANNEL_2 && gui.menu.dropdownBoxActive[BUTTON_MODE] == MODE_REF){
-                        data.fakePrior = Distribution(gui.channel.numSecrets[CHANNEL_2], "uniform");
-                        data.channelObj[CHANNEL_2] = Channel(data.fakePrior, data.channel[CHANNEL_2]);
-                        if(data.ready[FLAG_CHANNEL_1])
-                            data.compute[FLAG_CHANNEL_3] = true;
-                    }else{
-                        data.channelObj[channel] = Channel(data.priorObj, data.channel[channel]);
-                        data.compute[FLAG_HYPER_1+channel] = true; // Set hyper to be computed
-                        if(channel == CHANNEL_1 && gui.menu.dropdownBoxActive[BUTTON_MODE] == MODE_REF)
-                            data.compute[FLAG_CHANNEL_2] = true;
-                    }
-                    data.ready[FLAG_CHANNEL_1+channel] = true;
-                }else{
-                    data.error = INVALID_CHANNEL_1 + channel;   
-                }
-            }else{
-                data.error = INVALID_VALUE_CHANNEL_1 + channel;
+        int node = NODE_HYPER_1+channel;
+        if(!data.graph.pending(node))
+            continue;
+
+        // Only hyper 3 is not built, when the composition failed
+        if(!result.built[channel]){
+            data.graph.invalidate(node);
+            gui.posteriors.resetPosterior(channel);
+            continue;
+        }
+
+        swap(data.hyper[channel], result.hyper[channel]);
+        swap(data.hyperCache[channel], result.hyperCache[channel]);
+        gui.posteriors.setNumPosteriors(channel, data.hyper[channel].num_post);
+
+        // Hyper 3 was built from the composition finished above, which is already a newer version than the one seen by begin()
+        if(channel == CHANNEL_3 && result.composed) data.graph.update(node, NO_ERROR);
+        else data.graph.finish(node, NO_ERROR);
+    }
+}
+
+void updatePosteriorsTextBoxes(Gui &gui, Data &data){
+    ProfileScope scope(PROFILE_TEXTBOXES_NODE);
+    int channel = gui.channel.curChannel;
+    int node = NODE_HYPER_1 + channel;
+
+    // Only the hyper of the current channel is shown, so changes of the other hypers do not format anything
+    unsigned long version = data.graph.ready(node) ? data.graph.version(node) : 0;
+    gui.updateHyperTextBoxes(data.hyper[channel], channel, version);
+}
+
+void saveFile(Gui &gui, Data &data, bool createNewFile){
+    gui.menu.saveQIFFile(
+        gui.prior.TextBoxPriorText,
+        gui.channel.TextBoxChannelText,
+        gui.channel.numSecrets,
+        gui.channel.numOutputs,
+        gui.menu.dropdownBoxActive[BUTTON_MODE],
+        createNewFile
+    );
+
+    if(strcmp(gui.menu.fileName, "\0") && gui.menu.isSessionFile()){
+        storeSession(gui, data, gui.menu.session);
+        if(gui.menu.session.save(string(gui.menu.fileName)) != NO_ERROR){
+            string command = "zenity --error --no-wrap --text=\"Could not save the session (" + string(gui.menu.session.error) + ")\"";
+            system(command.c_str());
+        }
+    }
+}
+
+// Channels whose hyper is drawn in a mode
+static bool hyperUsed(int channel, int mode){
+    return channel == CHANNEL_1 || (channel == CHANNEL_2 && mode == MODE_TWO) || (channel == CHANNEL_3 && mode == MODE_REF);
+}
+
+// Channels whose matrix exists in a mode
+static bool channelUsed(int channel, int mode){
+    return channel == CHANNEL_1 || (channel == CHANNEL_2 && mode != MODE_SINGLE) || (channel == CHANNEL_3 && mode == MODE_REF);
+}
+
+void storeSession(Gui &gui, Data &data, Session &session){
+    int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
+    session.mode = mode;
+
+    // Text
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        session.prior[i] = gui.prior.TextBoxPriorText[i];
+
+    for(int c = 0; c < 2; c++){
+        bool used = channelUsed(c, mode);
+        session.numSecrets[c] = used ? gui.channel.numSecrets[c] : 0;
+        session.numOutputs[c] = used ? gui.channel.numOutputs[c] : 0;
+        session.channel[c].resize(session.numSecrets[c]*session.numOutputs[c]);
+        for(int i = 0; i < session.numSecrets[c]; i++)
+            for(int j = 0; j < session.numOutputs[c]; j++)
+                session.channel[c][i*session.numOutputs[c] + j] = gui.channel.TextBoxChannelText[c][i][j];
+    }
+
+    // Results, only if everything the mode draws is ready
+    session.hasResults = data.graph.ready(NODE_PRIOR);
+    for(int c = 0; c < NUMBER_CHANNELS; c++){
+        if(channelUsed(c, mode) && !data.graph.ready(NODE_CHANNEL_1+c)) session.hasResults = false;
+        if(hyperUsed(c, mode) && !data.graph.ready(NODE_HYPER_1+c)) session.hasResults = false;
+    }
+
+    if(session.hasResults){
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            session.priorValues[i] = data.prior[i];
+
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            if(channelUsed(c, mode)) session.matrix[c] = data.channel[c];
+            else session.matrix[c].resize(0, 0);
+
+            session.hyperReady[c] = hyperUsed(c, mode);
+            if(!session.hyperReady[c]) continue;
+
+            Hyper &hyper = data.hyper[c];
+            session.numPosteriors[c] = hyper.num_post;
+            session.outer[c].resize(hyper.num_post);
+            session.inners[c].resize(NUMBER_SECRETS*hyper.num_post);
+            for(int k = 0; k < hyper.num_post; k++){
+                session.outer[c][k] = hyper.outer.prob[k];
+                for(int i = 0; i < NUMBER_SECRETS; i++)
+                    session.inners[c][i*hyper.num_post + k] = hyper.inners[i][k];
             }
+        }
+    }
 
-            data.compute[FLAG_CHANNEL_1+channel] = false;
+    // Circles. During the animation they are not in their final positions, so they are rebuilt when the session is opened.
+    session.drawing = gui.drawing && session.hasResults;
+    session.hasCircles = session.drawing && !data.animationRunning;
+    if(session.hasCircles){
+        for(int i = 0; i < 3; i++)
+            session.trianglePoints[i] = gui.visualization.trianglePoints[i];
+        session.priorCircle = data.priorCircle;
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            int numCircles = hyperUsed(c, mode) ? data.hyper[c].num_post : 0;
+            session.innersCircles[c].assign(data.innersCircles[c].begin(), data.innersCircles[c].begin() + numCircles);
+        }
+    }
+}
 
-            if(data.error == INVALID_CHANNEL_1+channel || data.error == INVALID_VALUE_CHANNEL_1+channel){
-                data.ready[FLAG_CHANNEL_1+channel] = false;
-                data.ready[FLAG_HYPER_1+channel] = false;
-                data.compute[FLAG_HYPER_1+channel] = false;
-                gui.posteriors.resetPosterior(channel);
+bool restoreSession(Gui &gui, Data &data, Session &session){
+    int mode = session.mode;
+    if(!session.hasResults)
+        return false;
 
-                if(mode == MODE_REF){
-                    data.ready[FLAG_CHANNEL_3] = false;
-                    data.compute[FLAG_CHANNEL_3] = false;
-                    data.ready[FLAG_HYPER_3] = false;
-                    data.compute[FLAG_HYPER_3] = false;
-                    gui.posteriors.resetPosterior(CHANNEL_3);
-                    gui.channel.resetChannel(CHANNEL_3);
-                }
+    // Prior
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        data.prior[i] = session.priorValues[i];
+    if(!Distribution::isDistribution(data.prior))
+        return false;
+    data.priorObj = Distribution(data.prior);
+
+    // Channels. The composition is multiplied again from the restored channels, if it is not the
+    // stored one the hyper built from it is stale, so both are computed in the background as usual.
+    if(mode == MODE_REF)
+        data.fakePrior = Distribution(gui.channel.numSecrets[CHANNEL_2], "uniform");
+
+    bool restored[NUMBER_NODES] = {false};
+    for(int c = 0; c < NUMBER_CHANNELS; c++){
+        if(!channelUsed(c, mode)) continue;
+
+        Matrix &matrix = session.matrix[c];
+        if(c == CHANNEL_3){
+            if(composeChannels(data.channel[CHANNEL_1], data.channel[CHANNEL_2], data.channel[CHANNEL_3]) != NO_ERROR)
+                return false;
+            data.matrixVersion[CHANNEL_3]++;
+            if(!data.channel[CHANNEL_3].near(matrix, SESSION_TOLERANCE)){
+                data.graph.touch(NODE_CHANNEL_3);
+                continue;
             }
         }else{
-            if(channel == CHANNEL_1 && !data.ready[FLAG_CHANNEL_1]){
-                data.error = INVALID_CHANNEL_1;
-            }else if(channel == CHANNEL_2 && data.ready[FLAG_CHANNEL_1] && !data.ready[FLAG_CHANNEL_2] && gui.menu.dropdownBoxActive[BUTTON_MODE] != MODE_SINGLE){
-                if(gui.menu.dropdownBoxActive[BUTTON_MODE] == MODE_TWO) data.error = INVALID_CHANNEL_2_D;
-                else data.error = INVALID_CHANNEL_2_R;                
-            }
+            if(matrix.rows != gui.channel.numSecrets[c] || matrix.cols != gui.channel.numOutputs[c])
+                return false;
+            data.channel[c] = matrix;
+            data.matrixVersion[c]++;
         }
+
+        bool refChannel = c == CHANNEL_2 && mode == MODE_REF;
+        if(data.buildChannel(c, refChannel ? data.fakePrior : data.priorObj) != NO_ERROR)
+            return false;
+        restored[NODE_CHANNEL_1+c] = true;
     }
-}
 
-void checkHypersFlags(Gui &gui, Data &data){
-    // If prior is not ready, there is no reason to compute the hyper
-    if(!data.ready[FLAG_PRIOR])
-        return;
+    // Hypers are written directly, only the drag cache is rebuilt. The ones that can not be used are computed again.
+    for(int c = 0; c < NUMBER_CHANNELS; c++){
+        if(!hyperUsed(c, mode)) continue;
 
-    for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
-        // If channel is not ready, there is no reason to compute the hyper
-        if(!data.ready[FLAG_CHANNEL_1+channel]){
-            data.ready[FLAG_HYPER_1+channel] = false;
+        int numPosteriors = session.numPosteriors[c];
+        if(!restored[NODE_CHANNEL_1+c] || !session.hyperReady[c] || numPosteriors > data.channel[c].cols){
+            data.graph.touch(NODE_HYPER_1+c);
             continue;
         }
 
-        if(data.compute[FLAG_HYPER_1+channel]){
-            data.hyper[channel] = Hyper(data.channelObj[channel]);
-            gui.posteriors.numPosteriors[channel] = data.hyper[channel].num_post;
-            data.ready[FLAG_HYPER_1+channel] = true;
-            data.compute[FLAG_HYPER_1+channel] = false;
-            
-            if(gui.channel.curChannel == channel)
-                gui.updateHyperTextBoxes(data.hyper[channel], channel, data.ready[FLAG_HYPER_1+channel]);
+        Hyper &hyper = data.hyper[c];
+        hyper.channel = data.channelObj[c];
+        hyper.prior = data.priorObj;
+        hyper.num_post = numPosteriors;
+        hyper.outer.num_el = numPosteriors;
+        hyper.outer.prob.assign(session.outer[c].begin(), session.outer[c].end());
+        hyper.inners.resize(NUMBER_SECRETS);
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            hyper.inners[i].assign(session.inners[c].begin() + i*numPosteriors, session.inners[c].begin() + (i+1)*numPosteriors);
+        data.hyperCache[c].build(data.channel[c]);
+        restored[NODE_HYPER_1+c] = true;
+    }
+
+    // Restored nodes are not computed here or in the background, the rest are submitted by the next frame
+    data.worker.cancel();
+    data.graph.markComputed(NODE_PRIOR);
+    for(int node = NODE_CHANNEL_1; node < NODE_CIRCLES; node++)
+        if(restored[node]) data.graph.markComputed(node);
+    for(int c = 0; c < NUMBER_CHANNELS; c++)
+        gui.posteriors.setNumPosteriors(c, restored[NODE_HYPER_1+c] ? data.hyper[c].num_post : 0);
+    if(mode == MODE_REF)
+        gui.updateChannelTextBoxes(data.channel[CHANNEL_3], CHANNEL_3);
+
+    // The circles are drawn from every hyper of the mode
+    for(int c = 0; c < NUMBER_CHANNELS; c++)
+        if(hyperUsed(c, mode) && !restored[NODE_HYPER_1+c]) return false;
+
+    if(!session.drawing)
+        return true;
+
+    // Circles are copied if they were saved with the same triangle, otherwise they are built from the hypers
+    bool sameTriangle = session.hasCircles;
+    for(int i = 0; i < 3 && sameTriangle; i++)
+        sameTriangle = session.trianglePoints[i].x == gui.visualization.trianglePoints[i].x &&
+                       session.trianglePoints[i].y == gui.visualization.trianglePoints[i].y;
+    for(int c = 0; c < NUMBER_CHANNELS && sameTriangle; c++)
+        sameTriangle = !hyperUsed(c, mode) || (int)session.innersCircles[c].size() == data.hyper[c].num_post;
+
+    gui.drawing = true;
+    data.animationRunning = false;
+    if(sameTriangle) data.priorCircle = session.priorCircle;
+    else data.buildPriorCircle(gui.visualization.trianglePoints);
+    gui.updateRectanglePriorCircleLabel(data.priorCircle);
+    gui.updatePriorTextBoxes(data.priorObj);
+
+    for(int c = 0; c < NUMBER_CHANNELS; c++){
+        if(!hyperUsed(c, mode)) continue;
+
+        if(sameTriangle){
+            data.innersCircles[c] = session.innersCircles[c];
+            data.innersHullValid[c] = false;
+            data.innersHullDirty[c] = true;
+            data.circlesVersion[c]++;
+        }else{
+            data.buildInnerCircles(gui.visualization.trianglePoints, c, mode);
         }
+        gui.updateRectangleInnersCircleLabel(c, data.innersCircles[c]);
     }
+    data.graph.markComputed(NODE_CIRCLES);
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------
 // Draw Functions Definitions (local)
 //------------------------------------------------------------------------------------
 void drawGuiMenu(Gui &gui, Data &data, bool* closeWindow){
-    DrawRectangleRec(gui.menu.recMenu, MENU_BASE_COLOR_NORMAL);
+    ProfileScope scope(PROFILE_DRAW_MENU);
+    gui.renderer->rectangle(gui.menu.recMenu, MENU_BASE_COLOR_NORMAL);
 
     GuiSetStyle(DEFAULT, BACKGROUND_COLOR, ColorToInt(MENU_BASE_COLOR_NORMAL));
     GuiSetStyle(DEFAULT, BASE_COLOR_DISABLED, ColorToInt(MENU_BASE_COLOR_NORMAL));
@@ -534,10 +859,10 @@ void drawGuiMenu(Gui &gui, Data &data, bool* closeWindow){
 
     // Button Mode
     if(gui.menu.dropdownBoxActive[BUTTON_MODE] == BUTTON_MODE_OPTION_SINGLE){
-        gui.channel.curChannel = CHANNEL_1;
+        gui.channel.selectChannel(CHANNEL_1);
         strcpy(gui.menu.buttonModeText, "Mode;#112#Single channel;#000#Two channels;#000#Refinement");
     }else if(gui.menu.dropdownBoxActive[BUTTON_MODE] == BUTTON_MODE_OPTION_TWO){
-        if(gui.channel.curChannel == CHANNEL_3) gui.channel.curChannel = CHANNEL_2;
+        if(gui.channel.curChannel == CHANNEL_3) gui.channel.selectChannel(CHANNEL_2);
         strcpy(gui.menu.buttonModeText, "Mode;#000#Single channel;#112#Two channels;#000#Refinement");
     }else if(gui.menu.dropdownBoxActive[BUTTON_MODE] == BUTTON_MODE_OPTION_REF){
         strcpy(gui.menu.buttonModeText, "Mode;#000#Single channel;#000#Two channels;#112#Refinement");
@@ -555,14 +880,15 @@ void drawGuiMenu(Gui &gui, Data &data, bool* closeWindow){
 }
 
 void drawGuiPrior(Gui &gui, Data &data){
+    ProfileScope scope(PROFILE_DRAW_PRIOR);
     // if(gui.drawing && gui.menu.dropdownBoxActive[BUTTON_MODE] != MODE_SINGLE)
     if(gui.drawing)
-        drawContentPanel(gui.prior.recTitle, gui.prior.recContent, gui.prior.panelPriorText, PRIOR_COLOR_L1, gui.defaultFont);
+        drawContentPanel(*gui.renderer, gui.prior.recTitle, gui.prior.recContent, gui.prior.panelPriorText, PRIOR_COLOR_L1, gui.defaultFont);
     else
-        drawContentPanel(gui.prior.recTitle, gui.prior.recContent, gui.prior.panelPriorText, GetColor(GuiGetStyle(DEFAULT, BASE_COLOR_NORMAL)), gui.defaultFont);
+        drawContentPanel(*gui.renderer, gui.prior.recTitle, gui.prior.recContent, gui.prior.panelPriorText, GetColor(GuiGetStyle(DEFAULT, BASE_COLOR_NORMAL)), gui.defaultFont);
 
-    DrawRectangleRec(gui.prior.recPanel, WHITE);
-    DrawRectangleLinesEx(gui.prior.recPanel, 1, GetColor(GuiGetStyle(DEFAULT, LINE_COLOR)));
+    gui.renderer->rectangle(gui.prior.recPanel, WHITE);
+    gui.renderer->rectangleLines(gui.prior.recPanel, 1, GetColor(GuiGetStyle(DEFAULT, LINE_COLOR)));
 
     GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, ColorToInt(TITLES_BASE_COLOR_DARKER));
     if(GuiButton(gui.prior.recButtonRandom, gui.prior.buttonRandomText)) buttonRandomPrior(gui, data); 
@@ -578,7 +904,21 @@ void drawGuiPrior(Gui &gui, Data &data){
     }
 }
 
+void drawChannelTextBox(Gui &gui, int i, int j){
+    int curChannel = gui.channel.curChannel;
+    Rectangle rec = gui.channel.recTextBoxChannel(i, j);
+    bool editMode = gui.channel.editRow == i && gui.channel.editCol == j;
+
+    if(curChannel == CHANNEL_3) GuiLock();
+    if(GuiTextBox((Rectangle){rec.x + gui.channel.ScrollPanelScrollOffset.x, rec.y + gui.channel.ScrollPanelScrollOffset.y, rec.width, rec.height}, gui.channel.TextBoxChannelText[curChannel][i][j], CHAR_BUFFER_SIZE, editMode)){
+        if(editMode) gui.channel.edit(-1, -1);
+        else gui.channel.edit(i, j);
+    }
+    if(curChannel == CHANNEL_3) GuiUnlock();
+}
+
 void drawGuiChannel(Gui &gui, Data &data){
+    ProfileScope scope(PROFILE_DRAW_CHANNEL);
     int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
     int curChannel = gui.channel.curChannel;
     Color contentColor = GetColor(GuiGetStyle(DEFAULT, BASE_COLOR_NORMAL));
@@ -588,7 +928,7 @@ void drawGuiChannel(Gui &gui, Data &data){
         gui.channel.recTitle = (Rectangle){gui.channel.AnchorChannel.x, gui.channel.AnchorChannel.y, 350, 20};
 
         if(gui.drawing) contentColor = INNERS1_COLOR_D1;
-        drawContentPanel(gui.channel.recTitle, gui.channel.recContent, gui.channel.panelChannelText, contentColor, gui.defaultFont);
+        drawContentPanel(*gui.renderer, gui.channel.recTitle, gui.channel.recContent, gui.channel.panelChannelText, contentColor, gui.defaultFont);
     }else{
         strcpy(gui.channel.panelChannelText, "");
         if(mode == MODE_TWO){
@@ -603,7 +943,7 @@ void drawGuiChannel(Gui &gui, Data &data){
             if(curChannel == CHANNEL_1) contentColor = INNERS1_COLOR_D1;
             else if(curChannel == CHANNEL_3 || (curChannel == CHANNEL_2 && mode == MODE_TWO)) contentColor = INNERS2_COLOR;
         }
-        drawContentPanel(gui.channel.recTitle, gui.channel.recContent, gui.channel.panelChannelText, contentColor, gui.defaultFont);
+        drawContentPanel(*gui.renderer, gui.channel.recTitle, gui.channel.recContent, gui.channel.panelChannelText, contentColor, gui.defaultFont);
 
         for(int i = 0; i < NUMBER_CHANNELS - (mode == MODE_TWO ? 1 : 0); i++)
             drawTab(gui, i, curChannel == i);
@@ -636,7 +976,7 @@ void drawGuiChannel(Gui &gui, Data &data){
             GuiSetStyle(VALUEBOX, TEXT_COLOR_PRESSED, ColorToInt(BLACK));
         }
 
-        if(GuiSpinner(gui.channel.recSpinner, gui.channel.LabelOutputsText, &(gui.channel.SpinnerChannelValue[curChannel]), 0, 50, gui.channel.SpinnerChannelEditMode)) gui.channel.SpinnerChannelEditMode = !gui.channel.SpinnerChannelEditMode;
+        if(GuiSpinner(gui.channel.recSpinner, gui.channel.LabelOutputsText, &(gui.channel.SpinnerChannelValue[curChannel]), 0, MAX_CHANNEL_OUTPUTS, gui.channel.SpinnerChannelEditMode)) gui.channel.SpinnerChannelEditMode = !gui.channel.SpinnerChannelEditMode;
         GuiSetStyle(BUTTON, BORDER_WIDTH, 0);
         GuiSetStyle(DEFAULT, TEXT_COLOR_NORMAL, ColorToInt(WHITE));
         GuiSetStyle(DEFAULT, TEXT_COLOR_FOCUSED, ColorToInt(WHITE));
@@ -655,38 +995,44 @@ void drawGuiChannel(Gui &gui, Data &data){
     );
     GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, ColorToInt(MENU_BASE_COLOR_NORMAL));
 
-    BeginScissorMode(viewScroll.x, viewScroll.y, viewScroll.width, viewScroll.height);
-        GuiLabel((Rectangle){gui.channel.recLabelOutputs.x + gui.channel.ScrollPanelScrollOffset.x, gui.channel.recLabelOutputs.y + gui.channel.ScrollPanelScrollOffset.y, gui.channel.recLabelOutputs.width, gui.channel.recLabelOutputs.height}, gui.channel.LabelOutputsText);
+    // Only the textboxes and labels inside the view are drawn and hit-tested
+    GridRange range = gui.channel.visibleTextBoxes(viewScroll);
+    Vector2 offset = gui.channel.ScrollPanelScrollOffset;
+
+    gui.renderer->beginScissor(viewScroll.x, viewScroll.y, viewScroll.width, viewScroll.height);
+        GuiLabel((Rectangle){gui.channel.recLabelOutputs.x + offset.x, gui.channel.recLabelOutputs.y + offset.y, gui.channel.recLabelOutputs.width, gui.channel.recLabelOutputs.height}, gui.channel.LabelOutputsText);
         // Secrets
-        for(int i = 0; i < gui.channel.numSecrets[curChannel]; i++){
+        for(int i = range.firstRow; i < range.lastRow; i++){
             if(mode == MODE_SINGLE || mode == MODE_TWO || curChannel == CHANNEL_1 || curChannel == CHANNEL_3){
-                GuiLabel((Rectangle){gui.channel.recLabelX[i].x + gui.channel.ScrollPanelScrollOffset.x, gui.channel.recLabelX[i].y + gui.channel.ScrollPanelScrollOffset.y, gui.channel.recLabelX[i].width, gui.channel.recLabelX[i].height}, gui.channel.LabelChannelXText[i].c_str());
+                GuiLabel((Rectangle){gui.channel.recLabelX[i].x + offset.x, gui.channel.recLabelX[i].y + offset.y, gui.channel.recLabelX[i].width, gui.channel.recLabelX[i].height}, gui.channel.LabelChannelXText[i].c_str());
             }else{
-                GuiLabel((Rectangle){gui.channel.recLabelX[i].x + gui.channel.ScrollPanelScrollOffset.x, gui.channel.recLabelX[i].y + gui.channel.ScrollPanelScrollOffset.y, gui.channel.recLabelX[i].width, gui.channel.recLabelX[i].height}, gui.channel.LabelChannelYText[i].c_str());
+                GuiLabel((Rectangle){gui.channel.recLabelX[i].x + offset.x, gui.channel.recLabelX[i].y + offset.y, gui.channel.recLabelX[i].width, gui.channel.recLabelX[i].height}, gui.channel.LabelChannelYText[i].c_str());
             }
 
-            for(int j = 0; j < gui.channel.numOutputs[curChannel]; j++){
-                if(curChannel == CHANNEL_3) GuiLock();
-                if(GuiTextBox((Rectangle){gui.channel.recTextBoxChannel[i][j].x + gui.channel.ScrollPanelScrollOffset.x, gui.channel.recTextBoxChannel[i][j].y + gui.channel.ScrollPanelScrollOffset.y, gui.channel.recTextBoxChannel[i][j].width, gui.channel.recTextBoxChannel[i][j].height}, gui.channel.TextBoxChannelText[curChannel][i][j], CHAR_BUFFER_SIZE, gui.channel.TextBoxChannelEditMode[i][j])) gui.channel.TextBoxChannelEditMode[i][j] = !gui.channel.TextBoxChannelEditMode[i][j];
-                if(curChannel == CHANNEL_3) GuiUnlock();
-            }
+            for(int j = range.firstCol; j < range.lastCol; j++)
+                drawChannelTextBox(gui, i, j);
         }
 
+        // The textbox in edit mode is processed even when it is out of the view, so it gets the keys and can be left
+        if(gui.channel.editing() && (gui.channel.editRow < range.firstRow || gui.channel.editRow >= range.lastRow ||
+                                     gui.channel.editCol < range.firstCol || gui.channel.editCol >= range.lastCol))
+            drawChannelTextBox(gui, gui.channel.editRow, gui.channel.editCol);
+
         // Outputs labels
-        if(curChannel == CHANNEL_1 || curChannel == CHANNEL_3){
-            for(int i = 0; i < gui.channel.numOutputs[curChannel]; i++)
-                GuiLabel((Rectangle){gui.channel.recLabelY[i].x + gui.channel.ScrollPanelScrollOffset.x, gui.channel.recLabelY[i].y + gui.channel.ScrollPanelScrollOffset.y, gui.channel.recLabelY[i].width, gui.channel.recLabelY[i].height}, gui.channel.LabelChannelYText[i].c_str());
-        }else if(curChannel == CHANNEL_2 && mode == MODE_TWO){
-            for(int i = 0; i < gui.channel.numOutputs[curChannel]; i++)
-                GuiLabel((Rectangle){gui.channel.recLabelY[i].x + gui.channel.ScrollPanelScrollOffset.x, gui.channel.recLabelY[i].y + gui.channel.ScrollPanelScrollOffset.y, gui.channel.recLabelY[i].width, gui.channel.recLabelY[i].height}, gui.channel.LabelChannelYPText[i].c_str());
-        }else if(curChannel == CHANNEL_2 && mode == MODE_REF){
-            for(int i = 0; i < gui.channel.numOutputs[curChannel]; i++)
-                GuiLabel((Rectangle){gui.channel.recLabelY[i].x + gui.channel.ScrollPanelScrollOffset.x, gui.channel.recLabelY[i].y + gui.channel.ScrollPanelScrollOffset.y, gui.channel.recLabelY[i].width, gui.channel.recLabelY[i].height}, gui.channel.LabelChannelYText[i].c_str());
+        vector<string> *labelsY = NULL;
+        if(curChannel == CHANNEL_1 || curChannel == CHANNEL_3) labelsY = &gui.channel.LabelChannelYText;
+        else if(curChannel == CHANNEL_2 && mode == MODE_TWO) labelsY = &gui.channel.LabelChannelYPText;
+        else if(curChannel == CHANNEL_2 && mode == MODE_REF) labelsY = &gui.channel.LabelChannelYText;
+
+        if(labelsY != NULL){
+            for(int j = range.firstCol; j < range.lastCol; j++)
+                GuiLabel((Rectangle){gui.channel.recLabelY[j].x + offset.x, gui.channel.recLabelY[j].y + offset.y, gui.channel.recLabelY[j].width, gui.channel.recLabelY[j].height}, (*labelsY)[j].c_str());
         }
-    EndScissorMode();
+    gui.renderer->endScissor();
 }
 
 void drawGuiPosteriors(Gui &gui, Data &data){
+    ProfileScope scope(PROFILE_DRAW_POSTERIORS);
     int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
     int curChannel = gui.channel.curChannel;
 
@@ -707,7 +1053,7 @@ void drawGuiPosteriors(Gui &gui, Data &data){
         if(curChannel == CHANNEL_1) contentColor = INNERS1_COLOR_D1;
         else if(curChannel == CHANNEL_3 || (curChannel == CHANNEL_2 && mode == MODE_TWO)) contentColor = INNERS2_COLOR;
     }
-    drawContentPanel(gui.posteriors.recTitle, gui.posteriors.recContent, gui.posteriors.GroupBoxPosteriorsText, contentColor, gui.defaultFont);
+    drawContentPanel(*gui.renderer, gui.posteriors.recTitle, gui.posteriors.recContent, gui.posteriors.GroupBoxPosteriorsText, contentColor, gui.defaultFont);
 
     GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, ColorToInt(MENU_BASE_COLOR_FOCUSED));
     Rectangle viewScrollPosteriors = GuiScrollPanel(
@@ -717,34 +1063,42 @@ void drawGuiPosteriors(Gui &gui, Data &data){
     );
     GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, ColorToInt(MENU_BASE_COLOR_NORMAL));
 
-    BeginScissorMode(viewScrollPosteriors.x, viewScrollPosteriors.y, viewScrollPosteriors.width, viewScrollPosteriors.height);
+    // Only the posteriors inside the view are drawn. The textboxes are read only, so they are never in edit mode.
+    GridRange range = gui.posteriors.visibleTextBoxes(viewScrollPosteriors, curChannel);
+    Vector2 offset = gui.posteriors.ScrollPanelPosteriorsScrollOffset;
+    Rectangle rec;
+
+    gui.renderer->beginScissor(viewScrollPosteriors.x, viewScrollPosteriors.y, viewScrollPosteriors.width, viewScrollPosteriors.height);
         if(mode != MODE_REF || curChannel != CHANNEL_2){
             GuiSetStyle(DEFAULT, TEXT_COLOR_FOCUSED, ColorToInt(BLACK));
-            GuiLabel((Rectangle){gui.posteriors.recLabelOuter.x + gui.posteriors.ScrollPanelPosteriorsScrollOffset.x, gui.posteriors.recLabelOuter.y + gui.posteriors.ScrollPanelPosteriorsScrollOffset.y, gui.posteriors.recLabelOuter.width, gui.posteriors.recLabelOuter.height}, gui.posteriors.LabelOuterText);
+            GuiLabel((Rectangle){gui.posteriors.recLabelOuter.x + offset.x, gui.posteriors.recLabelOuter.y + offset.y, gui.posteriors.recLabelOuter.width, gui.posteriors.recLabelOuter.height}, gui.posteriors.LabelOuterText);
 
-            for(int i = 0; i < gui.posteriors.numPosteriors[curChannel]; i++){
-                GuiLabel((Rectangle){gui.posteriors.recLabelPosteriors[i].x + gui.posteriors.ScrollPanelPosteriorsScrollOffset.x, gui.posteriors.recLabelPosteriors[i].y + gui.posteriors.ScrollPanelPosteriorsScrollOffset.y, gui.posteriors.recLabelPosteriors[i].width, gui.posteriors.recLabelPosteriors[i].height}, gui.posteriors.LabelPosteriorsText[curChannel][i].c_str());
-                GuiTextBox((Rectangle){gui.posteriors.recTextBoxOuter[i].x + gui.posteriors.ScrollPanelPosteriorsScrollOffset.x, gui.posteriors.recTextBoxOuter[i].y + gui.posteriors.ScrollPanelPosteriorsScrollOffset.y, gui.posteriors.recTextBoxOuter[i].width, gui.posteriors.recTextBoxOuter[i].height}, gui.posteriors.TextBoxOuterText[i], CHAR_BUFFER_SIZE, gui.posteriors.TextBoxOuterEditMode[i]);
+            for(int j = range.firstCol; j < range.lastCol; j++){
+                rec = gui.posteriors.recLabelPosteriors(j);
+                GuiLabel((Rectangle){rec.x + offset.x, rec.y + offset.y, rec.width, rec.height}, gui.posteriors.LabelPosteriorsText[curChannel][j].c_str());
+                rec = gui.posteriors.recTextBoxOuter(j);
+                GuiTextBox((Rectangle){rec.x + offset.x, rec.y + offset.y, rec.width, rec.height}, gui.posteriors.TextBoxOuterText[j], CHAR_BUFFER_SIZE, false);
             }
 
-            for(int i = 0; i < NUMBER_SECRETS; i++){
-                GuiLabel((Rectangle){gui.posteriors.recLabelX[i].x + gui.posteriors.ScrollPanelPosteriorsScrollOffset.x, gui.posteriors.recLabelX[i].y + gui.posteriors.ScrollPanelPosteriorsScrollOffset.y, gui.posteriors.recLabelX[i].width, gui.posteriors.recLabelX[i].height}, gui.posteriors.LabelPosteriorsXText[i].c_str());
-                for(int j = 0; j < gui.posteriors.numPosteriors[curChannel]; j++){
-                    GuiTextBox((Rectangle){gui.posteriors.recTextBoxInners[i][j].x + gui.posteriors.ScrollPanelPosteriorsScrollOffset.x, gui.posteriors.recTextBoxInners[i][j].y + gui.posteriors.ScrollPanelPosteriorsScrollOffset.y, gui.posteriors.recTextBoxInners[i][j].width, gui.posteriors.recTextBoxInners[i][j].height}, gui.posteriors.TextBoxInnersText[i][j], CHAR_BUFFER_SIZE, gui.posteriors.TextBoxInnersEditMode[i][j]);
+            for(int i = range.firstRow; i < range.lastRow; i++){
+                GuiLabel((Rectangle){gui.posteriors.recLabelX[i].x + offset.x, gui.posteriors.recLabelX[i].y + offset.y, gui.posteriors.recLabelX[i].width, gui.posteriors.recLabelX[i].height}, gui.posteriors.LabelPosteriorsXText[i].c_str());
+                for(int j = range.firstCol; j < range.lastCol; j++){
+                    rec = gui.posteriors.recTextBoxInners(i, j);
+                    GuiTextBox((Rectangle){rec.x + offset.x, rec.y + offset.y, rec.width, rec.height}, gui.posteriors.TextBoxInnersText[i][j], CHAR_BUFFER_SIZE, false);
                 }
             }
         }
-    EndScissorMode();
+    gui.renderer->endScissor();
 }
 
 void drawGuiVisualization(Gui &gui, Data &data){
-    drawContentPanel(gui.visualization.recTitle, gui.visualization.recContent, gui.visualization.GroupBoxVisualizationText, GetColor(GuiGetStyle(DEFAULT, BASE_COLOR_NORMAL)), gui.defaultFont);
+    ProfileScope scope(PROFILE_DRAW_VISUALIZATION);
+    drawContentPanel(*gui.renderer, gui.visualization.recTitle, gui.visualization.recContent, gui.visualization.GroupBoxVisualizationText, GetColor(GuiGetStyle(DEFAULT, BASE_COLOR_NORMAL)), gui.defaultFont);
     if(GuiButton(gui.visualization.recButtonDraw, gui.visualization.ButtonDrawText)) buttonDraw(gui, data);
     
     GuiSetStyle(TEXTBOX, TEXT_PADDING, 4);
     GuiSetStyle(DEFAULT, TEXT_ALIGNMENT, GUI_TEXT_ALIGN_LEFT);
-    if(data.error != NO_ERROR) DrawRectangleRec(gui.visualization.recTextBoxStatus, WHITE);
-    DrawRectangleRec(gui.visualization.recTextBoxStatus, WHITE);
+    gui.renderer->rectangle(gui.visualization.recTextBoxStatus, WHITE);
     
     if(strcmp(gui.visualization.TextBoxStatusText, "Status")) GuiSetStyle(TEXTBOX, TEXT_COLOR_NORMAL, ColorToInt(RED));
     GuiTextBox(gui.visualization.recTextBoxStatus, gui.visualization.TextBoxStatusText, CHAR_BUFFER_SIZE, gui.visualization.TextBoxStatusEditMode);
@@ -765,16 +1119,26 @@ void drawGuiVisualization(Gui &gui, Data &data){
         GuiSetStyle(CHECKBOX, TEXT_COLOR_PRESSED, ColorToInt(BLACK));
         gui.showLabels = GuiCheckBox(gui.visualization.recCheckboxShowLabels, gui.visualization.LabelCheckboxShowLabel, gui.showLabels);
         gui.showConvexHull = GuiCheckBox(gui.visualization.recCheckboxShowConvexHull, gui.visualization.LabelCheckboxShowConvexHull, gui.showConvexHull);
+        gui.showPriorCloud = GuiCheckBox(gui.visualization.recCheckboxShowPriorCloud, gui.visualization.LabelCheckboxShowPriorCloud, gui.showPriorCloud);
 
-        // Triangle
-        DrawTriangle(gui.visualization.trianglePoints[0], gui.visualization.trianglePoints[1], gui.visualization.trianglePoints[2], BG_BASE_COLOR_LIGHT2);
-        DrawTriangleLines(gui.visualization.trianglePoints[0], gui.visualization.trianglePoints[1], gui.visualization.trianglePoints[2], BLACK);
-        for(int i = 0; i < NUMBER_SECRETS; i++){
-            DrawTextEx(gui.defaultFontBig, &(gui.visualization.LabelTriangleText[i][0]), (Vector2){gui.visualization.recLabelTriangle[i].x, gui.visualization.recLabelTriangle[i].y}, 32, 0, BLACK);
-        }
+        // The heatmap shows a measure at a time, checking one of them unchecks the other
+        bool showVulnerability = GuiCheckBox(gui.visualization.recCheckboxShowVulnerability, gui.visualization.LabelCheckboxShowVulnerability, gui.heatmapMeasure == HEATMAP_VULNERABILITY);
+        bool showLeakage = GuiCheckBox(gui.visualization.recCheckboxShowLeakage, gui.visualization.LabelCheckboxShowLeakage, gui.heatmapMeasure == HEATMAP_LEAKAGE);
+        if(showVulnerability != (gui.heatmapMeasure == HEATMAP_VULNERABILITY)) gui.heatmapMeasure = showVulnerability ? HEATMAP_VULNERABILITY : HEATMAP_NONE;
+        else if(showLeakage != (gui.heatmapMeasure == HEATMAP_LEAKAGE)) gui.heatmapMeasure = showLeakage ? HEATMAP_LEAKAGE : HEATMAP_NONE;
+
+        // Triangle, with the heatmap below everything else in it
+        updateHeatmapTexture(gui, data);
+        gui.visualization.drawTriangle(*gui.renderer, data.heatmapImage, gui.defaultFont, gui.defaultFontBig);
         
         int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
 
+        // The cloud is drawn below the circles of the current prior
+        if(gui.showPriorCloud){
+            updatePriorCloudTexture(gui, data);
+            gui.visualization.drawPriorCloud(*gui.renderer, data.cloudImage);
+        }
+
         // Circles
         drawCirclePrior(gui, data);
         drawCirclesInners(gui, data, CHANNEL_1);
@@ -804,7 +1168,7 @@ void drawGettingStarted(Gui &gui){
         gui.menu.gsMenuActive = GuiListView(gui.menu.recGettingStartedMenu, gui.menu.gsMenuOptions, &gui.menu.gsMenuScrollIndex, gui.menu.gsMenuActive);
 
         // Visualization panel
-        DrawRectangleRec(gui.menu.recGettingStartedPanel, WHITE);
+        gui.renderer->rectangle(gui.menu.recGettingStartedPanel, WHITE);
         if(gui.menu.gsMenuActive > -1){
             drawGSContent(gui, gui.menu.recGettingStartedPanel, gui.menu.gsMenuActive, gui.menu.imgPadding[gui.menu.gsMenuActive]);
         }
@@ -812,83 +1176,64 @@ void drawGettingStarted(Gui &gui){
 }
 
 void drawCirclePrior(Gui &gui, Data &data){
-    DrawCircle(data.priorCircle.center.x, data.priorCircle.center.y, data.priorCircle.radius, PRIOR_COLOR);
-    DrawCircleLines(data.priorCircle.center.x, data.priorCircle.center.y, data.priorCircle.radius, PRIOR_COLOR_LINES);
-    if(gui.showLabels) DrawTextEx(gui.defaultFontBig, gui.visualization.LabelPriorCircleText, (Vector2) {gui.visualization.recLabelPriorCircle.x, gui.visualization.recLabelPriorCircle.y}, gui.defaultFontBig.baseSize, 1.0, BLACK);
+    gui.visualization.drawCirclePrior(*gui.renderer, data.priorCircle, gui.showLabels, gui.defaultFontBig);
 }
 
 void drawCirclesInners(Gui &gui, Data &data, int channel){
-	for(int i = 0; i < data.hyper[channel].num_post; i++){
-        Color colorFill, colorLines;
-        if(channel == CHANNEL_1){
-            colorFill = INNERS1_COLOR;
-            colorLines = INNERS1_COLOR_LINES;
-        }else{
-            colorFill = INNERS2_COLOR;
-            colorLines = INNERS2_COLOR_LINES;
-        }
+    // The hull is cached in data and only recomputed when the inners circles move
+    if(gui.showConvexHull) data.updateInnersHull(channel);
+    gui.visualization.drawCirclesInners(*gui.renderer, channel, data.innersCircles[channel], data.hyper[channel].num_post, data.circlesVersion[channel],
+        gui.showConvexHull ? &data.innersHull[channel] : NULL, data.hyper[channel].outer, gui.showLabels ? &gui.posteriors.LabelPosteriorsText[channel] : NULL, gui.defaultFontBig);
+}
 
-        DrawCircle(data.innersCircles[channel][i].center.x, data.innersCircles[channel][i].center.y, data.innersCircles[channel][i].radius, colorFill);
-        DrawCircleLines(data.innersCircles[channel][i].center.x, data.innersCircles[channel][i].center.y, data.innersCircles[channel][i].radius, colorLines);
-        
-        // Decide to write label inside or outside the circle
-        float threshold;
-        if(channel == CHANNEL_1)
-            threshold = 0.13f;
-        else
-            threshold = 0.20f;
-        
-        if(gui.showLabels){
-            if(data.hyper[channel].outer.prob[i] < threshold)
-                DrawTextEx(gui.defaultFontBig, &(gui.posteriors.LabelPosteriorsText[channel][i][0]), (Vector2) {gui.visualization.recLabelInnersCircles[channel][i].x-25, gui.visualization.recLabelInnersCircles[channel][i].y-25}, 26, 1.0, BLACK);
-            else
-                DrawTextEx(gui.defaultFontBig, &(gui.posteriors.LabelPosteriorsText[channel][i][0]), (Vector2) {gui.visualization.recLabelInnersCircles[channel][i].x-5, gui.visualization.recLabelInnersCircles[channel][i].y-5}, 26, 1.0, BLACK);
+void updateHeatmapTexture(Gui &gui, Data &data){
+    HeatmapImage &image = data.heatmapImage;
+    if(image.level < 0)
+        return;
+
+    Texture2D &texture = gui.visualization.heatmapTexture;
+
+    // Each level is uploaded once, and the texture is created again only when its size changes (i.e. from a level to the next one)
+    if(gui.visualization.heatmapTextureGeneration != image.generation || gui.visualization.heatmapTextureLevel != image.level){
+        if(texture.id == 0 || texture.width != image.width || texture.height != image.height){
+            if(texture.id != 0) UnloadTexture(texture);
+            Image pixels = {image.pixels.data(), image.width, image.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            texture = LoadTextureFromImage(pixels);
+            SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+        }else{
+            UpdateTexture(texture, image.pixels.data());
         }
+        gui.visualization.heatmapTextureGeneration = image.generation;
+        gui.visualization.heatmapTextureLevel = image.level;
 
-        if(gui.showConvexHull){
-            // Find convex hull using inners circles
-            vector<pt> points = vector<pt>(gui.posteriors.numPosteriors[channel]);
-            for(int i = 0; i < gui.posteriors.numPosteriors[channel]; i++){
-                points[i].x = data.innersCircles[channel][i].center.x;
-                points[i].y = data.innersCircles[channel][i].center.y;
-            }
+        snprintf(gui.visualization.LabelHeatmapText, CHAR_BUFFER_SIZE, "%s from %.3f to %.3f",
+            image.measure == HEATMAP_LEAKAGE ? "Leakage" : "Vulnerability", image.minValue, image.maxValue);
+    }
+}
 
-            convexHull(points);
-            int n = (int) points.size();
-            for(int i = 0; i < n-1; i++){
-                if(channel == CHANNEL_1){
-                    DrawLine(points[i].x, points[i].y, points[i+1].x, points[i+1].y, INNERS1_COLOR_LINES);
-                    DrawTriangle(
-                        (Vector2){(float)points[0].x, (float)points[0].y},
-                        (Vector2){(float)points[i].x, (float)points[i].y},
-                        (Vector2){(float)points[i+1].x, (float)points[i+1].y},
-                        CH1_COLOR
-                    );
-                }else{
-                    DrawLine(points[i].x, points[i].y, points[i+1].x, points[i+1].y, INNERS2_COLOR_LINES);
-                    DrawTriangle(
-                        (Vector2){(float)points[0].x, (float)points[0].y},
-                        (Vector2){(float)points[i].x, (float)points[i].y},
-                        (Vector2){(float)points[i+1].x, (float)points[i+1].y},
-                        CH2_COLOR
-                    );
-                }
+void updatePriorCloudTexture(Gui &gui, Data &data){
+    PriorCloudImage &image = data.cloudImage;
+    if(image.generation == 0)
+        return;
 
-            }
+    Texture2D &texture = gui.visualization.cloudTexture;
 
-            // Line from last point to the first
-            if(channel == CHANNEL_1)
-                DrawLine(points[n-1].x, points[n-1].y, points[0].x, points[0].y, INNERS1_COLOR_LINES);
-            else
-                DrawLine(points[n-1].x, points[n-1].y, points[0].x, points[0].y, INNERS2_COLOR_LINES);
+    // Each image is uploaded once, and the texture is created again only when its size changes
+    if(gui.visualization.cloudTextureGeneration != image.generation){
+        if(texture.id == 0 || texture.width != image.width || texture.height != image.height){
+            if(texture.id != 0) UnloadTexture(texture);
+            Image pixels = {image.pixels.data(), image.width, image.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+            texture = LoadTextureFromImage(pixels);
+            SetTextureFilter(texture, TEXTURE_FILTER_BILINEAR);
+        }else{
+            UpdateTexture(texture, image.pixels.data());
         }
-	}
+        gui.visualization.cloudTextureGeneration = image.generation;
+    }
 }
 
-void drawContentPanel(Rectangle layoutTitle, Rectangle layoutContent, char *title, Color contentColor, Font font){
-    DrawRectangleRec(layoutTitle, TITLES_BASE_COLOR);
-    DrawRectangleRec(layoutContent, contentColor);
-    DrawTextEx(font, title, (Vector2){layoutTitle.x + 10, layoutTitle.y}, font.baseSize, 1, GetColor(GuiGetStyle(DEFAULT, TEXT_COLOR_NORMAL)));
+void drawContentPanel(Renderer &renderer, Rectangle layoutTitle, Rectangle layoutContent, char *title, Color contentColor, Font font){
+    renderer.panel(layoutTitle, layoutContent, title, contentColor, GetColor(GuiGetStyle(DEFAULT, TEXT_COLOR_NORMAL)), font);
 }
 
 void drawGSContent(Gui &gui, Rectangle panel, int option, int imgPadding){
@@ -915,7 +1260,7 @@ void drawGSContent(Gui &gui, Rectangle panel, int option, int imgPadding){
         &(gui.menu.ScrollPanelScrollOffset)
     );
     
-    BeginScissorMode(viewScroll.x, viewScroll.y, viewScroll.width, viewScroll.height);
+    gui.renderer->beginScissor(viewScroll.x, viewScroll.y, viewScroll.width, viewScroll.height);
         GuiTextBoxMulti(
             (Rectangle){panel.x+10+gui.menu.ScrollPanelScrollOffset.x, panel.y+10+gui.menu.ScrollPanelScrollOffset.y, panel.width-30, (float)gui.menu.gsContentHeight[option]},
             gui.menu.gsDescriptionTexts[option],
@@ -925,9 +1270,9 @@ void drawGSContent(Gui &gui, Rectangle panel, int option, int imgPadding){
         
         // Image
         if(strcmp(gui.menu.imagesSrc[option], "")){
-            DrawTextureEx(gui.menu.gsImages[option], (Vector2){panel.x+10+gui.menu.ScrollPanelScrollOffset.x, panel.y+imgPadding+gui.menu.ScrollPanelScrollOffset.y}, 0.0f, 0.43f, WHITE);
+            gui.renderer->texture(gui.menu.gsImages[option], (Vector2){panel.x+10+gui.menu.ScrollPanelScrollOffset.x, panel.y+imgPadding+gui.menu.ScrollPanelScrollOffset.y}, 0.43f, WHITE);
         }
-    EndScissorMode();
+    gui.renderer->endScissor();
 
 
     initStyle();
@@ -1005,53 +1350,59 @@ void buttonFile(Gui &gui, Data &data, bool* closeWindow){
 
     if(option == BUTTON_FILE_OPTION_OPEN){
         gui.drawing = false;
-        int retRead = gui.menu.readQIFFile(gui.prior.TextBoxPriorText, gui.channel.TextBoxChannelText, gui.channel.numSecrets, gui.channel.numOutputs);
+        // The sizes read are set through GuiChannel::reserve, the channels not in the file keep theirs
+        int numSecrets[NUMBER_CHANNELS], numOutputs[NUMBER_CHANNELS];
+        for(int channel = 0; channel < NUMBER_CHANNELS; channel++){
+            numSecrets[channel] = gui.channel.numSecrets[channel];
+            numOutputs[channel] = gui.channel.numOutputs[channel];
+        }
+        int retRead = gui.menu.readQIFFile(gui.prior.TextBoxPriorText, gui.channel.TextBoxChannelText, numSecrets, numOutputs);
 
         if(retRead == INVALID_QIF_FILE){
             // Open a dialog error
-            system("zenity --error --no-wrap --text=\"Invalid QIF graphics file\"");
+            string command = "zenity --error --no-wrap --text=\"Invalid QIF graphics file (" + gui.menu.fileErrorString() + ")\"";
+            system(command.c_str());
         }else{
+            // Textboxes for the new sizes
+            for(int channel = 0; channel < NUMBER_CHANNELS; channel++)
+                gui.channel.reserve(channel, numSecrets[channel], numOutputs[channel]);
+
             // Update channels spinners
             gui.channel.SpinnerChannelValue[CHANNEL_1] = gui.channel.numOutputs[CHANNEL_1];
             gui.channel.SpinnerChannelValue[CHANNEL_2] = gui.channel.numOutputs[CHANNEL_2];
             
-            // Reset prior
-            data.ready[FLAG_PRIOR] = false;
-            data.compute[FLAG_PRIOR] = true;
-
-            // Reset channels
-            data.resetAllExceptComputeChannel1();
+            // The prior and the channels come from the textboxes
+            data.setMode(retRead);
+            data.graph.touch(NODE_PRIOR);
+            data.graph.touch(NODE_CHANNEL_1);
+            data.graph.touch(NODE_CHANNEL_2);
 
             for(int channel = 0; channel < NUMBER_CHANNELS; channel++)
-                gui.posteriors.resetPosterior(FLAG_CHANNEL_1+channel);
+                gui.posteriors.resetPosterior(channel);
 
             // Update current mode
             gui.channel.checkModeAndSizes(retRead);
             gui.menu.dropdownBoxActive[BUTTON_MODE] = retRead;
 
-            if(retRead == MODE_TWO) data.compute[FLAG_CHANNEL_2] = true;
+            // A session brings the computed objects. If they can not be used, the touched nodes are computed from the text as usual.
+            if(gui.menu.isSessionFile())
+                restoreSession(gui, data, gui.menu.session);
 
             updateStatusBar(NO_ERROR, gui.visualization);
         }
+    }else if(option == BUTTON_FILE_OPTION_OPEN_CLOUD){
+        unsigned long version = data.cloud.version;
+        if(gui.menu.readPriorCloudFile(data.cloud) == INVALID_PRIOR_CLOUD_FILE){
+            string command = "zenity --error --no-wrap --text=\"Invalid prior cloud file (line " + to_string(data.cloud.errorLine) + ")\"";
+            system(command.c_str());
+        }else if(data.cloud.version != version){
+            gui.showPriorCloud = true;
+        }
     }else if(option == BUTTON_FILE_OPTION_SAVE){
-        gui.menu.saveQIFFile(
-            gui.prior.TextBoxPriorText,
-            gui.channel.TextBoxChannelText,
-            gui.channel.numSecrets,
-            gui.channel.numOutputs,
-            gui.menu.dropdownBoxActive[BUTTON_MODE],
-            strcmp(gui.menu.fileName, "\0") == 0 ? true : false
-        );
+        saveFile(gui, data, strcmp(gui.menu.fileName, "\0") == 0 ? true : false);
         if(strcmp(gui.menu.fileName, "\0")) data.fileSaved = true;   
     }else if(option == BUTTON_FILE_OPTION_SAVEAS){
-        gui.menu.saveQIFFile(
-            gui.prior.TextBoxPriorText,
-            gui.channel.TextBoxChannelText,
-            gui.channel.numSecrets,
-            gui.channel.numOutputs,
-            gui.menu.dropdownBoxActive[BUTTON_MODE],
-            true
-        );
+        saveFile(gui, data, true);
         if(strcmp(gui.menu.fileName, "\0")) data.fileSaved = true;
     }else if(option == BUTTON_FILE_OPTION_EXIT){
         if(data.fileSaved){
@@ -1063,14 +1414,7 @@ void buttonFile(Gui &gui, Data &data, bool* closeWindow){
 
             if(ret == 0){
                 // Yes
-                gui.menu.saveQIFFile(
-                    gui.prior.TextBoxPriorText,
-                    gui.channel.TextBoxChannelText,
-                    gui.channel.numSecrets,
-                    gui.channel.numOutputs,
-                    gui.menu.dropdownBoxActive[BUTTON_MODE],
-                    strcmp(gui.menu.fileName, "\0") == 0 ? true : false
-                );
+                saveFile(gui, data, strcmp(gui.menu.fileName, "\0") == 0 ? true : false);
                 if(strcmp(gui.menu.fileName, "\0")){
                     data.fileSaved = true;
                     *closeWindow = true;  
@@ -1095,14 +1439,10 @@ void buttonMode(Gui &gui, Data &data, int* prevMode){
         gui.drawing = false;
         updateStatusBar(NO_ERROR, gui.visualization);
 
-        // Set prior to be computed
-        data.ready[FLAG_PRIOR] = false;
-        data.compute[FLAG_PRIOR] = true;
-
-        data.resetAllExceptComputeChannel1();
-
-        if(curMode == MODE_TWO)
-            data.compute[FLAG_CHANNEL_2] = true;
+        // Only the nodes used in the new mode are computed. Channel 2 is read again because
+        // its text is the channel D in MODE_TWO and the channel R in MODE_REF.
+        data.setMode(curMode);
+        data.graph.touch(NODE_CHANNEL_2);
     }
 
     *prevMode = curMode;
@@ -1121,10 +1461,9 @@ void buttonExamples(Gui &gui, Data &data){
     if(gui.menu.dropdownBoxActive[BUTTON_MODE] == MODE_REF && curChannel == CHANNEL_3)
         return;
 
-    char newChannel[MAX_CHANNEL_OUTPUTS][MAX_CHANNEL_OUTPUTS][CHAR_BUFFER_SIZE];
-
     gui.channel.SpinnerChannelValue[curChannel] = (example == BUTTON_EXAMPLES_OPTION_CH_0) ? gui.channel.numSecrets[curChannel] : 1;    
     gui.channel.updateChannelBySpinner(gui.channel.curChannel, gui.menu.dropdownBoxActive[BUTTON_MODE]);
+    TextGrid &newChannel = gui.channel.TextBoxChannelText[curChannel];
 
     if(example == BUTTON_EXAMPLES_OPTION_CH_0){
         // Set identity matrix
@@ -1143,13 +1482,11 @@ void buttonExamples(Gui &gui, Data &data){
         }
     }
 
-    GuiChannel::copyChannelText(newChannel, gui.channel.TextBoxChannelText[curChannel], gui.channel.numSecrets[curChannel], gui.channel.numOutputs[curChannel]);
-    if(gui.menu.dropdownBoxActive[BUTTON_MODE] == MODE_REF){
-        data.resetAllExceptComputeChannel1();
-    }else{
-        data.compute[FLAG_CHANNEL_1+curChannel] = true;
-        data.ready[FLAG_CHANNEL_1+curChannel] = false;
-    }
+    data.graph.touch(NODE_CHANNEL_1+curChannel);
+
+    // The spinner of channel 1 also sets the number of secrets of channel R
+    if(gui.menu.dropdownBoxActive[BUTTON_MODE] == MODE_REF && curChannel == CHANNEL_1)
+        data.graph.touch(NODE_CHANNEL_2);
     gui.drawing = false;
 }
 
@@ -1161,37 +1498,14 @@ void buttonRandomPrior(Gui &gui, Data &data){
     data.newRandomPrior();
     gui.drawing = false;
     data.fileSaved = false;
-    data.compute[FLAG_PRIOR] = false;
-    data.ready[FLAG_PRIOR] = true;
     gui.updatePriorTextBoxes(data.priorObj);
-    
-    int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
-    
-    // Reset channel 1 and set it to be computed
-    data.ready[FLAG_CHANNEL_1] = false;
-    data.compute[FLAG_CHANNEL_1] = true;
-    data.ready[FLAG_HYPER_1] = false;
-    data.compute[FLAG_HYPER_1] = false;
-
-    if(mode == MODE_TWO || mode == MODE_REF){
-        // Reset channel 2 and set it to be computed
-        data.ready[FLAG_CHANNEL_2] = false;
-        data.compute[FLAG_CHANNEL_2] = true;
-        data.ready[FLAG_HYPER_2] = false;
-        data.compute[FLAG_HYPER_2] = false;
-    }
 
-    if(mode == MODE_REF){
-        // Reset channel 3
-        data.ready[FLAG_CHANNEL_3] = false;
-        data.compute[FLAG_CHANNEL_3] = false;
-        data.ready[FLAG_HYPER_3] = false;
-        data.compute[FLAG_HYPER_3] = false;
-    }
+    // The prior is already computed, the channels are rebuilt with it in the next frame
+    data.graph.update(NODE_PRIOR, NO_ERROR);
 }
 
 void buttonsTabs(Gui &gui, int channel){
-    gui.channel.curChannel = channel;
+    gui.channel.selectChannel(channel);
     updateStatusBar(NO_ERROR, gui.visualization);
 }
 
@@ -1203,26 +1517,24 @@ void buttonRandomChannel(Gui &gui, Data &data){
     gui.drawing = false;
     data.fileSaved = false;
     gui.channel.updateChannelTextBoxes(data.channel[gui.channel.curChannel]);
-
-    if(gui.menu.dropdownBoxActive[BUTTON_MODE] == MODE_REF){
-        data.resetAllExceptComputeChannel1();
-    }else{
-        data.compute[FLAG_CHANNEL_1+gui.channel.curChannel] = true;
-        data.ready[FLAG_CHANNEL_1+gui.channel.curChannel] = false;
-    }
+    data.graph.touch(NODE_CHANNEL_1+gui.channel.curChannel);
 }
 
 void buttonDraw(Gui &gui, Data &data){
     int mode = gui.menu.dropdownBoxActive[BUTTON_MODE];
+    if(data.graph.computing()){
+        updateStatusBar(STATUS_COMPUTING, gui.visualization);
+        return;
+    }
+
     if(mode == MODE_SINGLE){
-        if(!data.ready[FLAG_HYPER_1]){
+        if(!data.graph.ready(NODE_HYPER_1)){
             updateStatusBar(data.error, gui.visualization);
             return;
         }
 
         gui.drawing = true;
-        data.animationRunning = true;
-        data.animation = STEPS;
+        data.startAnimation(data.now);
 
         data.buildPriorCircle(gui.visualization.trianglePoints);
         gui.updateRectanglePriorCircleLabel(data.priorCircle);
@@ -1231,14 +1543,13 @@ void buttonDraw(Gui &gui, Data &data){
         data.buildInnerCircles(gui.visualization.trianglePoints, CHANNEL_1, mode);
         gui.updateRectangleInnersCircleLabel(CHANNEL_1, data.innersCircles[CHANNEL_1]);
     }else if(mode == MODE_TWO){
-        if(!data.ready[FLAG_HYPER_1] || !data.ready[FLAG_HYPER_2]){
+        if(!data.graph.ready(NODE_HYPER_1) || !data.graph.ready(NODE_HYPER_2)){
             updateStatusBar(data.error, gui.visualization);
             return;
         }
 
         gui.drawing = true;
-        data.animationRunning = true;
-        data.animation = 2*STEPS+1;
+        data.startAnimation(data.now);
 
         data.buildPriorCircle(gui.visualization.trianglePoints);
         gui.updateRectanglePriorCircleLabel(data.priorCircle);
@@ -1250,14 +1561,13 @@ void buttonDraw(Gui &gui, Data &data){
         data.buildInnerCircles(gui.visualization.trianglePoints, CHANNEL_2, mode);
         gui.updateRectangleInnersCircleLabel(CHANNEL_2, data.innersCircles[CHANNEL_2]);
     }else if(mode == MODE_REF){
-        if(!data.ready[FLAG_HYPER_1] || !data.ready[FLAG_HYPER_3]){
+        if(!data.graph.ready(NODE_HYPER_1) || !data.graph.ready(NODE_HYPER_3)){
             updateStatusBar(data.error, gui.visualization);
             return;
         }
 
         gui.drawing = true;
-        data.animationRunning = true;
-        data.animation = 2*STEPS+1;
+        data.startAnimation(data.now);
 
         data.buildPriorCircle(gui.visualization.trianglePoints);
         gui.updateRectanglePriorCircleLabel(data.priorCircle);
@@ -1269,4 +1579,6 @@ void buttonDraw(Gui &gui, Data &data){
         data.buildInnerCircles(gui.visualization.trianglePoints, CHANNEL_3, mode);
         gui.updateRectangleInnersCircleLabel(CHANNEL_3, data.innersCircles[CHANNEL_3]);
     }
+
+    data.graph.update(NODE_CIRCLES, NO_ERROR);
 }
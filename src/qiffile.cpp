@@ -0,0 +1,260 @@
+#include "qiffile.h"
+#include <cstring>
+
+#if !defined(PLATFORM_WEB) && !defined(_WIN32)
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#define QIF_FILE_MMAP
+#else
+	#include <cstdio>
+#endif
+
+// Whitespace separated tokens of a file, with their position
+class Tokenizer{
+public:
+	const char *cur;
+	const char *end;
+	int line;
+	int column;
+
+	// Position of the last token
+	const char *tokenBegin;
+	const char *tokenEnd;
+	int tokenLine;
+	int tokenColumn;
+
+	Tokenizer(const char *data, long size){
+		cur = data;
+		end = data + size;
+		line = column = 1;
+		tokenBegin = tokenEnd = data;
+		tokenLine = tokenColumn = 1;
+	}
+
+	// Move to the next token. Returns false at the end of the file.
+	bool next(){
+		while(cur < end && isspace((unsigned char)*cur)){
+			if(*cur == '\n'){
+				line++;
+				column = 1;
+			}else{
+				column++;
+			}
+			cur++;
+		}
+
+		tokenLine = line;
+		tokenColumn = column;
+		tokenBegin = cur;
+		while(cur < end && !isspace((unsigned char)*cur)){
+			cur++;
+			column++;
+		}
+		tokenEnd = cur;
+
+		return tokenBegin < tokenEnd;
+	}
+
+	bool equals(const char *word){
+		long size = strlen(word);
+		return tokenEnd - tokenBegin == size && memcmp(tokenBegin, word, size) == 0;
+	}
+
+	// Convert the token to a non-negative integer
+	bool toInt(int &value){
+		if(tokenEnd - tokenBegin > 9) return false;
+
+		value = 0;
+		for(const char *c = tokenBegin; c < tokenEnd; c++){
+			if(!isdigit((unsigned char)*c)) return false;
+			value = 10*value + (*c - '0');
+		}
+		return true;
+	}
+};
+
+QIFFile::QIFFile(){
+    mode = MODE_SINGLE;
+    for(int i = 0; i < NUMBER_CHANNELS; i++){
+        numSecrets[i] = 0;
+        numOutputs[i] = 0;
+    }
+    error.line = error.column = 0;
+    error.message = "";
+}
+
+int QIFFile::read(const string &fileName){
+    error.line = error.column = 0;
+
+#if defined(QIF_FILE_MMAP)
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0){
+        error.message = "could not open the file";
+        return INVALID_QIF_FILE;
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)){
+        close(fd);
+        error.message = "could not open the file";
+        return INVALID_QIF_FILE;
+    }
+
+    // An empty file can not be mapped
+    if(st.st_size == 0){
+        close(fd);
+        return parse("", 0);
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED){
+        error.message = "could not read the file";
+        return INVALID_QIF_FILE;
+    }
+
+    int ret = parse((const char*)data, st.st_size);
+    munmap(data, st.st_size);
+    return ret;
+#else
+    // Without mmap the file is read at once into a heap buffer
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if(file == NULL){
+        error.message = "could not open the file";
+        return INVALID_QIF_FILE;
+    }
+
+    vector<char> data;
+    char buffer[4096];
+    size_t n;
+    while((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + n);
+    fclose(file);
+
+    return parse(data.data(), data.size());
+#endif
+}
+
+// Set the error at the position of the last token and return INVALID_QIF_FILE
+static int fail(QIFFileError &error, Tokenizer &tokens, const char *message){
+    error.line = tokens.tokenLine;
+    error.column = tokens.tokenColumn;
+    error.message = message;
+    return INVALID_QIF_FILE;
+}
+
+// Read the next token as a value and convert it
+static bool readValue(Tokenizer &tokens, vector<char> &text, QIFValue &value){
+    if(!tokens.next() || tokens.tokenEnd - tokens.tokenBegin >= CHAR_BUFFER_SIZE)
+        return false;
+
+    value.text = text.size();
+    text.insert(text.end(), tokens.tokenBegin, tokens.tokenEnd);
+    text.push_back('\0');
+    value.valid = text2Value(tokens.tokenBegin, tokens.tokenEnd, value.value);
+    if(!value.valid)
+        value.value = 0;
+    return true;
+}
+
+// Text of the value of a macro, so the messages follow the constants they describe
+#define QIF_STR(x) #x
+#define QIF_XSTR(x) QIF_STR(x)
+
+// Message of a value that could not be read
+static const char* valueError(Tokenizer &tokens){
+    return tokens.tokenBegin == tokens.tokenEnd ? "unexpected end of file" : "value is too long";
+}
+
+int QIFFile::parse(const char *data, long size){
+    Tokenizer tokens(data, size);
+    int bufferInt;
+
+    text.clear();
+    // Every value takes at most its text plus the terminator, so the text buffer is not reallocated while the values are read
+    text.reserve(size + 1);
+    error.line = error.column = 0;
+    error.message = "";
+
+    // Mode
+    if(!tokens.next() || !tokens.equals("mode")) return fail(error, tokens, "expected 'mode'");
+    if(!tokens.next() || !tokens.toInt(mode)) return fail(error, tokens, "expected the mode number");
+    if(mode != MODE_SINGLE && mode != MODE_TWO && mode != MODE_REF) return fail(error, tokens, "mode must be 1, 2 or 3");
+
+    // Prior
+    if(!tokens.next() || !tokens.equals("prior")) return fail(error, tokens, "expected 'prior'");
+    if(!tokens.next() || !tokens.toInt(bufferInt) || bufferInt != NUMBER_SECRETS) return fail(error, tokens, "prior must have " QIF_XSTR(NUMBER_SECRETS) " values");
+
+    prior.resize(NUMBER_SECRETS);
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        if(!readValue(tokens, text, prior[i])) return fail(error, tokens, valueError(tokens));
+
+    // Channels
+    int numChannels = (mode == MODE_TWO || mode == MODE_REF) ? 2 : 1;
+    const char *names[2] = {"channel1", "channel2"};
+    numSecrets[CHANNEL_2] = numOutputs[CHANNEL_2] = 0;
+    channel[CHANNEL_2].clear();
+
+    for(int c = 0; c < numChannels; c++){
+        if(!tokens.next() || !tokens.equals(names[c])) return fail(error, tokens, c == CHANNEL_1 ? "expected 'channel1'" : "expected 'channel2'");
+
+        if(!tokens.next() || !tokens.toInt(numSecrets[c])) return fail(error, tokens, "expected the number of rows");
+        if(c == CHANNEL_1 || mode == MODE_TWO){
+            if(numSecrets[c] != NUMBER_SECRETS) return fail(error, tokens, "the channel must have " QIF_XSTR(NUMBER_SECRETS) " rows");
+        }else if(numSecrets[c] != numOutputs[CHANNEL_1]){
+            return fail(error, tokens, "the number of rows of channel2 must be the number of columns of channel1");
+        }
+
+        if(!tokens.next() || !tokens.toInt(numOutputs[c])) return fail(error, tokens, "expected the number of columns");
+        if(numOutputs[c] < 1) return fail(error, tokens, "the channel must have at least 1 column");
+        if(numOutputs[c] > MAX_CHANNEL_OUTPUTS) return fail(error, tokens, "too many columns");
+
+        // Every value takes at least a character and a separator, so a header larger than the rest
+        // of the file is rejected before its values are allocated
+        long numValues = (long)numSecrets[c]*numOutputs[c];
+        if(2*numValues - 1 > (long)(tokens.end - tokens.cur)) return fail(error, tokens, "the file is shorter than the channel");
+
+        channel[c].resize(numValues);
+        for(long k = 0; k < numValues; k++)
+            if(!readValue(tokens, text, channel[c][k])) return fail(error, tokens, valueError(tokens));
+    }
+
+    return mode;
+}
+
+const char* QIFFile::valueText(const QIFValue &value) const{
+    return text.data() + value.text;
+}
+
+const QIFValue& QIFFile::value(int channel, int i, int j) const{
+    return this->channel[channel][i*numOutputs[channel] + j];
+}
+
+void QIFFile::copyText(
+    char prior[NUMBER_SECRETS][CHAR_BUFFER_SIZE],
+    TextGrid channel[NUMBER_CHANNELS],
+    int numSecrets[NUMBER_CHANNELS],
+    int numOutputs[NUMBER_CHANNELS]
+    ) const{
+
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        strcpy(prior[i], valueText(this->prior[i]));
+
+    int numChannels = (mode == MODE_TWO || mode == MODE_REF) ? 2 : 1;
+    for(int c = 0; c < numChannels; c++){
+        numSecrets[c] = this->numSecrets[c];
+        numOutputs[c] = this->numOutputs[c];
+        channel[c].reserve(numSecrets[c], numOutputs[c], TEXT_ZERO);
+        for(int i = 0; i < numSecrets[c]; i++)
+            for(int j = 0; j < numOutputs[c]; j++)
+                strcpy(channel[c][i][j], valueText(value(c, i, j)));
+    }
+}
+
+string QIFFile::errorString() const{
+    if(error.line == 0)
+        return string(error.message);
+    return "line " + to_string(error.line) + ", column " + to_string(error.column) + ": " + error.message;
+}
@@ -0,0 +1,95 @@
+#ifndef _qiffile
+#define _qiffile
+
+#include "graphics.h"
+
+/* Contents of a .qifg file.
+
+    Mode single channel:     |  Mode two channels:       |  Mode refinement:
+    -----BEGIN OF FILE-----  |  -----BEGIN OF FILE-----  |  -----BEGIN OF FILE-----
+    mode 1                   |  mode 2                   |  mode 3
+    prior 3                  |  prior 3                  |  prior 3
+    p1 p2 p3                 |  p1 p2 p3                 |  p1 p2 p3
+    channel1 3 m             |  channel1 3 m             |  channel1 3 m
+    p11 p12 ... p1m          |  p11 p12 ... p1m          |  p11 p12 ... p1m
+    p21 p22 ... p2m          |  p21 p22 ... p2m          |  p21 p22 ... p2m
+    p31 p32 ... p3m          |  p31 p32 ... p3m          |  p31 p32 ... p3m
+    -----END OF FILE-----    |  channel2 3 m'            |  channel2 m m'
+                             |  p11 p12 ... p1m'         |  p11 p12 ... p1m'
+                             |  p21 p22 ... p2m'         |  p21 p22 ... p2m'
+                             |  p31 p32 ... p3m'         |  ...
+                             |  -----END OF FILE-----    |  pm1 pm2 ... pmm'
+                             |                           |  -----END OF FILE-----
+
+ * The file is memory-mapped and read in a single pass. Each value keeps the text
+ * typed by the user (for the textboxes) and its conversion. A value that is not
+ * a number does not make the file invalid, it is reported when the prior or the
+ * channel is checked, as it happens when it is typed in the GUI.
+ *
+ * It does not depend on raylib, so it is shared by the GUI and qif-graphics-cli.
+ */
+
+// Value of the prior or of a channel
+typedef struct QIFValue{
+	int text;			// Offset of the text in QIFFile::text (null-terminated)
+	long double value;
+	bool valid;			// Flag that indicates wheter the text is a number or a fraction
+}QIFValue;
+
+// Position and description of the first error found in a file
+typedef struct QIFFileError{
+	int line;			// Starting from 1, 0 if the error is not related to a position (i.e. the file could not be opened)
+	int column;			// Starting from 1
+	const char *message;
+}QIFFileError;
+
+class QIFFile{
+public:
+	QIFFile();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	int mode;
+	vector<QIFValue> prior;						// NUMBER_SECRETS values
+	int numSecrets[NUMBER_CHANNELS];
+	int numOutputs[NUMBER_CHANNELS];
+	vector<QIFValue> channel[NUMBER_CHANNELS];	// numSecrets x numOutputs values, row-major. CHANNEL_3 is not stored.
+	vector<char> text;							// Text of all values
+	QIFFileError error;
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Read a .qifg file. Values longer than CHAR_BUFFER_SIZE-1 characters are rejected,
+	 * so they can always be copied to the textboxes. The memory of a previous read is reused.
+	 *
+	 * Returns: the mode of the file or INVALID_QIF_FILE (the position of the error is in 'error').
+	 */
+	int read(const string &fileName);
+
+	/* Same as read(), for a file already in memory. 'data' does not need to be null-terminated. */
+	int parse(const char *data, long size);
+
+	// Text of a value
+	const char* valueText(const QIFValue &value) const;
+
+	// Value of row i and column j of a channel
+	const QIFValue& value(int channel, int i, int j) const;
+
+	/* Copy the texts of the prior and of the channels of the mode of the file to the textboxes.
+	 * The grids are reserved for the sizes of the channels, which are given in 'numSecrets' and 'numOutputs'. */
+	void copyText(
+		char prior[NUMBER_SECRETS][CHAR_BUFFER_SIZE],
+		TextGrid channel[NUMBER_CHANNELS],
+		int numSecrets[NUMBER_CHANNELS],
+		int numOutputs[NUMBER_CHANNELS]
+	) const;
+
+	// Describe the error of the last read as "line L, column C: message"
+	string errorString() const;
+};
+
+#endif
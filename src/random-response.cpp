@@ -1,17 +1,19 @@
 #include "random-response.h"
+#include <limits>
 
 using namespace RR;
 
 // Class random_response constructor.
-random_response::random_response(int size, long double epsilon, long double delta)
+template<typename T>
+random_response<T>::random_response(int size, T epsilon, T delta)
 {
-    std::vector<std::vector<long double>> channel(size, std::vector<long double>(size, 0));
+    std::vector<std::vector<T>> channel(size, std::vector<T>(size, 0));
 
     create_channel(channel, size, epsilon, delta);
 
     try
     {
-        random_response::check_channel(channel, size, epsilon, delta);
+        random_response<T>::check_channel(channel, size, epsilon, delta);
     }
     catch (const char* err)
     {
@@ -20,24 +22,25 @@ random_response::random_response(int size, long double epsilon, long double delt
 }
 
 // Channel updater.
-std::vector<std::vector<long double>> random_response::get_channel(int size, long double epsilon, long double delta)
+template<typename T>
+std::vector<std::vector<T>> random_response<T>::get_channel(int size, T epsilon, T delta)
 {
     try
     {
-        random_response::check_parameters(size, epsilon, delta);
+        random_response<T>::check_parameters(size, epsilon, delta);
     }
     catch (const char* err)
     {
         std::cerr << err << std::endl;
     }
 
-    std::vector<std::vector<long double>> channel(size, std::vector<long double>(size, 0));
+    std::vector<std::vector<T>> channel(size, std::vector<T>(size, 0));
 
     create_channel(channel, size, epsilon, delta);
 
     try
     {
-        random_response::check_channel(channel, size, epsilon, delta);
+        random_response<T>::check_channel(channel, size, epsilon, delta);
     }
     catch (const char* err)
     {
@@ -47,18 +50,12 @@ std::vector<std::vector<long double>> random_response::get_channel(int size, lon
     return channel;
 }
 
-// Secret domain size.
-int size;
-
-// Differential privacy parameters.
-long double epsilon;
-long double delta;
-
 // Create channel.
-void random_response::create_channel(std::vector<std::vector<long double>> &channel, int size, long double epsilon, long double delta)
+template<typename T>
+void random_response<T>::create_channel(std::vector<std::vector<T>> &channel, int size, T epsilon, T delta)
 {
-    long double other = 1 / (exp(epsilon) + delta + size - 1);
-    long double truthful = (exp(epsilon) + delta) * other;
+    T other = 1 / (exp(epsilon) + delta + size - 1);
+    T truthful = (exp(epsilon) + delta) * other;
 
     // Create channel for given parameters.
     int i = 0, j = 0;
@@ -79,7 +76,8 @@ void random_response::create_channel(std::vector<std::vector<long double>> &chan
 }
 
 // Check channel and differential privacy parameters.
-void random_response::check_parameters(int size, long double epsilon, long double delta)
+template<typename T>
+void random_response<T>::check_parameters(int size, T epsilon, T delta)
 {
     // Secret domain size must be an integer.
     if (typeid(size) != typeid(int))
@@ -94,11 +92,11 @@ void random_response::check_parameters(int size, long double epsilon, long doubl
     }
 
     // Both epsilon and delta must be real.
-    else if (typeid(epsilon) != typeid(long double))
+    else if (typeid(epsilon) != typeid(T))
     {
         throw "Epsilon must be numeric.";
     }
-    else if (typeid(delta) != typeid(long double))
+    else if (typeid(delta) != typeid(T))
     {
         throw "Delta must be numeric.";
     }
@@ -123,22 +121,27 @@ void random_response::check_parameters(int size, long double epsilon, long doubl
 }
 
 // Check resulting channel.
-void random_response::check_channel(std::vector<std::vector<long double>> channel, int size, long double epsilon, long double delta)
+template<typename T>
+void random_response<T>::check_channel(std::vector<std::vector<T>> channel, int size, T epsilon, T delta)
 {
     // Check channel properties (e.g. each row sums to 1).
     int i = 0, j = 0;
     for (i = 0; i < size; i++)
     {
-        long double row = 0;
+        T row = 0;
 
         for (j = 0; j < size; j++)
         {
             row = row + channel[i][j];
         }
 
-        if (!(fabs(1 - row) < (size - 1) * LDBL_EPSILON * fabs(1 + row)) || !(fabs(1 - row) < LDBL_MIN))
+        if (!(fabs(1 - row) < (size - 1) * std::numeric_limits<T>::epsilon() * fabs(1 + row)) || !(fabs(1 - row) < std::numeric_limits<T>::min()))
         {
             throw "Channel rows must sum to one.";
         }
     }
-}
\ No newline at end of file
+}
+
+template class RR::random_response<float>;
+template class RR::random_response<double>;
+template class RR::random_response<long double>;
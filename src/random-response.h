@@ -6,34 +6,37 @@
 #include <vector>
 #include <cfloat>
 #include <cmath>
+#include "precision.h"
 
 namespace RR
 {
+    // T is the scalar type of the channel, instantiated for float, double and long double.
+    template<typename T = Real>
     class random_response
     {
         public:
             // Class random_response constructor.
-            random_response(int size = 3, long double epsilon = log(2), long double delta = 0);
+            random_response(int size = 3, T epsilon = log(2), T delta = 0);
 
             // Channel updater.
-            std::vector<std::vector<long double>> get_channel(int size, long double epsilon, long double delta);
+            std::vector<std::vector<T>> get_channel(int size, T epsilon, T delta);
 
         private:
             // Secret domain size.
             int size;
 
             // Differential privacy parameters.
-            long double epsilon;
-            long double delta;
+            T epsilon;
+            T delta;
 
             // Create channel.
-            void create_channel(std::vector<std::vector<long double>> &channel, int size, long double epsilon, long double delta);
+            void create_channel(std::vector<std::vector<T>> &channel, int size, T epsilon, T delta);
 
             // Check channel and differential privacy parameters.
-            void check_parameters(int size, long double epsilon, long double delta);
+            void check_parameters(int size, T epsilon, T delta);
 
             // Check resulting channel.
-            void check_channel(std::vector<std::vector<long double>> channel, int size, long double epsilon, long double delta);
+            void check_channel(std::vector<std::vector<T>> channel, int size, T epsilon, T delta);
     };
 }
 
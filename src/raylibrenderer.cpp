@@ -0,0 +1,61 @@
+#include "raylibrenderer.h"
+#include "../libs/raylib/src/rlgl.h"
+#include <algorithm>
+
+RaylibRenderer raylibRenderer;
+
+void RaylibRenderer::rectangle(Rectangle rec, Color color){
+    DrawRectangleRec(rec, color);
+}
+
+void RaylibRenderer::rectangleLines(Rectangle rec, int thick, Color color){
+    DrawRectangleLinesEx(rec, thick, color);
+}
+
+void RaylibRenderer::triangle(Vector2 a, Vector2 b, Vector2 c, Color color){
+    DrawTriangle(a, b, c, color);
+}
+
+void RaylibRenderer::triangleLines(Vector2 a, Vector2 b, Vector2 c, Color color){
+    DrawTriangleLines(a, b, c, color);
+}
+
+void RaylibRenderer::circle(Vector2 center, float radius, Color color){
+    DrawCircle((int)center.x, (int)center.y, radius, color);
+}
+
+void RaylibRenderer::circleLines(Vector2 center, float radius, Color color){
+    DrawCircleLines((int)center.x, (int)center.y, radius, color);
+}
+
+void RaylibRenderer::text(Font font, const char *text, Vector2 position, float size, float spacing, Color color){
+    DrawTextEx(font, text, position, size, spacing, color);
+}
+
+void RaylibRenderer::texture(Texture2D texture, Vector2 position, float scale, Color tint){
+    DrawTextureEx(texture, position, 0.0f, scale, tint);
+}
+
+void RaylibRenderer::vertices(const vector<Vector2> &vertices, int mode, Color color){
+    int n = (int)vertices.size();
+    for(int first = 0; first < n; first += BATCH_CHUNK_VERTICES){
+        int last = min(n, first + BATCH_CHUNK_VERTICES);
+
+        // Draw the batch first if these vertices do not fit in it
+        rlCheckRenderBatchLimit(last - first);
+
+        rlBegin(mode);
+            rlColor4ub(color.r, color.g, color.b, color.a);
+            for(int k = first; k < last; k++)
+                rlVertex2f(vertices[k].x, vertices[k].y);
+        rlEnd();
+    }
+}
+
+void RaylibRenderer::beginScissor(int x, int y, int width, int height){
+    BeginScissorMode(x, y, width, height);
+}
+
+void RaylibRenderer::endScissor(){
+    EndScissorMode();
+}
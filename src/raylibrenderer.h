@@ -0,0 +1,28 @@
+#ifndef _raylibrenderer
+#define _raylibrenderer
+
+#include "renderer.h"
+
+// Vertices given to rlgl between two checks of the batch limit (a multiple of 2 and 3)
+#define BATCH_CHUNK_VERTICES 3072
+
+/* Backend that draws with raylib and rlgl. */
+class RaylibRenderer : public Renderer{
+public:
+	void rectangle(Rectangle rec, Color color);
+	void rectangleLines(Rectangle rec, int thick, Color color);
+	void triangle(Vector2 a, Vector2 b, Vector2 c, Color color);
+	void triangleLines(Vector2 a, Vector2 b, Vector2 c, Color color);
+	void circle(Vector2 center, float radius, Color color);
+	void circleLines(Vector2 center, float radius, Color color);
+	void text(Font font, const char *text, Vector2 position, float size, float spacing, Color color);
+	void texture(Texture2D texture, Vector2 position, float scale, Color tint);
+	void vertices(const vector<Vector2> &vertices, int mode, Color color);
+	void beginScissor(int x, int y, int width, int height);
+	void endScissor();
+};
+
+// Renderer of the application
+extern RaylibRenderer raylibRenderer;
+
+#endif
@@ -0,0 +1,101 @@
+#include "renderer.h"
+#include "graphics.h"
+#include <cstring>
+
+static void clearStats(RenderStats &stats){
+    memset(&stats, 0, sizeof(stats));
+}
+
+void Renderer::panel(Rectangle title, Rectangle content, const char *text, Color contentColor, Color textColor, Font font){
+    rectangle(title, TITLES_BASE_COLOR);
+    rectangle(content, contentColor);
+    this->text(font, text, (Vector2){title.x + 10, title.y}, font.baseSize, 1, textColor);
+}
+
+RecordingRenderer::RecordingRenderer(){
+    clearStats(frame);
+    clearStats(total);
+    frames = 0;
+    lastMode = 0;
+    lastTexture = 0;
+}
+
+void RecordingRenderer::beginFrame(){
+    clearStats(frame);
+    lastMode = 0;
+    lastTexture = 0;
+}
+
+void RecordingRenderer::endFrame(){
+    total.calls += frame.calls;
+    total.primitives += frame.primitives;
+    total.vertices += frame.vertices;
+    total.stateChanges += frame.stateChanges;
+    frames++;
+}
+
+void RecordingRenderer::record(int mode, unsigned int texture, long primitives, long vertices){
+    frame.calls++;
+    if(vertices == 0)
+        return;
+
+    if(mode != lastMode || texture != lastTexture) frame.stateChanges++;
+    lastMode = mode;
+    lastTexture = texture;
+
+    frame.primitives += primitives;
+    frame.vertices += vertices;
+}
+
+void RecordingRenderer::rectangle(Rectangle rec, Color color){
+    record(PRIMITIVE_QUADS, 0, 1, 4);
+}
+
+void RecordingRenderer::rectangleLines(Rectangle rec, int thick, Color color){
+    // One rectangle for each side
+    record(PRIMITIVE_QUADS, 0, 4, 16);
+}
+
+void RecordingRenderer::triangle(Vector2 a, Vector2 b, Vector2 c, Color color){
+    record(PRIMITIVE_TRIANGLES, 0, 1, 3);
+}
+
+void RecordingRenderer::triangleLines(Vector2 a, Vector2 b, Vector2 c, Color color){
+    record(PRIMITIVE_LINES, 0, 3, 6);
+}
+
+void RecordingRenderer::circle(Vector2 center, float radius, Color color){
+    record(PRIMITIVE_TRIANGLES, 0, RENDERER_CIRCLE_SEGMENTS, 3*RENDERER_CIRCLE_SEGMENTS);
+}
+
+void RecordingRenderer::circleLines(Vector2 center, float radius, Color color){
+    record(PRIMITIVE_LINES, 0, RENDERER_CIRCLE_SEGMENTS, 2*RENDERER_CIRCLE_SEGMENTS);
+}
+
+void RecordingRenderer::text(Font font, const char *text, Vector2 position, float size, float spacing, Color color){
+    // A quad for each character, spaces and UTF-8 continuation bytes are not drawn
+    long glyphs = 0;
+    for(const unsigned char *c = (const unsigned char*) text; *c != '\0'; c++)
+        if(*c != ' ' && *c != '\t' && *c != '\n' && (*c & 0xC0) != 0x80) glyphs++;
+
+    record(PRIMITIVE_QUADS, font.texture.id, glyphs, 4*glyphs);
+}
+
+void RecordingRenderer::texture(Texture2D texture, Vector2 position, float scale, Color tint){
+    record(PRIMITIVE_QUADS, texture.id, 1, 4);
+}
+
+void RecordingRenderer::vertices(const vector<Vector2> &vertices, int mode, Color color){
+    long n = (long)vertices.size();
+    record(mode, 0, mode == PRIMITIVE_LINES ? n/2 : n/3, n);
+}
+
+void RecordingRenderer::beginScissor(int x, int y, int width, int height){
+    frame.calls++;
+    frame.stateChanges++;
+}
+
+void RecordingRenderer::endScissor(){
+    frame.calls++;
+    frame.stateChanges++;
+}
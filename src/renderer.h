@@ -0,0 +1,101 @@
+#ifndef _renderer
+#define _renderer
+
+#include "../libs/raylib/src/raylib.h"
+#include <vector>
+
+using namespace std;
+
+// Primitive types, the same values of RL_LINES, RL_TRIANGLES and RL_QUADS in rlgl.h
+#define PRIMITIVE_LINES 0x0001
+#define PRIMITIVE_TRIANGLES 0x0004
+#define PRIMITIVE_QUADS 0x0007
+
+// Segments raylib uses for DrawCircle and DrawCircleLines
+#define RENDERER_CIRCLE_SEGMENTS 36
+
+/* Shapes and text drawn by the visualization and the panels.
+ *
+ * raygui widgets draw themselves with raylib, so only the drawing done by
+ * qif-graphics goes through a Renderer. The raylib backend draws on the screen
+ * and the recording backend only counts what would be drawn, so the render path
+ * can be run and measured without a window. */
+class Renderer{
+public:
+	virtual ~Renderer() {}
+
+	virtual void rectangle(Rectangle rec, Color color) = 0;
+	virtual void rectangleLines(Rectangle rec, int thick, Color color) = 0;
+	virtual void triangle(Vector2 a, Vector2 b, Vector2 c, Color color) = 0;
+	virtual void triangleLines(Vector2 a, Vector2 b, Vector2 c, Color color) = 0;
+
+	// The center is truncated to a pixel, as DrawCircle does
+	virtual void circle(Vector2 center, float radius, Color color) = 0;
+	virtual void circleLines(Vector2 center, float radius, Color color) = 0;
+
+	virtual void text(Font font, const char *text, Vector2 position, float size, float spacing, Color color) = 0;
+	virtual void texture(Texture2D texture, Vector2 position, float scale, Color tint) = 0;
+
+	/* Vertices already tessellated, given as primitives of type 'mode' (PRIMITIVE_LINES or PRIMITIVE_TRIANGLES). */
+	virtual void vertices(const vector<Vector2> &vertices, int mode, Color color) = 0;
+
+	virtual void beginScissor(int x, int y, int width, int height) = 0;
+	virtual void endScissor() = 0;
+
+	/* Title bar and content of a panel, with the calls above. */
+	void panel(Rectangle title, Rectangle content, const char *text, Color contentColor, Color textColor, Font font);
+};
+
+// Counts of the drawing of a frame
+typedef struct RenderStats{
+	long calls;			// Calls to the renderer
+	long primitives;	// Lines, triangles and quads
+	long vertices;
+	long stateChanges;	// Changes of primitive type, texture or scissor, each one ends a rlgl draw call
+}RenderStats;
+
+/* Backend that does not draw, it counts the primitives and vertices raylib would
+ * give to rlgl for each call, and the state changes between consecutive calls.
+ * The tessellation is the one of raylib 3.7 (i.e. RENDERER_CIRCLE_SEGMENTS for a circle),
+ * so the counts can be compared between runs but they are not read from rlgl. */
+class RecordingRenderer : public Renderer{
+public:
+	RecordingRenderer();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	RenderStats frame;	// Counts of the current frame
+	RenderStats total;	// Counts of all the frames ended
+	long frames;		// Number of frames ended
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Start and end a frame. endFrame() adds the counts of the frame to the total. */
+	void beginFrame();
+	void endFrame();
+
+	void rectangle(Rectangle rec, Color color);
+	void rectangleLines(Rectangle rec, int thick, Color color);
+	void triangle(Vector2 a, Vector2 b, Vector2 c, Color color);
+	void triangleLines(Vector2 a, Vector2 b, Vector2 c, Color color);
+	void circle(Vector2 center, float radius, Color color);
+	void circleLines(Vector2 center, float radius, Color color);
+	void text(Font font, const char *text, Vector2 position, float size, float spacing, Color color);
+	void texture(Texture2D texture, Vector2 position, float scale, Color tint);
+	void vertices(const vector<Vector2> &vertices, int mode, Color color);
+	void beginScissor(int x, int y, int width, int height);
+	void endScissor();
+
+private:
+	int lastMode;			// Primitive type of the previous call, 0 at the start of a frame
+	unsigned int lastTexture;	// Texture of the previous call, 0 for shapes
+
+	/* Count a call that gives 'primitives' primitives of type 'mode' with 'vertices' vertices. */
+	void record(int mode, unsigned int texture, long primitives, long vertices);
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "scenario.h"
+
+Scenario::Scenario(){
+    mode = MODE_SINGLE;
+    error = NO_ERROR;
+    prior = vector<long double>(NUMBER_SECRETS, 0);
+    for(int i = 0; i < NUMBER_CHANNELS; i++)
+        hyperReady[i] = false;
+}
+
+int Scenario::buildChannel(const QIFFile &file, int channel, Distribution &prior){
+    int numSecrets = file.numSecrets[channel], numOutputs = file.numOutputs[channel];
+
+    this->channel[channel].resize(numSecrets, numOutputs);
+    for(int i = 0; i < numSecrets; i++){
+        for(int j = 0; j < numOutputs; j++){
+            const QIFValue &value = file.value(channel, i, j);
+            if(!value.valid)
+                return INVALID_VALUE_CHANNEL_1+channel;
+            this->channel[channel](i, j) = value.value;
+        }
+    }
+
+    this->channel[channel].toNested(channelRows[channel]);
+    if(!Channel::isChannel(channelRows[channel]))
+        return INVALID_CHANNEL_1+channel;
+
+    channelObj[channel] = Channel(prior, channelRows[channel]);
+    return NO_ERROR;
+}
+
+int Scenario::compute(const QIFFile &file){
+    mode = file.mode;
+    for(int i = 0; i < NUMBER_CHANNELS; i++)
+        hyperReady[i] = false;
+
+    // Prior
+    for(int i = 0; i < NUMBER_SECRETS; i++){
+        if(!file.prior[i].valid)
+            return error = INVALID_VALUE_PRIOR;
+        prior[i] = file.prior[i].value;
+    }
+    if(!Distribution::isDistribution(prior))
+        return error = INVALID_PRIOR;
+    priorObj = Distribution(prior);
+
+    // Channels
+    if((error = buildChannel(file, CHANNEL_1, priorObj)) != NO_ERROR)
+        return error;
+
+    if(mode == MODE_TWO){
+        if((error = buildChannel(file, CHANNEL_2, priorObj)) != NO_ERROR)
+            return error;
+    }else if(mode == MODE_REF){
+        fakePrior = Distribution(file.numSecrets[CHANNEL_2], "uniform");
+        if((error = buildChannel(file, CHANNEL_2, fakePrior)) != NO_ERROR)
+            return error;
+
+        // Multiply channels C and R
+        if(composeChannels(channel[CHANNEL_1], channel[CHANNEL_2], channel[CHANNEL_3]) != NO_ERROR)
+            return error = INVALID_COMPOSITION;
+
+        channel[CHANNEL_3].toNested(channelRows[CHANNEL_3]);
+        if(!Channel::isChannel(channelRows[CHANNEL_3]))
+            return error = INVALID_COMPOSITION;
+        channelObj[CHANNEL_3] = Channel(priorObj, channelRows[CHANNEL_3]);
+    }
+
+    // Hypers
+    for(int i = 0; i < NUMBER_CHANNELS; i++){
+        if(i == CHANNEL_1 || (i == CHANNEL_2 && mode == MODE_TWO) || (i == CHANNEL_3 && mode == MODE_REF)){
+            hyper[i] = Hyper(channelObj[i]);
+            hyperReady[i] = true;
+        }
+    }
+
+    return error = NO_ERROR;
+}
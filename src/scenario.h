@@ -0,0 +1,49 @@
+#ifndef _scenario
+#define _scenario
+
+#include "graphics.h"
+#include "qiffile.h"
+
+/* Prior, channels and hyper-distributions of a .qifg file computed without the GUI.
+ *
+ * compute() follows the same steps as checkPriorFlags, checkChannelsFlags and
+ * checkHypersFlags in qif-graphics.cpp, so the results are the ones the GUI
+ * would show for the same file. It does not depend on raylib, so it is used by
+ * qif-graphics-cli. */
+class Scenario{
+public:
+	Scenario();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	int mode;
+	int error;						// NO_ERROR or the first error found by compute()
+	vector<long double> prior;
+	Distribution priorObj;
+	Distribution fakePrior;			// Prior of CHANNEL_2 in MODE_REF
+	Matrix channel[NUMBER_CHANNELS];
+	vector<vector<long double>> channelRows[NUMBER_CHANNELS];
+	Channel channelObj[NUMBER_CHANNELS];
+	Hyper hyper[NUMBER_CHANNELS];
+	bool hyperReady[NUMBER_CHANNELS];	// Flag that indicates wheter hyper[i] was built
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Compute the prior, the channels, the composition (MODE_REF) and the hypers of a file.
+	 * The hypers built are the ones drawn by the GUI: CHANNEL_1 in every mode,
+	 * CHANNEL_2 in MODE_TWO and CHANNEL_3 in MODE_REF.
+	 *
+	 * Returns: NO_ERROR or the error code of the first invalid object.
+	 */
+	int compute(const QIFFile &file);
+
+private:
+	// Convert the text of a channel and build channelObj with a given prior. Returns NO_ERROR or an error code.
+	int buildChannel(const QIFFile &file, int channel, Distribution &prior);
+};
+
+#endif
@@ -0,0 +1,326 @@
+#include "session.h"
+#include <cstdio>
+#include <stdint.h>
+
+#define SESSION_HEADER_SIZE 28
+
+// 64-bit FNV-1a hash
+static uint64_t checksum(const unsigned char *data, unsigned long size){
+    uint64_t hash = 14695981039346656037ULL;
+    for(unsigned long i = 0; i < size; i++){
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------------
+// Little-endian writer and reader
+//------------------------------------------------------------------------------------
+static void putU64(vector<unsigned char> &out, uint64_t v){
+    for(int i = 0; i < 8; i++) out.push_back((v >> (8*i)) & 0xFF);
+}
+
+static void putInt(vector<unsigned char> &out, int v){
+    uint32_t u = (uint32_t)v;
+    for(int i = 0; i < 4; i++) out.push_back((u >> (8*i)) & 0xFF);
+}
+
+static void putReal(vector<unsigned char> &out, long double v){
+    double d = (double)v;
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    putU64(out, u);
+}
+
+static void putString(vector<unsigned char> &out, const string &s){
+    putInt(out, (int)s.size());
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+class SessionReader{
+public:
+    const unsigned char *cur;
+    const unsigned char *end;
+
+    SessionReader(const unsigned char *data, unsigned long size) : cur(data), end(data + size) {}
+
+    bool u64(uint64_t &v){
+        if(end - cur < 8) return false;
+        v = 0;
+        for(int i = 0; i < 8; i++) v |= (uint64_t)cur[i] << (8*i);
+        cur += 8;
+        return true;
+    }
+
+    bool integer(int &v){
+        if(end - cur < 4) return false;
+        uint32_t u = 0;
+        for(int i = 0; i < 4; i++) u |= (uint32_t)cur[i] << (8*i);
+        cur += 4;
+        v = (int)u;
+        return true;
+    }
+
+    // Integer in [min, max]
+    bool integer(int &v, int min, int max){
+        return integer(v) && v >= min && v <= max;
+    }
+
+    bool flag(bool &v){
+        int i;
+        if(!integer(i, 0, 1)) return false;
+        v = i == 1;
+        return true;
+    }
+
+    template<typename T>
+    bool real(T &v){
+        uint64_t u;
+        if(!u64(u)) return false;
+        double d;
+        memcpy(&d, &u, sizeof(d));
+        v = (T)d;
+        return true;
+    }
+
+    bool str(string &s){
+        int size;
+        if(!integer(size, 0, CHAR_BUFFER_SIZE-1) || end - cur < size) return false;
+        s.assign((const char*)cur, size);
+        cur += size;
+        return true;
+    }
+
+    // Check that 'count' items of at least 'bytes' bytes each fit in the rest of the payload,
+    // so sizes read from the file are checked before anything is allocated for them
+    bool fits(long count, long bytes){
+        return count*bytes <= end - cur;
+    }
+};
+
+static void putCircle(vector<unsigned char> &out, const Circle &c){
+    putReal(out, c.center.x);
+    putReal(out, c.center.y);
+    putReal(out, c.radius);
+}
+
+static bool readCircle(SessionReader &in, Circle &c){
+    return in.real(c.center.x) && in.real(c.center.y) && in.real(c.radius);
+}
+
+//------------------------------------------------------------------------------------
+// Session
+//------------------------------------------------------------------------------------
+Session::Session(){
+    mode = MODE_SINGLE;
+    hasResults = false;
+    drawing = false;
+    hasCircles = false;
+    error = "";
+    for(int i = 0; i < NUMBER_CHANNELS; i++){
+        numSecrets[i] = numOutputs[i] = 0;
+        hyperReady[i] = false;
+        numPosteriors[i] = 0;
+    }
+}
+
+int Session::save(const string &fileName){
+    vector<unsigned char> payload;
+
+    // Text
+    putInt(payload, mode);
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        putString(payload, prior[i]);
+    for(int c = 0; c < 2; c++){
+        putInt(payload, numSecrets[c]);
+        putInt(payload, numOutputs[c]);
+        for(int k = 0; k < numSecrets[c]*numOutputs[c]; k++)
+            putString(payload, channel[c][k]);
+    }
+    unsigned long textSize = payload.size();
+
+    // Results, written after their own checksum so the text can be restored without them
+    vector<unsigned char> results;
+    putInt(results, hasResults);
+    if(hasResults){
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            putReal(results, priorValues[i]);
+
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            putInt(results, matrix[c].rows);
+            putInt(results, matrix[c].cols);
+            for(unsigned long k = 0; k < matrix[c].values.size(); k++)
+                putReal(results, matrix[c].values[k]);
+        }
+
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            putInt(results, hyperReady[c]);
+            if(!hyperReady[c]) continue;
+            putInt(results, numPosteriors[c]);
+            for(int k = 0; k < numPosteriors[c]; k++)
+                putReal(results, outer[c][k]);
+            for(int k = 0; k < NUMBER_SECRETS*numPosteriors[c]; k++)
+                putReal(results, inners[c][k]);
+        }
+    }
+
+    // Circles
+    putInt(results, drawing);
+    putInt(results, hasCircles);
+    if(hasCircles){
+        for(int i = 0; i < 3; i++){
+            putReal(results, trianglePoints[i].x);
+            putReal(results, trianglePoints[i].y);
+        }
+        putCircle(results, priorCircle);
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            putInt(results, (int)innersCircles[c].size());
+            for(unsigned long k = 0; k < innersCircles[c].size(); k++)
+                putCircle(results, innersCircles[c][k]);
+        }
+    }
+
+    putU64(payload, checksum(results.data(), results.size()));
+    payload.insert(payload.end(), results.begin(), results.end());
+
+    vector<unsigned char> header(SESSION_MAGIC, SESSION_MAGIC + 8);
+    putInt(header, SESSION_VERSION);
+    putU64(header, textSize);
+    putU64(header, checksum(payload.data(), textSize));
+
+    FILE *file = fopen(fileName.c_str(), "wb");
+    if(file == NULL){
+        error = "could not create the file";
+        return INVALID_QIF_FILE;
+    }
+    bool ok = fwrite(header.data(), 1, header.size(), file) == header.size() &&
+              fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+    ok = fclose(file) == 0 && ok;
+    if(!ok){
+        error = "could not write the file";
+        return INVALID_QIF_FILE;
+    }
+
+    return NO_ERROR;
+}
+
+int Session::load(const string &fileName){
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if(file == NULL){
+        error = "could not open the file";
+        return INVALID_QIF_FILE;
+    }
+
+    vector<unsigned char> data;
+    unsigned char buffer[4096];
+    size_t n;
+    while((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + n);
+    fclose(file);
+
+    // Header
+    if(data.size() < SESSION_HEADER_SIZE || memcmp(data.data(), SESSION_MAGIC, 8) != 0){
+        error = "not a QIF graphics session";
+        return INVALID_QIF_FILE;
+    }
+
+    SessionReader header(data.data() + 8, SESSION_HEADER_SIZE - 8);
+    int version;
+    uint64_t textSize, sum;
+    header.integer(version);
+    header.u64(textSize);
+    header.u64(sum);
+    if(version < 1 || version > SESSION_VERSION){
+        error = "unsupported session version";
+        return INVALID_QIF_FILE;
+    }
+    if(textSize > data.size() - SESSION_HEADER_SIZE || sum != checksum(data.data() + SESSION_HEADER_SIZE, textSize)){
+        error = "the session is corrupted (checksum)";
+        return INVALID_QIF_FILE;
+    }
+
+    SessionReader in(data.data() + SESSION_HEADER_SIZE, textSize);
+    error = "the session is corrupted";
+
+    // Text
+    if(!in.integer(mode, MODE_SINGLE, MODE_REF)) return INVALID_QIF_FILE;
+    for(int i = 0; i < NUMBER_SECRETS; i++)
+        if(!in.str(prior[i])) return INVALID_QIF_FILE;
+    for(int c = 0; c < 2; c++){
+        if(!in.integer(numSecrets[c], 0, MAX_CHANNEL_OUTPUTS) || !in.integer(numOutputs[c], 0, MAX_CHANNEL_OUTPUTS)) return INVALID_QIF_FILE;
+
+        // Same shapes accepted by the text format
+        bool used = c == CHANNEL_1 || mode != MODE_SINGLE;
+        int rows = (c == CHANNEL_1 || mode == MODE_TWO) ? NUMBER_SECRETS : numOutputs[CHANNEL_1];
+        if(used && (numSecrets[c] != rows || numOutputs[c] == 0)) return INVALID_QIF_FILE;
+        if(!used) numSecrets[c] = numOutputs[c] = 0;
+
+        // Every text takes at least its size
+        if(!in.fits((long)numSecrets[c]*numOutputs[c], 4)) return INVALID_QIF_FILE;
+        channel[c].resize(numSecrets[c]*numOutputs[c]);
+        for(int k = 0; k < numSecrets[c]*numOutputs[c]; k++)
+            if(!in.str(channel[c][k])) return INVALID_QIF_FILE;
+    }
+    if(in.cur != in.end) return INVALID_QIF_FILE;
+
+    // Results and circles. If they are damaged only the text is restored, and the objects are recomputed from it.
+    SessionReader results(data.data() + SESSION_HEADER_SIZE + textSize, data.size() - SESSION_HEADER_SIZE - textSize);
+    if(!results.u64(sum) || sum != checksum(results.cur, results.end - results.cur) || !readResults(results)){
+        hasResults = false;
+        drawing = false;
+        hasCircles = false;
+    }
+
+    error = "";
+    return mode;
+}
+
+bool Session::readResults(SessionReader &in){
+    // Results
+    if(!in.flag(hasResults)) return false;
+    if(hasResults){
+        for(int i = 0; i < NUMBER_SECRETS; i++)
+            if(!in.real(priorValues[i])) return false;
+
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            int rows, cols;
+            if(!in.integer(rows, 0, MAX_CHANNEL_OUTPUTS) || !in.integer(cols, 0, MAX_CHANNEL_OUTPUTS)) return false;
+            if(!in.fits((long)rows*cols, 8)) return false;
+            matrix[c].resize(rows, cols);
+            for(unsigned long k = 0; k < matrix[c].values.size(); k++)
+                if(!in.real(matrix[c].values[k])) return false;
+        }
+
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            if(!in.flag(hyperReady[c])) return false;
+            if(!hyperReady[c]) continue;
+            if(!in.integer(numPosteriors[c], 0, MAX_CHANNEL_OUTPUTS)) return false;
+            if(!in.fits((long)(NUMBER_SECRETS+1)*numPosteriors[c], 8)) return false;
+            outer[c].resize(numPosteriors[c]);
+            inners[c].resize(NUMBER_SECRETS*numPosteriors[c]);
+            for(int k = 0; k < numPosteriors[c]; k++)
+                if(!in.real(outer[c][k])) return false;
+            for(int k = 0; k < NUMBER_SECRETS*numPosteriors[c]; k++)
+                if(!in.real(inners[c][k])) return false;
+        }
+    }
+
+    // Circles
+    if(!in.flag(drawing) || !in.flag(hasCircles)) return false;
+    if(hasCircles){
+        for(int i = 0; i < 3; i++)
+            if(!in.real(trianglePoints[i].x) || !in.real(trianglePoints[i].y)) return false;
+        if(!readCircle(in, priorCircle)) return false;
+        for(int c = 0; c < NUMBER_CHANNELS; c++){
+            int count;
+            if(!in.integer(count, 0, MAX_CHANNEL_OUTPUTS)) return false;
+            if(!in.fits(count, 24)) return false;
+            innersCircles[c].resize(count);
+            for(int k = 0; k < count; k++)
+                if(!readCircle(in, innersCircles[c][k])) return false;
+        }
+    }
+
+    return true;
+}
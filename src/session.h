@@ -0,0 +1,76 @@
+#ifndef _session
+#define _session
+
+#include "graphics.h"
+
+#define SESSION_MAGIC "QIFGB\r\n\x1a"	// 8 bytes, the text line breaks detect files changed by text tools
+#define SESSION_VERSION 1
+#define SESSION_TOLERANCE 1e-4		// Largest difference between a restored composition and the one multiplied again (values are stored as doubles)
+
+class SessionReader;
+
+/* Binary session (.qifgb): the textboxes of a .qifg file plus the objects computed
+ * from them, so a session can be drawn again without recomputing the hypers.
+
+    Header:  magic (8 bytes), version (uint32), text size (uint64), FNV-1a 64 checksum of the text (uint64)
+    Text:    mode, prior and channels text
+    Results: FNV-1a 64 checksum of the rest of the file (uint64)
+             hasResults [prior values, channel matrices, outer and inners of each hyper]
+             drawing, hasCircles [triangle points, prior circle, inners circles]
+
+ * Integers are int32 and real numbers are IEEE doubles, both in little-endian, so a
+ * session does not depend on the precision of the build (long double is not portable).
+ * If the results can not be used (i.e. they are missing, damaged or were saved with
+ * different window sizes) only the text is restored and the objects are recomputed.
+ *
+ * It does not depend on raylib, so it can be read by the tools without the GUI.
+ */
+class Session{
+public:
+	Session();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	int mode;
+	string prior[NUMBER_SECRETS];				// Textboxes
+	int numSecrets[NUMBER_CHANNELS];
+	int numOutputs[NUMBER_CHANNELS];
+	vector<string> channel[NUMBER_CHANNELS];	// Textboxes, numSecrets x numOutputs, row-major. CHANNEL_3 is not stored.
+
+	bool hasResults;
+	long double priorValues[NUMBER_SECRETS];
+	Matrix matrix[NUMBER_CHANNELS];				// Channel matrices, empty if the channel is not used in the mode
+	bool hyperReady[NUMBER_CHANNELS];
+	int numPosteriors[NUMBER_CHANNELS];
+	vector<long double> outer[NUMBER_CHANNELS];
+	vector<long double> inners[NUMBER_CHANNELS];	// NUMBER_SECRETS x numPosteriors, row-major
+
+	bool drawing;								// Flag that indicates wheter the circles were being drawn
+	bool hasCircles;
+	Vector2 trianglePoints[3];					// Triangle of the circles, they are rebuilt if the triangle changes
+	Circle priorCircle;
+	vector<Circle> innersCircles[NUMBER_CHANNELS];
+
+	const char *error;							// Description of the last error
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Write the session to a file.
+	 * Returns: NO_ERROR or INVALID_QIF_FILE if the file could not be written. */
+	int save(const string &fileName);
+
+	/* Read a session from a file. The magic, the version and the checksums are verified.
+	 * If only the results are damaged, the text is read and hasResults and hasCircles are false.
+	 * Returns: the mode or INVALID_QIF_FILE (the attributes are not valid). */
+	int load(const string &fileName);
+
+private:
+	// Read the results and the circles. Returns false if they are damaged.
+	bool readResults(SessionReader &in);
+};
+
+#endif
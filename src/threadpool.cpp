@@ -0,0 +1,105 @@
+#include "threadpool.h"
+
+#if !defined(PLATFORM_WEB)
+
+ThreadPool::ThreadPool(int numThreads){
+    numWorkers = numThreads > 0 ? numThreads : (int)thread::hardware_concurrency();
+    if(numWorkers < 1) numWorkers = 1;
+
+    task = NULL;
+    count = 0;
+    next = 0;
+    generation = 0;
+    running = 0;
+    stop = false;
+
+    for(int worker = 1; worker < numWorkers; worker++)
+        threads.push_back(thread(&ThreadPool::workerLoop, this, worker));
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        unique_lock<mutex> guard(lock);
+        stop = true;
+    }
+    wakeUp.notify_all();
+    for(unsigned long i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+int ThreadPool::size(){
+    return numWorkers;
+}
+
+void ThreadPool::runIndices(int worker){
+    for(int index = next++; index < count; index = next++)
+        (*task)(index, worker);
+}
+
+void ThreadPool::workerLoop(int worker){
+    int seen = 0;
+    while(true){
+        {
+            unique_lock<mutex> guard(lock);
+            wakeUp.wait(guard, [&]{ return stop || generation != seen; });
+            if(stop) return;
+            seen = generation;
+        }
+
+        runIndices(worker);
+
+        unique_lock<mutex> guard(lock);
+        if(--running == 0)
+            finished.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int, int)> &task){
+    if(numWorkers == 1 || count <= 1){
+        for(int index = 0; index < count; index++)
+            task(index, 0);
+        return;
+    }
+
+    unique_lock<mutex> turn(callers);
+    {
+        unique_lock<mutex> guard(lock);
+        this->task = &task;
+        this->count = count;
+        next = 0;
+        running = numWorkers - 1;
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    runIndices(0);
+
+    unique_lock<mutex> guard(lock);
+    finished.wait(guard, [&]{ return running == 0; });
+    this->task = NULL;
+}
+
+#else
+
+ThreadPool::ThreadPool(int numThreads){
+    numWorkers = 1;
+}
+
+ThreadPool::~ThreadPool(){
+}
+
+int ThreadPool::size(){
+    return numWorkers;
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int, int)> &task){
+    for(int index = 0; index < count; index++)
+        task(index, 0);
+}
+
+#endif
+
+ThreadPool& ThreadPool::shared(){
+    static ThreadPool pool;
+    return pool;
+}
@@ -0,0 +1,62 @@
+#ifndef _threadpool
+#define _threadpool
+
+#include <vector>
+#include <functional>
+
+#if !defined(PLATFORM_WEB)
+	#include <thread>
+	#include <mutex>
+	#include <condition_variable>
+	#include <atomic>
+#endif
+
+using namespace std;
+
+/* Fixed set of worker threads that run the iterations of a loop.
+ *
+ * The thread that calls parallelFor() works as worker 0, so a pool of size 1
+ * runs everything in the caller thread. The web build has no threads and
+ * always behaves as a pool of size 1. */
+class ThreadPool{
+public:
+	/* numThreads: total number of workers, including the caller. 0 uses one per hardware thread. */
+	ThreadPool(int numThreads = 0);
+	~ThreadPool();
+
+	// Number of workers, including the caller
+	int size();
+
+	/* Call task(index, worker) for every index in [0, count) and wait until all of them finish.
+	 * Indices are given in increasing order, but they can finish in any order.
+	 * 'worker' is in [0, size()), so it can be used to index per-worker scratch memory.
+	 * It must not be called from inside a task. Loops called from different threads run one after the other. */
+	void parallelFor(int count, const function<void(int, int)> &task);
+
+	/* Pool shared by the background workers of the app (the heatmap and the prior cloud), with one
+	 * worker per hardware thread. It is created the first time it is used, so its threads only exist
+	 * once one of those workers has a job. */
+	static ThreadPool& shared();
+
+private:
+	int numWorkers;
+
+#if !defined(PLATFORM_WEB)
+	vector<thread> threads;
+	mutex lock;
+	mutex callers;					// Held by the thread whose loop is running
+	condition_variable wakeUp;		// Signals a new loop or the destruction of the pool
+	condition_variable finished;	// Signals that every worker left the current loop
+	const function<void(int, int)> *task;
+	int count;
+	atomic<int> next;				// Next index to run
+	int generation;					// Incremented for every loop
+	int running;					// Workers (besides the caller) still in the current loop
+	bool stop;
+
+	void workerLoop(int worker);
+	void runIndices(int worker);
+#endif
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "timeline.h"
+
+float ease(int curve, float t){
+    if(t <= 0) return 0;
+    if(t >= 1) return 1;
+
+    float u;
+    switch(curve){
+        case EASE_OUT_CUBIC:
+            u = 1 - t;
+            return 1 - u*u*u;
+        case EASE_IN_OUT_CUBIC:
+            if(t < 0.5f) return 4*t*t*t;
+            u = 2 - 2*t;
+            return 1 - u*u*u/2;
+        default:
+            return t;
+    }
+}
+
+Timeline::Timeline(){
+    start = 0;
+    duration = 0;
+    curve = EASE_LINEAR;
+}
+
+void Timeline::begin(double now, double duration, int curve){
+    this->start = now;
+    this->duration = duration;
+    this->curve = curve;
+}
+
+float Timeline::progress(double now){
+    if(duration <= 0)
+        return 1;
+    return ease(curve, (float)((now - start) / duration));
+}
+
+bool Timeline::finished(double now){
+    return now - start >= duration;
+}
@@ -0,0 +1,41 @@
+#ifndef _timeline
+#define _timeline
+
+// Easing curves
+#define EASE_LINEAR 0
+#define EASE_OUT_CUBIC 1		// Fast at the beginning, slows down at the end
+#define EASE_IN_OUT_CUBIC 2		// Slow at both ends
+
+/* Value of an easing curve at t, for t in [0, 1]. */
+float ease(int curve, float t);
+
+/* Animation driven by time instead of by frames, so it lasts the same whatever
+ * the frame rate is and it does not slow down when frames are dropped. Times are
+ * in seconds of a monotonic clock (i.e. GetTime()). */
+class Timeline{
+public:
+	Timeline();
+
+	//------------------------------------------------------------------------------------
+    // Attributes
+    //------------------------------------------------------------------------------------
+
+	double start;		// Time the animation started
+	double duration;	// Length of the animation in seconds
+	int curve;			// EASE_LINEAR, EASE_OUT_CUBIC or EASE_IN_OUT_CUBIC
+
+	//------------------------------------------------------------------------------------
+    // Methods
+    //------------------------------------------------------------------------------------
+
+	/* Start the animation at time 'now'. */
+	void begin(double now, double duration, int curve);
+
+	/* Eased progress of the animation at time 'now', from 0 at the start to 1 at the end. */
+	float progress(double now);
+
+	/* Returns true if the animation has reached its end at time 'now'. */
+	bool finished(double now);
+};
+
+#endif
@@ -1,17 +1,19 @@
 #include "truncated-geometric.h"
+#include <limits>
 
 using namespace TG;
 
 // Class truncated_geometric constructor.
-truncated_geometric::truncated_geometric(int size, long double alpha)
+template<typename T>
+truncated_geometric<T>::truncated_geometric(int size, T alpha)
 {
-    std::vector<std::vector<long double>> channel(size + 1, std::vector<long double>(size + 1, 0));
+    std::vector<std::vector<T>> channel(size + 1, std::vector<T>(size + 1, 0));
 
     create_channel(channel, size + 1, alpha);
 
     try
     {
-        truncated_geometric::check_channel(channel, size + 1, alpha);
+        truncated_geometric<T>::check_channel(channel, size + 1, alpha);
     }
     catch (const char* err)
     {
@@ -20,24 +22,25 @@ truncated_geometric::truncated_geometric(int size, long double alpha)
 }
 
 // Channel updater.
-std::vector<std::vector<long double>> truncated_geometric::get_channel(int size, long double alpha)
+template<typename T>
+std::vector<std::vector<T>> truncated_geometric<T>::get_channel(int size, T alpha)
 {
     try
     {
-        truncated_geometric::check_parameters(size, alpha);
+        truncated_geometric<T>::check_parameters(size, alpha);
     }
     catch (const char* err)
     {
         std::cerr << err << std::endl;
     }
 
-    std::vector<std::vector<long double>> channel(size + 1, std::vector<long double>(size + 1, 0));
+    std::vector<std::vector<T>> channel(size + 1, std::vector<T>(size + 1, 0));
     
     create_channel(channel, size + 1, alpha);
 
     try
     {
-        truncated_geometric::check_channel(channel, size + 1, alpha);
+        truncated_geometric<T>::check_channel(channel, size + 1, alpha);
     }
     catch (const char* err)
     {
@@ -47,14 +50,9 @@ std::vector<std::vector<long double>> truncated_geometric::get_channel(int size,
     return channel;
 }
 
-// Secret domain size.
-int size;
-
-// Differential privacy parameters.
-long double alpha;
-
 // Create channel.
-void truncated_geometric::create_channel(std::vector<std::vector<long double>> &channel, int size, long double alpha)
+template<typename T>
+void truncated_geometric<T>::create_channel(std::vector<std::vector<T>> &channel, int size, T alpha)
 {
     // Create channel for given parameters.
     int i = 0, j = 0;
@@ -75,7 +73,8 @@ void truncated_geometric::create_channel(std::vector<std::vector<long double>> &
 }
 
 // Check channel and differential privacy parameters.
-void truncated_geometric::check_parameters(int size, long double alpha)
+template<typename T>
+void truncated_geometric<T>::check_parameters(int size, T alpha)
 {
     // Secret domain size must be an integer.
     if (typeid(size) != typeid(int))
@@ -90,7 +89,7 @@ void truncated_geometric::check_parameters(int size, long double alpha)
     }
 
     // Alpha must be real.
-    else if (typeid(alpha) != typeid(long double))
+    else if (typeid(alpha) != typeid(T))
     {
         throw "Alpha must be numeric.";
     }
@@ -103,22 +102,27 @@ void truncated_geometric::check_parameters(int size, long double alpha)
 }
 
 // Check resulting channel.
-void truncated_geometric::check_channel(std::vector<std::vector<long double>> channel, int size, long double alpha)
+template<typename T>
+void truncated_geometric<T>::check_channel(std::vector<std::vector<T>> channel, int size, T alpha)
 {
     // Check channel properties (e.g. each row sums to 1).
     int i = 0, j = 0;
     for (i = 0; i < size; i++)
     {
-        long double row = 0;
+        T row = 0;
 
         for (j = 0; j < size; j++)
         {
             row = row + channel[i][j];
         }
 
-        if (!(fabs(1 - row) < (size - 1) * LDBL_EPSILON * fabs(1 + row)) || !(fabs(1 - row) < LDBL_MIN))
+        if (!(fabs(1 - row) < (size - 1) * std::numeric_limits<T>::epsilon() * fabs(1 + row)) || !(fabs(1 - row) < std::numeric_limits<T>::min()))
         {
             throw "Channel rows must sum to one.";
         }
     }
-}
\ No newline at end of file
+}
+
+template class TG::truncated_geometric<float>;
+template class TG::truncated_geometric<double>;
+template class TG::truncated_geometric<long double>;
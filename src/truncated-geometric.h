@@ -6,33 +6,36 @@
 #include <vector>
 #include <cfloat>
 #include <cmath>
+#include "precision.h"
 
 namespace TG
 {
+    // T is the scalar type of the channel, instantiated for float, double and long double.
+    template<typename T = Real>
     class truncated_geometric
     {
         public:
             // Class truncated_geometric constructor.
-            truncated_geometric(int size = 3, long double alpha = 0.5);
+            truncated_geometric(int size = 3, T alpha = 0.5);
 
             // Channel updater.
-            std::vector<std::vector<long double>> get_channel(int size, long double alpha);
+            std::vector<std::vector<T>> get_channel(int size, T alpha);
 
         private:
             // Secret domain size.
             int size;
 
             // Differential privacy parameters.
-            long double alpha;
+            T alpha;
 
             // Create channel.
-            void create_channel(std::vector<std::vector<long double>> &channel, int size, long double alpha);
+            void create_channel(std::vector<std::vector<T>> &channel, int size, T alpha);
 
             // Check channel and differential privacy parameters.
-            void check_parameters(int size, long double alpha);
+            void check_parameters(int size, T alpha);
 
             // Check resulting channel.
-            void check_channel(std::vector<std::vector<long double>> channel, int size, long double alpha);
+            void check_channel(std::vector<std::vector<T>> channel, int size, T alpha);
     };
 }
 